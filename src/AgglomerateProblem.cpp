@@ -0,0 +1,197 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file AgglomerateProblem.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#include "Utils_MPI.hpp"
+#endif
+
+#include "AgglomerateProblem.hpp"
+#include "GenerateGeometry.hpp"
+#include "GenerateNonsymProblem.hpp"
+#include "SetupHalo.hpp"
+
+/*!
+  Routine to move a coarse level with few rows per process onto a subset of the processes.
+
+  If A has fewer than threshold local rows, the process grid is halved in every even dimension and
+  each group of up to 8 neighboring processes is merged onto its first process.  The merged
+  processes form a new communicator on which the level is generated again, with the same global
+  problem and a local block up to twice as large in each dimension; the levels below it are then
+  built from this copy, so that they run on fewer processes with fewer messages.  A itself stays
+  distributed over all processes, and ComputeMG moves vectors between the two distributions.
+
+  Only generated problems with a uniform z partition are agglomerated, and not in GPU builds.
+
+  @param[inout] A         The matrix of the level, on output its agglomeration data is defined if it was agglomerated.
+  @param[in]    threshold Number of local rows below which the level is agglomerated (0 disables agglomeration)
+
+  @return Returns 1 on all processes if A was agglomerated, 0 otherwise.
+
+  Note that the matrix A is considered const because the attributes we are modifying are declared as mutable.
+*/
+template<class SparseMatrix_type>
+int AgglomerateProblem(const SparseMatrix_type & A, local_int_t threshold) {
+
+#if defined(HPGMP_NO_MPI) | defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
+  (void) A;
+  (void) threshold;
+  return 0;
+#else
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  typedef Vector<scalar_type> Vector_type;
+  typedef AgglomerationData<scalar_type> AgglomerationData_type;
+
+  // Every process has the same number of rows, so all of them take the same decision
+  const Geometry & geom = *A.geom;
+  if (threshold<=0 || A.localNumberOfRows>=threshold || geom.pz!=0 || A.rowPartition!=0) return 0;
+  int fx = geom.npx%2==0 ? 2 : 1;
+  int fy = geom.npy%2==0 ? 2 : 1;
+  int fz = geom.npz%2==0 ? 2 : 1;
+  if (fx*fy*fz==1) return 0;
+
+  int npxa = geom.npx/fx, npya = geom.npy/fy, npza = geom.npz/fz;
+  int groupRank = (geom.ipz%fz)*fx*fy + (geom.ipy%fy)*fx + geom.ipx%fx;
+  int activeRank = (geom.ipz/fz)*npxa*npya + (geom.ipy/fy)*npxa + geom.ipx/fx;
+
+  AgglomerationData_type * data = new AgglomerationData_type;
+  data->groupSize = fx*fy*fz;
+  data->A = 0;
+  data->r = 0;
+  data->x = 0;
+  data->buffer = 0;
+  data->gatherToLocal = 0;
+  MPI_Comm_split(A.comm, activeRank, groupRank, &data->groupComm);
+  MPI_Comm_split(A.comm, groupRank==0 ? 0 : MPI_UNDEFINED, activeRank, &data->activeComm);
+
+  if (groupRank==0) {
+    local_int_t nx = geom.nx, ny = geom.ny, nz = geom.nz;
+    local_int_t nxa = fx*nx, nya = fy*ny, nza = fz*nz;
+    Geometry * geoma = new Geometry;
+    GenerateGeometry(npxa*npya*npza, activeRank, geom.numThreads, 0, 0, 0, nxa, nya, nza, npxa, npya, npza, geoma);
+
+    bool init_vect = false;
+    Vector_type * tmp = 0;
+    SparseMatrix_type * Aa = new SparseMatrix_type;
+    InitializeSparseMatrix(*Aa, geoma, data->activeComm);
+    GenerateNonsymProblem(*Aa, tmp, tmp, tmp, init_vect);
+    SetupHalo(*Aa);
+
+    data->A = Aa;
+    data->r = new Vector_type;
+    data->x = new Vector_type;
+    InitializeVector(*data->r, Aa->localNumberOfRows, Aa->comm);
+    InitializeVector(*data->x, Aa->localNumberOfColumns, Aa->comm);
+    data->buffer = new scalar_type[Aa->localNumberOfRows];
+
+    // Process m of the group sends its rows in its own order; place them in its sub-block of the merged block
+    local_int_t nrow = A.localNumberOfRows;
+    data->gatherToLocal = new local_int_t[Aa->localNumberOfRows];
+    for (int m=0; m<data->groupSize; ++m) {
+      local_int_t ox = (m%fx)*nx, oy = ((m/fx)%fy)*ny, oz = (m/(fx*fy))*nz;
+      for (local_int_t iz=0; iz<nz; ++iz)
+        for (local_int_t iy=0; iy<ny; ++iy)
+          for (local_int_t ix=0; ix<nx; ++ix)
+            data->gatherToLocal[m*nrow + iz*nx*ny + iy*nx + ix] = (oz+iz)*nxa*nya + (oy+iy)*nxa + ox+ix;
+    }
+  }
+  A.agglomeration = data;
+  return 1;
+#endif
+}
+
+/*!
+  Gathers the local rows of r on the active process of the group, in the ordering of the agglomerated matrix.
+
+  @param[in] A The agglomerated level
+  @param[in] r The right-hand side distributed over all processes
+*/
+template<class SparseMatrix_type, class Vector_type>
+void GatherAgglomeratedVector(const SparseMatrix_type & A, const Vector_type & r) {
+
+#ifndef HPGMP_NO_MPI
+  typedef typename Vector_type::scalar_type scalar_type;
+  AgglomerationData<scalar_type> * data = A.agglomeration;
+  local_int_t nrow = A.localNumberOfRows;
+  MPI_Datatype datatype = MpiTypeTraits<scalar_type>::getType();
+
+  MPI_Gather(r.values, nrow, datatype, data->buffer, nrow, datatype, 0, data->groupComm);
+  if (data->A!=0) {
+    scalar_type * rv = data->r->values;
+    for (local_int_t i=0; i<nrow*data->groupSize; ++i) rv[data->gatherToLocal[i]] = data->buffer[i];
+  }
+#else
+  (void) A;
+  (void) r;
+#endif
+  return;
+}
+
+/*!
+  Scatters the solution computed on the active process of the group back to the local rows of x.
+
+  @param[in]    A The agglomerated level
+  @param[inout] x On exit, the local rows hold the solution computed on the active processes
+*/
+template<class SparseMatrix_type, class Vector_type>
+void ScatterAgglomeratedVector(const SparseMatrix_type & A, Vector_type & x) {
+
+#ifndef HPGMP_NO_MPI
+  typedef typename Vector_type::scalar_type scalar_type;
+  AgglomerationData<scalar_type> * data = A.agglomeration;
+  local_int_t nrow = A.localNumberOfRows;
+  MPI_Datatype datatype = MpiTypeTraits<scalar_type>::getType();
+
+  if (data->A!=0) {
+    const scalar_type * xv = data->x->values;
+    for (local_int_t i=0; i<nrow*data->groupSize; ++i) data->buffer[i] = xv[data->gatherToLocal[i]];
+  }
+  MPI_Scatter(data->buffer, nrow, datatype, x.values, nrow, datatype, 0, data->groupComm);
+#else
+  (void) A;
+  (void) x;
+#endif
+  return;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int AgglomerateProblem< SparseMatrix<double> >(SparseMatrix<double> const&, local_int_t);
+
+template
+int AgglomerateProblem< SparseMatrix<float> >(SparseMatrix<float> const&, local_int_t);
+
+template
+void GatherAgglomeratedVector< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&);
+
+template
+void GatherAgglomeratedVector< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&);
+
+template
+void ScatterAgglomeratedVector< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double>&);
+
+template
+void ScatterAgglomeratedVector< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float>&);
@@ -0,0 +1,31 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+#ifndef AGGLOMERATEPROBLEM_HPP
+#define AGGLOMERATEPROBLEM_HPP
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+
+template<class SparseMatrix_type>
+int AgglomerateProblem(const SparseMatrix_type & A, local_int_t threshold);
+
+template<class SparseMatrix_type, class Vector_type>
+void GatherAgglomeratedVector(const SparseMatrix_type & A, const Vector_type & r);
+
+template<class SparseMatrix_type, class Vector_type>
+void ScatterAgglomeratedVector(const SparseMatrix_type & A, Vector_type & x);
+
+#endif // AGGLOMERATEPROBLEM_HPP
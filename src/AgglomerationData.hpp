@@ -0,0 +1,73 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file AgglomerationData.hpp
+
+ HPGMP data structure
+ */
+
+#ifndef AGGLOMERATIONDATA_HPP
+#define AGGLOMERATIONDATA_HPP
+
+#include "DataTypes.hpp"
+#include "Vector.hpp"
+
+template<class SC> class SparseMatrix;
+
+/*!
+  Data for a multigrid level that is solved on a subset of the processes: the rows of a group of
+  neighboring processes are gathered onto one active process, which holds a copy of the level
+  (and the levels below it) distributed over the active processes only.
+ */
+template<class SC>
+class AgglomerationData {
+public:
+  typedef Vector<SC> Vector_type;
+  comm_type groupComm; //!< processes whose rows are merged, the active process being rank 0
+  comm_type activeComm; //!< communicator of the active processes (only valid on them)
+  int groupSize; //!< number of processes in the group
+  SparseMatrix<SC> * A; //!< this level on the active processes (0 on the other processes)
+  Vector_type * r; //!< gathered right-hand side (active processes only)
+  Vector_type * x; //!< solution on the active processes, with space for halo values (active processes only)
+  SC * buffer; //!< gathered values in group order (active processes only)
+  local_int_t * gatherToLocal; //!< row of A receiving each entry of buffer (active processes only)
+};
+
+/*!
+ Destructor for the agglomeration data; the agglomerated matrix is deleted by DeleteMatrix.
+
+ @param[inout] data the agglomeration data structure whose storage is deallocated
+ */
+template <class AgglomerationData_type>
+inline void DeleteAgglomerationData(AgglomerationData_type & data) {
+
+  if (data.r!=0) {
+    DeleteVector(*data.r);
+    DeleteVector(*data.x);
+    delete data.r;
+    delete data.x;
+  }
+  delete [] data.buffer;
+  delete [] data.gatherToLocal;
+#ifndef HPGMP_NO_MPI
+  if (data.A!=0) MPI_Comm_free(&data.activeComm);
+  MPI_Comm_free(&data.groupComm);
+#endif
+  return;
+}
+
+#endif // AGGLOMERATIONDATA_HPP
@@ -41,6 +41,7 @@ using std::endl;
 
 #include "BenchGMRES.hpp"
 #include "mytimer.hpp"
+#include "Profiler.hpp"
 
 /*!
   Benchmark the optimized GMRES implementation
@@ -154,6 +155,9 @@ int BenchGMRES(int argc, char **argv, comm_type comm, int numberOfMgLevels, bool
     for (int i=0; i<num_times; i++) test_data.times[i] = 0.0;
     for (int i=0; i<num_times; i++) test_data.times_comp[i] = 0.0;
     for (int i=0; i<num_times; i++) test_data.times_comm[i] = 0.0;
+    test_data.mgLevelTimes.clear();
+    ResetProfiler();
+    EnableProfiler(true);
     for (int i=0; i< numberOfGmresCalls; ++i) {
       ZeroVector(x); // Zero out x
 
@@ -210,6 +214,9 @@ int BenchGMRES(int argc, char **argv, comm_type comm, int numberOfMgLevels, bool
     test_data.opt_times_comm = (double*)malloc(num_times * sizeof(double));
     for (int i=0; i<num_times; i++) test_data.opt_times_comp[i] = test_data.times_comp[i];
     for (int i=0; i<num_times; i++) test_data.opt_times_comm[i] = test_data.times_comm[i];
+    test_data.opt_mgLevelTimes = test_data.mgLevelTimes;
+    EnableProfiler(false);
+    CollectProfile(comm);
   }
 
   // =====================================================================
@@ -270,8 +277,10 @@ int BenchGMRES(int argc, char **argv, comm_type comm, int numberOfMgLevels, bool
   }
 
   // cleanup
+  double teardown_time = mytimer();
   DeleteMatrix(A);  
   DeleteMatrix(A_lo);
+  test_data.TeardownTime = mytimer() - teardown_time;
   DeleteGeometry(*geom);
   delete geom;
 
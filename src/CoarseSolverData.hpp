@@ -0,0 +1,68 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file CoarseSolverData.hpp
+
+ HPGMP data structure
+ */
+
+#ifndef COARSESOLVERDATA_HPP
+#define COARSESOLVERDATA_HPP
+
+#include "DataTypes.hpp"
+
+/*!
+  LU factorization of the coarsest multigrid level, replicated on every process of that level.
+  The matrix is factored in global row order, which for generated problems is lexicographic, so that
+  its bandwidth is about one plane of the global coarse grid.
+ */
+class CoarseSolverData {
+public:
+  bool isDense; //!< true for a dense factorization, false for a banded one
+  global_int_t n; //!< number of rows of the coarsest matrix
+  global_int_t lowerBandwidth; //!< number of subdiagonals
+  global_int_t upperBandwidth; //!< number of superdiagonals
+  global_int_t ldab; //!< leading dimension of factor (2*lowerBandwidth+upperBandwidth+1 if banded, n if dense)
+  double * factor; //!< LU factors in LAPACK band storage or dense column-major storage
+  global_int_t * pivots; //!< row interchanges of the partial pivoting
+  global_int_t * gatheredRows; //!< global row of each entry of the right-hand side gathered from all processes
+  int * counts; //!< number of rows of each process
+  int * displs; //!< offset of the rows of each process in the gathered right-hand side
+  double * gathered; //!< gathered right-hand side
+  double * solution; //!< right-hand side and solution in global row order
+  double setupTime; //!< time to assemble and factor the matrix
+  double solveFlops; //!< floating point operations of one forward and back substitution
+};
+
+/*!
+ Destructor for the coarse solver data.
+
+ @param[inout] data the coarse solver data structure whose storage is deallocated
+ */
+inline void DeleteCoarseSolverData(CoarseSolverData & data) {
+
+  delete [] data.factor;
+  delete [] data.pivots;
+  delete [] data.gatheredRows;
+  delete [] data.counts;
+  delete [] data.displs;
+  delete [] data.gathered;
+  delete [] data.solution;
+  return;
+}
+
+#endif // COARSESOLVERDATA_HPP
@@ -0,0 +1,137 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file CompressedIndexData.hpp
+
+ HPGMP data structure
+ */
+
+#ifndef COMPRESSEDINDEXDATA_HPP
+#define COMPRESSEDINDEXDATA_HPP
+
+#include "DataTypes.hpp"
+#include "Geometry.hpp"
+
+const int HPGMP_COMPRESSED_ROW_LENGTH = 27; //!< longest row of the levels with compressed column indices (the stencil of the generated problems)
+
+/*!
+  Compressed column indices of one multigrid level, in the compressedIndices of its matrix: the
+  column of nonzero j of row i is rowBase[i] plus a small code stored in rowLength entries per row,
+  so the optimized kernels read 1 or 2 bytes per nonzero instead of the 4 bytes of mtxIndL.
+
+  - With 8-bit stencil codes (indexWidth 1), rowBase[i] is i and the code is the stencil point of the
+    column, whose offset in the lexicographic numbering of the local grid is codeOffsets[code].
+  - With 16-bit deltas (indexWidth 2), rowBase[i] is the smallest column of the row and the code is
+    the distance of the column to it, up to 65535.
+
+  Rows with a column that cannot be encoded, the columns of the halo in particular, are escape rows:
+  their rowBase is -1 and the kernels read their columns from mtxIndL.
+ */
+class CompressedIndexData {
+public:
+  int indexWidth; //!< bytes per nonzero of the codes: 1 for stencil codes, 2 for deltas
+  int rowLength; //!< number of codes stored per row (the longest row)
+  local_int_t codeOffsets[HPGMP_COMPRESSED_ROW_LENGTH]; //!< column offset of each stencil code (indexWidth 1)
+  local_int_t * rowBase; //!< base column of each row, -1 for the escape rows
+  unsigned char * codes; //!< stencil codes, rowLength per row (indexWidth 1)
+  unsigned short * deltas; //!< deltas to the base column, rowLength per row (indexWidth 2)
+  local_int_t numberOfEscapeRows; //!< number of rows using mtxIndL
+};
+
+//! Offset of the column of a stencil code from the base of its row
+inline local_int_t CodeOffset(const CompressedIndexData & data, unsigned char code) { return data.codeOffsets[code]; }
+//! Offset of the column of a delta from the base of its row
+inline local_int_t CodeOffset(const CompressedIndexData &, unsigned short delta) { return delta; }
+//! Offset of a column of mtxIndL (escape rows, whose base is 0)
+inline local_int_t CodeOffset(const CompressedIndexData &, local_int_t column) { return column; }
+
+/*!
+  Returns sum plus (sign 1) or minus (sign -1) the products of the values of a row with the entries
+  of x at its columns, which are at CodeOffset(data, codes[j]) from xb; if isLowerOnly, only the
+  columns at an offset less than diagonalOffset (before the diagonal) contribute.
+ */
+template<int sign, bool isLowerOnly, class Code_type, class SC>
+inline SC AccumulateRow(const CompressedIndexData & data, const Code_type * codes, int numberOfNonzeros,
+                        const SC * values, const SC * xb, local_int_t diagonalOffset, SC sum) {
+  for (int j=0; j<numberOfNonzeros; ++j) {
+    const local_int_t offset = CodeOffset(data, codes[j]);
+    if (isLowerOnly && offset>=diagonalOffset) continue;
+    if (sign>0) sum += values[j]*xb[offset];
+    else sum -= values[j]*xb[offset];
+  }
+  return sum;
+}
+
+/*!
+  Returns sum plus (sign 1) or minus (sign -1) the products of the values of row i with the entries
+  of x at its columns (only those before column i if isLowerOnly), in the order of the row like the
+  reference kernels.  The codes are decoded into the address of each load rather than into an array
+  of columns: the sum of a row is a chain of dependent additions, so a separate decoding pass only
+  adds instructions, whereas the narrow codes halve or quarter the index traffic of mtxIndL.
+
+  @param[in] data           the compressed indices of the level
+  @param[in] i              the local row
+  @param[in] escapeColumns  the columns of the row in mtxIndL, read if it is an escape row
+  @param[in] values         the values of the row
+  @param[in] xv             the entries of x
+ */
+template<int sign, bool isLowerOnly, class SC>
+inline SC AccumulateCompressedRow(const CompressedIndexData & data, local_int_t i, int numberOfNonzeros,
+                                  const local_int_t * escapeColumns, const SC * values, const SC * xv, SC sum) {
+  const local_int_t base = data.rowBase[i];
+  const size_t first = ((size_t) i)*data.rowLength;
+  if (base<0)
+    return AccumulateRow<sign, isLowerOnly>(data, escapeColumns, numberOfNonzeros, values, xv, i, sum);
+  if (data.indexWidth==1)
+    return AccumulateRow<sign, isLowerOnly>(data, data.codes+first, numberOfNonzeros, values, xv+base, i-base, sum);
+  return AccumulateRow<sign, isLowerOnly>(data, data.deltas+first, numberOfNonzeros, values, xv+base, i-base, sum);
+}
+
+/*!
+ Constructor for the compressed column indices.
+
+ @param[in] geom the geometry of the level, which gives the offsets of the stencil codes
+ @param[out] data the compressed indices, whose codes are filled by SetupCompressedIndices
+ */
+inline void InitializeCompressedIndexData(const Geometry & geom, CompressedIndexData & data) {
+  data.indexWidth = 2;
+  data.rowLength = 0;
+  for (int k=0; k<HPGMP_COMPRESSED_ROW_LENGTH; ++k) {
+    local_int_t sx = k%3-1, sy = (k/3)%3-1, sz = k/9-1;
+    data.codeOffsets[k] = (sz*geom.ny + sy)*geom.nx + sx;
+  }
+  data.rowBase = 0;
+  data.codes = 0;
+  data.deltas = 0;
+  data.numberOfEscapeRows = 0;
+  return;
+}
+
+/*!
+ Destructor for the compressed column indices.
+
+ @param[inout] data the compressed index structure whose storage is deallocated
+ */
+inline void DeleteCompressedIndexData(CompressedIndexData & data) {
+
+  delete [] data.rowBase;
+  delete [] data.codes;
+  delete [] data.deltas;
+  return;
+}
+
+#endif // COMPRESSEDINDEXDATA_HPP
@@ -0,0 +1,153 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ComputeChebyshev.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#ifndef HPGMP_NO_MPI
+#include "ExchangeHalo.hpp"
+#endif
+#include "ComputeChebyshev.hpp"
+#include "mytimer.hpp"
+#include <cassert>
+
+/*!
+  One step of the Chebyshev iteration: d = c1*d + c2*M^{-1}(r - A*x), then x += d,
+  where M is the diagonal of A if inverseDiagonal is set and the identity otherwise.
+  The halo values of x must be up to date.
+ */
+template<class SparseMatrix_type, class Vector_type>
+static void ComputeChebyshevStep(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x,
+                                 const SmootherData<typename SparseMatrix_type::scalar_type> & smoother,
+                                 double c1, double c2) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const local_int_t nrow = A.localNumberOfRows;
+  const scalar_type * const rv = r.values;
+  scalar_type * const xv = x.values;
+  scalar_type * const dv = smoother.work;
+  const scalar_type * const inverseDiagonal = smoother.inverseDiagonal;
+  const scalar_type alpha = c1, beta = c2;
+
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i< nrow; i++) {
+    const scalar_type * const currentValues = A.matrixValues[i];
+    const local_int_t * const currentColIndices = A.mtxIndL[i];
+    const int currentNumberOfNonzeros = A.nonzerosInRow[i];
+    scalar_type sum = rv[i];
+    for (int j=0; j< currentNumberOfNonzeros; j++)
+      sum -= currentValues[j] * xv[currentColIndices[j]];
+    if (inverseDiagonal!=0) sum *= inverseDiagonal[i];
+    dv[i] = alpha*dv[i] + beta*sum;
+  }
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i< nrow; i++) xv[i] += dv[i];
+  return;
+}
+
+/*!
+  Routine to apply one Chebyshev smoothing step: the Chebyshev polynomial of degree smoother.degree
+  in M^{-1}A, where M is the identity or the diagonal of A (Jacobi-preconditioned Chebyshev), that
+  damps the eigenvalues between smoother.lambdaMin and smoother.lambdaMax.  The bounds are estimated
+  by OptimizeProblem.
+
+  Unlike Gauss-Seidel, each step of the iteration is a matrix-vector product followed by vector updates,
+  so all rows are updated in parallel.
+
+  @param[in] A the known system matrix, whose optimizationData holds the SmootherData
+  @param[in] r the input vector
+  @param[inout] x On entry, x should contain relevant values, on exit x contains the result of the smoothing step with r as the RHS.
+  @param[in] xIsZero If true, x is assumed to be zero on entry (its values are ignored): the first step skips the halo exchange and the matrix product.
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSmoother
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeChebyshev(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool xIsZero) {
+
+  assert(x.localLength==A.localNumberOfColumns); // Make sure x contain space for halo values
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const SmootherData<scalar_type> & smoother = *GetSmootherData(A);
+  const double theta = 0.5*(smoother.lambdaMax + smoother.lambdaMin);
+  const double delta = 0.5*(smoother.lambdaMax - smoother.lambdaMin);
+  const double sigma = theta/delta;
+  double rho = 1.0/sigma;
+
+  double t0 = 0.0;
+  if (xIsZero) {
+    // d = M^{-1}r/theta and x = d
+    const local_int_t nrow = A.localNumberOfRows;
+    const scalar_type * const rv = r.values;
+    scalar_type * const xv = x.values;
+    scalar_type * const dv = smoother.work;
+    const scalar_type * const inverseDiagonal = smoother.inverseDiagonal;
+    const scalar_type scale = 1.0/theta;
+    TICK();
+#ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel for
+#endif
+    for (local_int_t i=0; i< nrow; i++) {
+      dv[i] = (inverseDiagonal!=0 ? inverseDiagonal[i]*rv[i] : rv[i])*scale;
+      xv[i] = dv[i];
+    }
+    for (local_int_t i=nrow; i<A.localNumberOfColumns; i++) xv[i] = 0.0;
+    TOCK(x.time2);
+  } else {
+#ifndef HPGMP_NO_MPI
+    ExchangeHalo(A, x);
+#endif
+    TICK();
+    ComputeChebyshevStep(A, r, x, smoother, 0.0, 1.0/theta);
+    TOCK(x.time2);
+  }
+
+  for (int k=1; k<smoother.degree; ++k) {
+    double rhoNew = 1.0/(2.0*sigma - rho);
+#ifndef HPGMP_NO_MPI
+    ExchangeHalo(A, x);
+#endif
+    TICK();
+    ComputeChebyshevStep(A, r, x, smoother, rhoNew*rho, 2.0*rhoNew/delta);
+    TOCK(x.time2);
+    rho = rhoNew;
+  }
+
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeChebyshev< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&, bool);
+
+template
+int ComputeChebyshev< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, bool);
@@ -0,0 +1,101 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ComputeCoarseSolve.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include "ComputeCoarseSolve.hpp"
+
+/*!
+  Routine to solve the coarsest level exactly with the LU factorization built by SetupCoarseSolver.
+
+  The right-hand side is gathered on all processes of the level, each of which performs the forward
+  and back substitution and keeps its own rows of the solution.
+
+  @param[in]    A the coarsest level matrix, with its coarse solver data defined
+  @param[in]    r the right-hand side
+  @param[inout] x on exit, the local rows hold the solution of A x = r
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see SetupCoarseSolver
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeCoarseSolve(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x) {
+
+  const CoarseSolverData & data = *A.coarseSolver;
+  const global_int_t n = data.n;
+  const local_int_t nrow = A.localNumberOfRows;
+  double * b = data.solution;
+
+  // Gather the right-hand side in global row order
+  for (local_int_t i=0; i<nrow; ++i) b[i] = r.values[i];
+#ifndef HPGMP_NO_MPI
+  MPI_Allgatherv(b, nrow, MPI_DOUBLE, data.gathered, data.counts, data.displs, MPI_DOUBLE, A.comm);
+#else
+  std::copy(b, b+nrow, data.gathered);
+#endif
+  for (global_int_t k=0; k<n; ++k) b[data.gatheredRows[k]] = data.gathered[k];
+
+  const double * f = data.factor;
+  const global_int_t * ipiv = data.pivots;
+  if (data.isDense) {
+    // The dense factorization interchanges whole rows, so all interchanges come first
+    for (global_int_t j=0; j<n; ++j)
+      if (ipiv[j]!=j) std::swap(b[j], b[ipiv[j]]);
+    for (global_int_t j=0; j<n; ++j) {
+      for (global_int_t i=j+1; i<n; ++i) b[i] -= f[i + j*n]*b[j];
+    }
+    for (global_int_t j=n-1; j>=0; --j) {
+      b[j] /= f[j + j*n];
+      for (global_int_t i=0; i<j; ++i) b[i] -= f[i + j*n]*b[j];
+    }
+  } else {
+    // The banded factorization leaves the multipliers in place, so interchanges are applied as they come
+    const global_int_t kl = data.lowerBandwidth, kv = data.lowerBandwidth + data.upperBandwidth, ldab = data.ldab;
+    for (global_int_t j=0; j<n; ++j) {
+      if (ipiv[j]!=j) std::swap(b[j], b[ipiv[j]]);
+      global_int_t km = std::min(kl, n-1-j);
+      for (global_int_t r=1; r<=km; ++r) b[j+r] -= f[kv+r + j*ldab]*b[j];
+    }
+    for (global_int_t j=n-1; j>=0; --j) {
+      b[j] /= f[kv + j*ldab];
+      for (global_int_t i=std::max((global_int_t) 0, j-kv); i<j; ++i) b[i] -= f[kv+i-j + j*ldab]*b[j];
+    }
+  }
+
+  for (local_int_t i=0; i<nrow; ++i) x.values[i] = b[A.localToGlobalMap[i]];
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeCoarseSolve< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&);
+
+template
+int ComputeCoarseSolve< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&);
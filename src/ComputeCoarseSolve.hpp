@@ -0,0 +1,25 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+#ifndef COMPUTECOARSESOLVE_HPP
+#define COMPUTECOARSESOLVE_HPP
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+
+template<class SparseMatrix_type, class Vector_type>
+int ComputeCoarseSolve(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x);
+
+#endif // COMPUTECOARSESOLVE_HPP
@@ -21,6 +21,25 @@
  */
 #include "ComputeGEMVT.hpp"
 #include "ComputeGEMVT_ref.hpp"
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP) & !defined(HPGMP_WITH_BLAS)
+#ifndef HPGMP_NO_MPI
+ #include "Utils_MPI.hpp"
+#endif
+#include "SimdBackend.hpp"
+#include "mytimer.hpp"
+#include <cassert>
+#endif
+
+/*!
+  Routine to compute y = alpha*A^T*x + beta*y, with the local products of the columns of A and x
+  summed over all processes.
+
+  This routine uses the multi-column kernels of the SIMD backend when it is enabled (see
+  SetupSimdBackend), which round like the reference implementation, and the reference GEMVT
+  implementation otherwise.
+
+  @see ComputeGEMVT_ref
+*/
 
 template<class MultiVector_type, class Vector_type, class SerialDenseMatrix_type>
 int ComputeGEMVT(const local_int_t m, const local_int_t n,
@@ -28,6 +47,39 @@ int ComputeGEMVT(const local_int_t m, const local_int_t n,
                  const typename SerialDenseMatrix_type::scalar_type beta, SerialDenseMatrix_type & y,
                  bool & isOptimized) {
 
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP) & !defined(HPGMP_WITH_BLAS)
+  typedef typename SerialDenseMatrix_type::scalar_type scalar_type;
+  if (GetSimdLevel()!=HPGMP_SIMD_SCALAR) {
+    assert(x.localLength >= m); // Test vector lengths
+    assert(y.m >= n);
+    assert(y.n == 1);
+    scalar_type * const yv = y.values;
+
+    double t0; TICK();
+    if (beta == 0.0) {
+      for (local_int_t i = 0; i < n; i++) yv[i] = 0.0;
+    } else if (beta != 1.0) {
+      for (local_int_t i = 0; i < n; i++) yv[i] *= beta;
+    }
+    SimdGEMVT(m, n, alpha, A.values, x.values, yv);
+    TIME(y.time1);
+
+#ifndef HPGMP_NO_MPI
+    TICK();
+    int size;
+    MPI_Comm_size(A.comm, &size);
+    if (size > 1) {
+      MPI_Datatype MPI_SCALAR_TYPE = MpiTypeTraits<scalar_type>::getType ();
+      MPI_Allreduce(MPI_IN_PLACE, yv, n, MPI_SCALAR_TYPE, MPI_SUM, A.comm);
+    }
+    TIME(y.time2);
+#else
+    y.time2 = 0.0;
+#endif
+    return 0;
+  }
+#endif
+
   // This line and the next two lines should be removed and your version of ComputeGEMV should be used.
   isOptimized = false;
   return ComputeGEMVT_ref(m, n, alpha, A, x, beta, y);
@@ -22,6 +22,37 @@
 
 #include "ComputeGS_Forward.hpp"
 #include "ComputeGS_Forward_ref.hpp"
+#include "ComputeGS_Forward_stencil.hpp"
+#ifndef HPGMP_NO_MPI
+ #include "ExchangeHalo.hpp"
+#endif
+#include "mytimer.hpp"
+#include <cassert>
+
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+/*!
+  Applies the forward Gauss-Seidel sweep to the full rows first to last-1 of a run (see RowRunData),
+  with the stride of the run and the fully unrolled row kernels: the terms before the diagonal only
+  when x is zero on entry, all of them otherwise, in the order of ComputeGS_Forward_ref.
+ */
+template<class SparseMatrix_type, class scalar_type>
+static inline void ComputeGSFullRows(const SparseMatrix_type & A, const scalar_type * const rv, scalar_type * const xv,
+                                     local_int_t first, local_int_t last, bool xIsZero) {
+  const scalar_type * currentValues = A.matrixValues[first];
+  const local_int_t * currentColIndices = A.mtxIndL[first];
+  for (local_int_t i=first; i<last; i++, currentValues+=HPGMP_FULL_ROW_LENGTH, currentColIndices+=HPGMP_FULL_ROW_LENGTH) {
+    const scalar_type currentDiagonal = currentValues[HPGMP_FULL_ROW_DIAGONAL]; // Current diagonal value
+    scalar_type sum = rv[i]; // RHS value
+    if (xIsZero) {
+      sum = Row<HPGMP_FULL_ROW_DIAGONAL>::Subtract(currentValues, currentColIndices, xv, sum);
+    } else {
+      sum = Row<HPGMP_FULL_ROW_LENGTH>::Subtract(currentValues, currentColIndices, xv, sum);
+      sum += xv[i]*currentDiagonal; // Remove diagonal contribution from previous loop
+    }
+    xv[i] = sum/currentDiagonal;
+  }
+}
+#endif
 
 /*!
   Routine to compute one forward step of Gauss-Seidel:
@@ -36,19 +67,96 @@
   Gauss-Seidel notes:
   - We use the input vector x as the RHS and start with an initial guess for y of all zeros.
   - We perform one forward sweep.  Since y is initially zero we can ignore the upper triangular terms of A.
+  - Levels set up in the DIA format by OptimizeProblem use ComputeGS_Forward_stencil, and levels with
+    compressed column indices (see CompressedIndexData) decode the columns of each row in its sweep.
+  - The full rows of the other levels (see RowRunData) use fixed-width row kernels.
 
   @param[in] A the known system matrix
   @param[in] r the input vector
   @param[inout] x On entry, x should contain relevant values, on exit x contains the result of one symmetric GS sweep with r as the RHS.
+  @param[in] xIsZero If true, x is assumed to be zero on entry (its values are ignored): the halo exchange and the upper triangular terms are skipped.
 
   @return returns 0 upon success and non-zero otherwise
 
   @see ComputeGS_Forward_ref
+  @see ComputeGS_Forward_stencil
 */
 template<class SparseMatrix_type, class Vector_type>
-int ComputeGS_Forward(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x) {
+int ComputeGS_Forward(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool xIsZero) {
 
-  // This line and the next two lines should be removed and your version of ComputeSYMGS should be used.
+#if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
+  if (xIsZero) ZeroVector(x);
   return ComputeGS_Forward_ref(A, r, x);
+#else
+  if (A.stencilData!=0) return ComputeGS_Forward_stencil(A, r, x, xIsZero);
+  if (!xIsZero && A.compressedIndices==0 && A.rowRuns==0) return ComputeGS_Forward_ref(A, r, x);
+
+  assert(x.localLength==A.localNumberOfColumns); // Make sure x contain space for halo values
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const local_int_t nrow = A.localNumberOfRows;
+  const scalar_type * const rv = r.values;
+  scalar_type * const xv = x.values;
+  scalar_type ** matrixDiagonal = A.matrixDiagonal;
+  const CompressedIndexData * const indices = A.compressedIndices;
+  const RowRunData * const runs = A.rowRuns;
+  const local_int_t numberOfRuns = runs!=0 ? runs->numberOfRuns : 1;
+
+  // When the initial guess is zero: no halo exchange, and only the rows already updated by the sweep contribute
+  double t0 = 0.0;
+#ifndef HPGMP_NO_MPI
+  // Exchange Halo on HOST CPU
+  if (!xIsZero) ExchangeHalo(A, x);
+#endif
+  TICK();
+  if (xIsZero)
+    for (local_int_t i=A.localNumberOfRows; i<A.localNumberOfColumns; i++) xv[i] = 0.0;
+  for (local_int_t run=0; run<numberOfRuns; run++) {
+    const local_int_t first = runs!=0 ? runs->runStart[run] : 0;
+    const local_int_t last = runs!=0 ? runs->runStart[run+1] : nrow;
+    if (run%2==1) {
+      ComputeGSFullRows(A, rv, xv, first, last, xIsZero);
+      continue;
+    }
+    for (local_int_t i=first; i < last; i++) {
+      const scalar_type * const currentValues = A.matrixValues[i];
+      const local_int_t * const currentColIndices = A.mtxIndL[i];
+      const int currentNumberOfNonzeros = A.nonzerosInRow[i];
+      const scalar_type currentDiagonal = matrixDiagonal[i][0]; // Current diagonal value
+      scalar_type sum = rv[i]; // RHS value
 
+      if (indices!=0 && xIsZero) {
+        sum = AccumulateCompressedRow<-1, true>(*indices, i, currentNumberOfNonzeros, currentColIndices, currentValues, xv, sum);
+      } else if (indices!=0) {
+        sum = AccumulateCompressedRow<-1, false>(*indices, i, currentNumberOfNonzeros, currentColIndices, currentValues, xv, sum);
+        sum += xv[i]*currentDiagonal; // Remove diagonal contribution from previous loop
+      } else if (xIsZero) {
+        for (int j=0; j< currentNumberOfNonzeros; j++) {
+          local_int_t curCol = currentColIndices[j];
+          if (curCol<i) sum -= currentValues[j] * xv[curCol];
+        }
+      } else {
+        for (int j=0; j< currentNumberOfNonzeros; j++)
+          sum -= currentValues[j] * xv[currentColIndices[j]];
+        sum += xv[i]*currentDiagonal; // Remove diagonal contribution from previous loop
+      }
+
+      xv[i] = sum/currentDiagonal;
+    }
+  }
+  TOCK(x.time2);
+
+  return 0;
+#endif
 }
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeGS_Forward< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&, bool);
+
+template
+int ComputeGS_Forward< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, bool);
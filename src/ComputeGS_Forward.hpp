@@ -20,6 +20,6 @@
 #include "Vector.hpp"
 
 template<class SparseMatrix_type, class Vector_type>
-int ComputeGS_Forward(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x);
+int ComputeGS_Forward(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool xIsZero=false);
 
 #endif // COMPUTEGS_FORWARD_HPP
@@ -0,0 +1,122 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ComputeGS_Forward_stencil.cpp
+
+ HPGMP routine
+ */
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+
+#ifndef HPGMP_NO_MPI
+ #include "ExchangeHalo.hpp"
+#endif
+#include "ComputeGS_Forward_stencil.hpp"
+#include "mytimer.hpp"
+#include <cassert>
+
+/*!
+  Computes one forward step of Gauss-Seidel with the DIA copy of A (see StencilData).  The sweep
+  updates x in the padded layout, row by row in the lexicographic order of ComputeGS_Forward_ref
+  and with the terms of each row in the same order, so the result is the same; rows that do not
+  fit in the stencil are computed from their CSR form.  The halo is received straight into the
+  ghost cells of the padded layout (see ExchangePaddedHalo), the external entries of x are not updated.
+
+  @param[in] A the known system matrix, with its stencil data set up by SetupStencilMatrix
+  @param[in] r the input vector
+  @param[inout] x On entry, x should contain relevant values, on exit x contains the result of one forward GS sweep with r as the RHS.
+  @param[in] xIsZero If true, x is assumed to be zero on entry (its values are ignored): the halo exchange and the upper triangular terms are skipped.
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeGS_Forward
+  @see ComputeGS_Forward_ref
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeGS_Forward_stencil(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool xIsZero) {
+
+  assert(x.localLength==A.localNumberOfColumns); // Make sure x contain space for halo values
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const StencilData<scalar_type> & stencil = *A.stencilData;
+  const local_int_t nrow = A.localNumberOfRows;
+  const local_int_t nx = stencil.nx, numberOfLines = stencil.ny*stencil.nz;
+
+  const scalar_type * const rv = r.values;
+  scalar_type * const xv = x.values;
+
+  double t0 = 0.0;
+  if (xIsZero) {
+    // Only the rows already updated by the sweep contribute: no halo exchange, and the local entries are not loaded
+    for (local_int_t i=0; i<stencil.numberOfExternalCells; i++) stencil.paddedVector[stencil.externalCells[i]] = 0.0;
+  } else {
+    LoadPaddedVector(stencil, xv);
+#ifndef HPGMP_NO_MPI
+    // Exchange Halo on HOST CPU
+    ExchangePaddedHalo(A, x);
+#endif
+  }
+
+  // The stencil points before the center are the neighbors preceding the row in the sweep
+  const int numberOfPoints = xIsZero ? HPGMP_STENCIL_CENTER : HPGMP_STENCIL_POINTS;
+  TICK();
+  const local_int_t * nextFallbackRow = stencil.fallbackRows;
+  for (local_int_t line=0, i=0; line<numberOfLines; ++line) {
+    scalar_type * const xline = stencil.paddedVector + PaddedIndex(stencil, 0, line%stencil.ny, line/stencil.ny);
+    for (local_int_t ix=0; ix<nx; ++ix, ++i) {
+      scalar_type sum = rv[i]; // RHS value
+
+      if (i==*nextFallbackRow) {
+        ++nextFallbackRow;
+        const scalar_type * const currentValues = A.matrixValues[i];
+        const local_int_t * const currentColIndices = A.mtxIndL[i];
+        const scalar_type currentDiagonal = A.matrixDiagonal[i][0];
+        for (int j=0; j<A.nonzerosInRow[i]; j++) {
+          local_int_t curCol = currentColIndices[j];
+          if (curCol>=i && xIsZero) continue;
+          sum -= currentValues[j] * stencil.paddedVector[PaddedColumnIndex(stencil, nrow, curCol)];
+        }
+        if (!xIsZero) sum += xline[ix]*currentDiagonal; // Remove diagonal contribution from previous loop
+        xline[ix] = sum/currentDiagonal;
+        continue;
+      }
+
+      const scalar_type * const currentValues = stencil.values + i;
+      for (int k=0; k<numberOfPoints; k++)
+        sum -= currentValues[((size_t) k)*nrow] * xline[ix+stencil.offsets[k]];
+      const scalar_type currentDiagonal = currentValues[((size_t) HPGMP_STENCIL_CENTER)*nrow];
+      if (!xIsZero) sum += xline[ix]*currentDiagonal; // Remove diagonal contribution from previous loop
+      xline[ix] = sum/currentDiagonal;
+    }
+  }
+  TOCK(x.time2);
+
+  StorePaddedVector(stencil, xv);
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeGS_Forward_stencil< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&, bool);
+
+template
+int ComputeGS_Forward_stencil< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, bool);
+
+#endif
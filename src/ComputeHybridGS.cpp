@@ -0,0 +1,145 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ComputeHybridGS.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#ifndef HPGMP_NO_MPI
+#include "ExchangeHalo.hpp"
+#endif
+#include "ComputeHybridGS.hpp"
+#include "mytimer.hpp"
+#include <cassert>
+
+/*!
+  One Gauss-Seidel sweep over each block of rows, the blocks being processed in parallel.
+  Within a block, row i is updated with x_i += (r_i - A_i*x)/d_i, where the columns of the block
+  take their current values and the other local columns their values before the sweep (xOld).
+
+  If xIsZero, x is zero before the sweep, so only the columns of the block already updated contribute.
+ */
+template<class SparseMatrix_type, class Vector_type>
+static void ComputeHybridGSSweep(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x,
+                                 const SmootherData<typename SparseMatrix_type::scalar_type> & smoother,
+                                 bool forward, bool xIsZero) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const local_int_t nrow = A.localNumberOfRows;
+  const scalar_type * const rv = r.values;
+  scalar_type * const xv = x.values;
+  scalar_type * const xOld = smoother.work;
+  const scalar_type * const inverseDiagonal = smoother.inverseDiagonal;
+  const int numberOfBlocks = smoother.numberOfBlocks;
+
+  if (!xIsZero) {
+#ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel for
+#endif
+    for (local_int_t i=0; i< nrow; i++) xOld[i] = xv[i];
+  }
+
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for schedule(static, 1)
+#endif
+  for (int b=0; b< numberOfBlocks; b++) {
+    const local_int_t start = smoother.blockStart[b];
+    const local_int_t end = smoother.blockStart[b+1];
+    for (local_int_t k=0; k< end-start; k++) {
+      const local_int_t i = forward ? start+k : end-1-k;
+      const scalar_type * const currentValues = A.matrixValues[i];
+      const local_int_t * const currentColIndices = A.mtxIndL[i];
+      const int currentNumberOfNonzeros = A.nonzerosInRow[i];
+      scalar_type sum = rv[i];
+
+      if (xIsZero) {
+        for (int j=0; j< currentNumberOfNonzeros; j++) {
+          local_int_t curCol = currentColIndices[j];
+          if (curCol>=start && curCol<i) sum -= currentValues[j] * xv[curCol];
+        }
+        xv[i] = sum*inverseDiagonal[i];
+      } else {
+        for (int j=0; j< currentNumberOfNonzeros; j++) {
+          local_int_t curCol = currentColIndices[j];
+          bool inBlock = curCol>=start && curCol<end;
+          sum -= currentValues[j] * (inBlock || curCol>=nrow ? xv[curCol] : xOld[curCol]);
+        }
+        xv[i] += sum*inverseDiagonal[i];
+      }
+    }
+  }
+  return;
+}
+
+/*!
+  Routine to apply one step of hybrid Gauss-Seidel: the rows are split into one contiguous block per
+  thread, made of whole z-planes of the local grid; each block does a Gauss-Seidel sweep on its rows
+  while the couplings between blocks (and with the other processes) are treated as in Jacobi, with the
+  values from before the sweep.  The diagonal is augmented with the l1 norm of these couplings, which
+  keeps the smoother convergent however many blocks there are.  The inverse of the augmented diagonal
+  and the blocks are set up by OptimizeProblem (SmootherData).
+
+  @param[in] A the known system matrix, whose optimizationData holds the SmootherData
+  @param[in] r the input vector
+  @param[inout] x On entry, x should contain relevant values, on exit x contains the result of the smoothing step with r as the RHS.
+  @param[in] symmetric If true, a backward sweep follows the forward sweep
+  @param[in] xIsZero If true, x is assumed to be zero on entry (its values are ignored): the halo exchange is skipped and only the rows already updated contribute to the forward sweep.
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSmoother
+  @see ComputeGS_Forward
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeHybridGS(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool symmetric, bool xIsZero) {
+
+  assert(x.localLength==A.localNumberOfColumns); // Make sure x contain space for halo values
+
+  const SmootherData<typename SparseMatrix_type::scalar_type> & smoother = *GetSmootherData(A);
+
+  double t0 = 0.0;
+  if (xIsZero) {
+    for (local_int_t i=A.localNumberOfRows; i<A.localNumberOfColumns; i++) x.values[i] = 0.0;
+  } else {
+#ifndef HPGMP_NO_MPI
+    ExchangeHalo(A, x);
+#endif
+  }
+
+  TICK();
+  ComputeHybridGSSweep(A, r, x, smoother, true, xIsZero);
+  if (symmetric) ComputeHybridGSSweep(A, r, x, smoother, false, false);
+  TOCK(x.time2);
+
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeHybridGS< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&, bool, bool);
+
+template
+int ComputeHybridGS< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, bool, bool);
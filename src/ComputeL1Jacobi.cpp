@@ -0,0 +1,108 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ComputeL1Jacobi.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#ifndef HPGMP_NO_MPI
+#include "ExchangeHalo.hpp"
+#endif
+#include "ComputeL1Jacobi.hpp"
+#include "mytimer.hpp"
+#include <cassert>
+
+/*!
+  Routine to apply one step of l1-Jacobi: x = x + D^{-1}(r - A*x), where D is the diagonal of A plus,
+  in each row, the sum of the absolute values of the off-diagonal entries.  The l1 correction
+  makes the step convergent for any symmetric positive definite A without a damping factor.
+  The inverse of D is precomputed by OptimizeProblem (SmootherData::inverseDiagonal).
+
+  @param[in] A the known system matrix, whose optimizationData holds the SmootherData
+  @param[in] r the input vector
+  @param[inout] x On entry, x should contain relevant values, on exit x contains the result of the smoothing step with r as the RHS.
+  @param[in] xIsZero If true, x is assumed to be zero on entry (its values are ignored): the halo exchange and the matrix product are skipped.
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSmoother
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeL1Jacobi(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool xIsZero) {
+
+  assert(x.localLength==A.localNumberOfColumns); // Make sure x contain space for halo values
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const SmootherData<scalar_type> & smoother = *GetSmootherData(A);
+  const local_int_t nrow = A.localNumberOfRows;
+  const scalar_type * const rv = r.values;
+  scalar_type * const xv = x.values;
+  scalar_type * const dv = smoother.work;
+  const scalar_type * const inverseDiagonal = smoother.inverseDiagonal;
+
+  double t0 = 0.0;
+  if (xIsZero) {
+    TICK();
+#ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel for
+#endif
+    for (local_int_t i=0; i< nrow; i++) xv[i] = inverseDiagonal[i]*rv[i];
+    for (local_int_t i=nrow; i<A.localNumberOfColumns; i++) xv[i] = 0.0;
+    TOCK(x.time2);
+    return 0;
+  }
+
+#ifndef HPGMP_NO_MPI
+  ExchangeHalo(A, x);
+#endif
+  TICK();
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i< nrow; i++) {
+    const scalar_type * const currentValues = A.matrixValues[i];
+    const local_int_t * const currentColIndices = A.mtxIndL[i];
+    const int currentNumberOfNonzeros = A.nonzerosInRow[i];
+    scalar_type sum = rv[i];
+    for (int j=0; j< currentNumberOfNonzeros; j++)
+      sum -= currentValues[j] * xv[currentColIndices[j]];
+    dv[i] = inverseDiagonal[i]*sum;
+  }
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i< nrow; i++) xv[i] += dv[i];
+  TOCK(x.time2);
+
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeL1Jacobi< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&, bool);
+
+template
+int ComputeL1Jacobi< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, bool);
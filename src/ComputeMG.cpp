@@ -22,11 +22,318 @@
 
 #include "ComputeMG.hpp"
 #include "ComputeMG_ref.hpp"
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+#include "ComputeSmoother.hpp"
+#include "ComputeSPMV.hpp"
+#include "ComputeDotProduct.hpp"
+#include "ComputeWAXPBY.hpp"
+#include "ComputeResidualRestriction.hpp"
+#include "ComputeProlongation_ref.hpp"
+#include "ComputeProlongationSmoother.hpp"
+#include "AgglomerateProblem.hpp"
+#include "ComputeCoarseSolve.hpp"
+#include "mytimer.hpp"
+#include "Profiler.hpp"
+#include "TrafficModel.hpp"
+#include <vector>
+#endif
+#include <cassert>
+
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+template<class SparseMatrix_type, class Vector_type>
+static int ComputeMGCycle(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool symmetric, int cycleType, int level);
+
+/*!
+  Applies one cycle of the coarse level to rc, and adds its kernel times to those of the fine vector x.
+ */
+template<class SparseMatrix_type, class Vector_type>
+static int ComputeCoarseCycle(const SparseMatrix_type & A, const Vector_type & rc, Vector_type & xc, Vector_type & x,
+                              bool symmetric, int cycleType, int level) {
+  xc.time1 = xc.time2 = 0.0; xc.time3 = xc.time4 = 0.0;
+  int ierr = ComputeMGCycle(*A.Ac, rc, xc, symmetric, cycleType, level+1);
+  x.time1 += xc.time1; x.time2 += xc.time2;
+  x.time3 += xc.time3; x.time4 += xc.time4;
+  return ierr;
+}
+
+/*!
+  Computes the coarse grid correction mgData->xc from mgData->rc according to the cycle type:
+  - V-cycle: one coarse cycle
+  - W-cycle: two coarse W-cycles, the second one on the residual of the first
+  - F-cycle: a coarse F-cycle followed by a coarse V-cycle on its residual
+  - K-cycle: two iterations of GCR on the coarse system, preconditioned by coarse K-cycles
+ */
+template<class SparseMatrix_type, class Vector_type>
+static int ComputeCoarseCorrection(const SparseMatrix_type & A, Vector_type & x, bool symmetric, int cycleType, int level) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const SparseMatrix_type & Ac = *A.Ac;
+  const local_int_t nc = Ac.localNumberOfRows;
+  Vector_type & rc = *A.mgData->rc;
+  Vector_type & xc = *A.mgData->xc;
+  bool isOptimized = true;
+
+  if (cycleType==HPGMP_MG_V_CYCLE) return ComputeCoarseCycle(A, rc, xc, x, symmetric, cycleType, level);
+
+  Vector_type & rc2 = *A.mgData->rc2;
+  Vector_type & xc2 = *A.mgData->xc2;
+  Vector_type & Axc = *A.mgData->Axc;
+  int ierr = ComputeCoarseCycle(A, rc, xc, x, symmetric, cycleType, level); if (ierr!=0) return ierr;
+  ierr = ComputeSPMV(Ac, xc, Axc); if (ierr!=0) return ierr;
+
+  if (cycleType==HPGMP_MG_K_CYCLE) {
+    Vector_type & Axc2 = *A.mgData->Axc2;
+    double t = 0.0;
+    scalar_type numer, denom1, denom2, proj;
+
+    // First direction: xc, scaled to minimize the norm of the residual
+    ierr = ComputeDotProduct(nc, Axc, rc, numer, t, isOptimized); if (ierr!=0) return ierr;
+    ierr = ComputeDotProduct(nc, Axc, Axc, denom1, t, isOptimized); if (ierr!=0) return ierr;
+    if (denom1==0.0) return 0;
+    scalar_type alpha1 = numer/denom1;
+    ierr = ComputeWAXPBY(nc, 1.0, rc, -alpha1, Axc, rc2, isOptimized); if (ierr!=0) return ierr;
+
+    // Second direction: the preconditioned residual, A-orthogonalized against the first one
+    ierr = ComputeCoarseCycle(A, rc2, xc2, x, symmetric, cycleType, level); if (ierr!=0) return ierr;
+    ierr = ComputeSPMV(Ac, xc2, Axc2); if (ierr!=0) return ierr;
+    ierr = ComputeDotProduct(nc, Axc2, Axc, proj, t, isOptimized); if (ierr!=0) return ierr;
+    scalar_type beta = proj/denom1;
+    ierr = ComputeWAXPBY(nc, 1.0, Axc2, -beta, Axc, Axc2, isOptimized); if (ierr!=0) return ierr;
+    ierr = ComputeDotProduct(nc, Axc2, rc2, numer, t, isOptimized); if (ierr!=0) return ierr;
+    ierr = ComputeDotProduct(nc, Axc2, Axc2, denom2, t, isOptimized); if (ierr!=0) return ierr;
+    scalar_type alpha2 = denom2==0.0 ? 0.0 : numer/denom2;
+    return ComputeWAXPBY(nc, alpha1-alpha2*beta, xc, alpha2, xc2, xc, isOptimized);
+  }
+
+  // W- and F-cycles: a second cycle on the residual of the first one
+  ierr = ComputeWAXPBY(nc, 1.0, rc, -1.0, Axc, rc2, isOptimized); if (ierr!=0) return ierr;
+  int secondCycleType = cycleType==HPGMP_MG_F_CYCLE ? HPGMP_MG_V_CYCLE : cycleType;
+  ierr = ComputeCoarseCycle(A, rc2, xc2, x, symmetric, secondCycleType, level); if (ierr!=0) return ierr;
+  return ComputeWAXPBY(nc, 1.0, xc, 1.0, xc2, xc, isOptimized);
+}
 
 /*!
+  Recursive multigrid cycle of the given type on the level of A (see ComputeMG), the given level of
+  the hierarchy, profiled as the region of that level.
+ */
+template<class SparseMatrix_type, class Vector_type>
+static int ComputeMGCycle(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool symmetric, int cycleType, int level) {
+  assert(x.localLength==A.localNumberOfColumns); // Make sure x contain space for halo values
+  ProfileScope levelRegion("Level", level);
+
+  // x is zero on entry of the cycle: the first smoothing step starts from a zero initial guess,
+  // which it sets itself, and x is only zeroed explicitly on the other paths
+  double t0 = 0.0;
+  double levelStart = mytimer();
+
+  int ierr = 0;
+  if (A.agglomeration!=0) { // Solve this level on the active processes
+    ZeroVector(x);
+    GatherAgglomeratedVector(A, r);
+    const SparseMatrix_type * Aa = A.agglomeration->A;
+    if (Aa!=0) {
+      A.mgLevelTime += mytimer() - levelStart;
+      Vector_type & xa = *A.agglomeration->x;
+      xa.time1 = xa.time2 = 0.0; xa.time3 = xa.time4 = 0.0;
+      ProfileScope agglomeratedRegion("Agglomerated");
+      ierr = ComputeMGCycle(*Aa, *A.agglomeration->r, xa, symmetric, cycleType, level);
+      x.time1 += xa.time1; x.time2 += xa.time2;
+      x.time3 += xa.time3; x.time4 += xa.time4;
+      levelStart = mytimer();
+    }
+    ScatterAgglomeratedVector(A, x);
+    A.mgLevelTime += mytimer() - levelStart;
+    return ierr;
+  }
+  else if (A.mgData!=0) { // Go to next coarse level if defined
+    int numberOfPresmootherSteps = A.mgData->numberOfPresmootherSteps;
+    if (numberOfPresmootherSteps==0) ZeroVector(x);
+    {
+      ProfileScope region("Smoother", -1, ModelSmootherBytes(A, numberOfPresmootherSteps),
+                          2.0*numberOfPresmootherSteps*A.localNumberOfNonzeros);
+      ierr = ComputeSmootherSteps(A, r, x, numberOfPresmootherSteps, symmetric, true);
+    }
+    if (ierr!=0) return ierr;
+
+    // Residual at the injected points and restriction, timed as restriction
+    {
+      ProfileScope region("Restriction", -1, ModelRestrictionBytes(A));
+      TICK();
+      double time1 = x.time1, time2 = x.time2;
+      ierr = ComputeResidualRestriction(A, r, x); if (ierr!=0) return ierr;
+      x.time1 = time1; x.time2 = time2;
+      TOCK(x.time3);
+    }
+
+    // MG on coarser-grid
+    A.mgLevelTime += mytimer() - levelStart;
+    ierr = ComputeCoarseCorrection(A, x, symmetric, cycleType, level); if (ierr!=0) return ierr;
+    levelStart = mytimer();
+
+    // Prolongation operation, within the first post-smoothing step when possible
+    int numberOfPostsmootherSteps = A.mgData->numberOfPostsmootherSteps;
+    int firstPostsmootherStep = 0;
+    if (A.mgData->isProlongationFused && numberOfPostsmootherSteps>0) {
+      ProfileScope region("Prolongation Smoother", -1, ModelProlongationBytes(A) + ModelSmootherBytes(A, 1), 2.0*A.localNumberOfNonzeros);
+      double time1 = x.time1;
+      ierr = ComputeProlongationSmoother(A, r, x, symmetric);  if (ierr!=0) return ierr;
+      x.time1 = time1;
+      firstPostsmootherStep = 1;
+    } else {
+      ProfileScope region("Prolongation", -1, ModelProlongationBytes(A));
+      TICK();
+      ierr = ComputeProlongation_ref(A, x);  if (ierr!=0) return ierr;
+      TOCK(x.time4);
+    }
+
+    // Post-smoothing
+    {
+      const int numberOfSteps = numberOfPostsmootherSteps-firstPostsmootherStep;
+      ProfileScope region("Smoother", -1, ModelSmootherBytes(A, numberOfSteps), 2.0*numberOfSteps*A.localNumberOfNonzeros);
+      ierr = ComputeSmootherSteps(A, r, x, numberOfSteps, symmetric);
+    }
+    if (ierr!=0) return ierr;
+  }
+  else {
+    // coarsest grid
+    if (A.coarseSolver!=0) {
+      ProfileScope region("Coarse Solve");
+      ZeroVector(x);
+      ierr = ComputeCoarseSolve(A, r, x);
+    } else {
+      ProfileScope region("Smoother", -1, ModelSmootherBytes(A, 1), 2.0*A.localNumberOfNonzeros);
+      ierr = ComputeSmoother(A, r, x, symmetric, true);
+    }
+    if (ierr!=0) return ierr;
+  }
+  A.mgLevelTime += mytimer() - levelStart;
+  return 0;
+}
+
+/*!
+  Smoothing of one level of the additive cycle from a zero initial guess: the pre-smoothing steps of
+  the level, or the smoother sweep or direct solve of the coarsest level.
+ */
+template<class SparseMatrix_type, class Vector_type>
+static int ComputeAdditiveSmoothing(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool symmetric, int level) {
+  ProfileScope levelRegion("Level", level);
+  double levelStart = mytimer();
+  int ierr = 0;
+  if (A.mgData==0 && A.coarseSolver!=0) {
+    ZeroVector(x);
+    ierr = ComputeCoarseSolve(A, r, x);
+  } else {
+    int numberOfSteps = A.mgData!=0 ? A.mgData->numberOfPresmootherSteps : 1;
+    if (numberOfSteps==0) ZeroVector(x);
+    ierr = ComputeSmootherSteps(A, r, x, numberOfSteps, symmetric, true);
+  }
+  A.mgLevelTime += mytimer() - levelStart;
+  return ierr;
+}
+
+/*!
+  Additive multigrid cycle on the hierarchy of A: the fine residual r is injected into every coarse
+  level at once through the chains precomputed by SetupMatrix, each level smooths its residual from a
+  zero initial guess, and the corrections of all levels are injected back and summed into x.  This is
+  a fixed linear operator, so it can be used as the right preconditioner of GMRES.
+
+  Since the levels are independent, they are smoothed concurrently, one OpenMP task per level, when
+  their smoothing is a single Gauss-Seidel sweep, which needs no halo exchange and runs on one thread;
+  the coarse levels then take no time beyond that of the fine level.  Other smoothers use all threads
+  on each level in turn.  The mgLevelTime of each level is the time spent smoothing it, so that the
+  level times of a concurrent cycle add up to more than its elapsed time.
+ */
+template<class SparseMatrix_type, class Vector_type>
+static int ComputeAdditiveCycle(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool symmetric) {
+  assert(x.localLength==A.localNumberOfColumns); // Make sure x contain space for halo values
+
+  const int numberOfLevels = A.mgData->numberOfAdditiveLevels;
+  local_int_t * const * additiveRows = A.mgData->additiveRows;
+  std::vector<const SparseMatrix_type *> levels(numberOfLevels);
+  std::vector<const Vector_type *> rl(numberOfLevels);
+  std::vector<Vector_type *> xl(numberOfLevels);
+  levels[0] = &A; rl[0] = &r; xl[0] = &x;
+  for (int level=1; level<numberOfLevels; ++level) {
+    levels[level] = levels[level-1]->Ac;
+    rl[level] = levels[level-1]->mgData->rc;
+    xl[level] = levels[level-1]->mgData->xc;
+  }
+
+  // Restriction chains: every coarse residual is gathered from the fine residual
+  double t0 = 0.0;
+  double levelStart = mytimer();
+  TICK();
+  const typename Vector_type::scalar_type * const rv = r.values;
+  for (int level=1; level<numberOfLevels; ++level) {
+    const local_int_t * const rows = additiveRows[level-1];
+    typename Vector_type::scalar_type * const rcv = levels[level-1]->mgData->rc->values;
+    const local_int_t nc = levels[level]->localNumberOfRows;
+#ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel for
+#endif
+    for (local_int_t i=0; i<nc; ++i) rcv[i] = rv[rows[i]];
+  }
+  TOCK(x.time3);
+  A.mgLevelTime += mytimer() - levelStart;
+
+  // Smoothing of all levels, the fine level first since it takes the longest
+  std::vector<int> ierrs(numberOfLevels, 0);
+  for (int level=1; level<numberOfLevels; ++level) {
+    xl[level]->time1 = xl[level]->time2 = 0.0; xl[level]->time3 = xl[level]->time4 = 0.0;
+  }
+  if (A.mgData->isAdditiveConcurrent) {
+#ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel
+    #pragma omp single
+#endif
+    for (int level=0; level<numberOfLevels; ++level) {
+#ifndef HPGMP_NO_OPENMP
+      #pragma omp task firstprivate(level) shared(levels, rl, xl, ierrs)
+#endif
+      ierrs[level] = ComputeAdditiveSmoothing(*levels[level], *rl[level], *xl[level], symmetric, level);
+    }
+  } else {
+    for (int level=0; level<numberOfLevels; ++level)
+      ierrs[level] = ComputeAdditiveSmoothing(*levels[level], *rl[level], *xl[level], symmetric, level);
+  }
+  for (int level=1; level<numberOfLevels; ++level) {
+    x.time1 += xl[level]->time1; x.time2 += xl[level]->time2;
+    x.time3 += xl[level]->time3; x.time4 += xl[level]->time4;
+  }
+  for (int level=0; level<numberOfLevels; ++level) if (ierrs[level]!=0) return ierrs[level];
+
+  // Prolongation chains: the corrections of all levels are summed into the fine one
+  levelStart = mytimer();
+  TICK();
+  typename Vector_type::scalar_type * const xv = x.values;
+  for (int level=1; level<numberOfLevels; ++level) {
+    const local_int_t * const rows = additiveRows[level-1];
+    const typename Vector_type::scalar_type * const xcv = xl[level]->values;
+    const local_int_t nc = levels[level]->localNumberOfRows;
+#ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel for
+#endif
+    for (local_int_t i=0; i<nc; ++i) xv[rows[i]] += xcv[i];
+  }
+  TOCK(x.time4);
+  A.mgLevelTime += mytimer() - levelStart;
+  return 0;
+}
+#endif
+
+/*!
+  The cycle type is selected at setup (mgData->cycleType of the finest level, see SetupMatrix).
+  Each cycle follows ComputeMG_ref on every level, except that the fine residual is only computed
+  at the points injected into the coarse grid, fused with the restriction (see
+  ComputeResidualRestriction), that the prolongation is applied within the first post-smoothing
+  sweep (see ComputeProlongationSmoother), that the first smoothing step of each level exploits
+  the zero initial guess, and that consecutive Gauss-Seidel sweeps are temporally blocked where possible
+  (see ComputeSmootherSteps).  The smoother of each level is the one selected at setup (see ComputeSmoother).  The time spent on each level is accumulated in its mgLevelTime.
+  The additive cycle instead smooths all levels independently and sums their corrections (see ComputeAdditiveCycle).
+
   @param[in] A the known system matrix
   @param[in] r the input vector
-  @param[inout] x On exit contains the result of the multigrid V-cycle with r as the RHS, x is the approximation to Ax = r.
+  @param[inout] x On exit contains the result of the multigrid cycle with r as the RHS, x is the approximation to Ax = r.
 
   @return returns 0 upon success and non-zero otherwise
 
@@ -35,9 +342,14 @@
 template<class SparseMatrix_type, class Vector_type>
 int ComputeMG(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool symmetric) {
 
-  // This line and the next two lines should be removed and your version of ComputeSYMGS should be used.
+#if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
   A.isMgOptimized = false;
   return ComputeMG_ref(A, r, x, symmetric);
+#else
+  int cycleType = A.mgData!=0 ? A.mgData->cycleType : HPGMP_MG_V_CYCLE;
+  if (cycleType==HPGMP_MG_ADDITIVE_CYCLE) return ComputeAdditiveCycle(A, r, x, symmetric);
+  return ComputeMGCycle(A, r, x, symmetric, cycleType, 0);
+#endif
 }
 
 
@@ -50,4 +362,3 @@ int ComputeMG< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const
 
 template
 int ComputeMG< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, bool);
-
@@ -18,8 +18,33 @@
 #define COMPUTEMG_HPP
 #include "SparseMatrix.hpp"
 #include "Vector.hpp"
+#include <vector>
 
 template<class SparseMatrix_type, class Vector_type>
 int ComputeMG(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool symmetric=true);
 
+/*!
+  Adds the time spent by ComputeMG on each level of the hierarchy of A (level 0 is A) to levelTimes,
+  and resets the per-level timers.  Agglomerated levels count the time of both their copies.
+
+  @param[in]    A          The finest level matrix
+  @param[inout] levelTimes Accumulated times, extended to the number of levels held by this process
+ */
+template<class SparseMatrix_type>
+inline void CollectMGLevelTimes(const SparseMatrix_type & A, std::vector<double> & levelTimes) {
+  int level = 0;
+  for (const SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; ++level) {
+    if (levelTimes.size()<=(size_t) level) levelTimes.push_back(0.0);
+    levelTimes[level] += curLevelMatrix->mgLevelTime;
+    curLevelMatrix->mgLevelTime = 0.0;
+    const SparseMatrix_type * active = ActiveLevelMatrix(curLevelMatrix);
+    if (active!=curLevelMatrix) {
+      levelTimes[level] += active->mgLevelTime;
+      active->mgLevelTime = 0.0;
+    }
+    curLevelMatrix = active->Ac;
+  }
+  return;
+}
+
 #endif // COMPUTEMG_HPP
@@ -26,6 +26,8 @@
 #include "ComputeSPMV_ref.hpp"
 #include "ComputeRestriction_ref.hpp"
 #include "ComputeProlongation_ref.hpp"
+#include "AgglomerateProblem.hpp"
+#include "ComputeCoarseSolve.hpp"
 #ifdef HPGMP_DEBUG
 #include "hpgmp.hpp"
 #endif
@@ -52,7 +54,20 @@ int ComputeMG_ref(const SparseMatrix_type & A, const Vector_type & r, Vector_typ
   ZeroVector(x);
 
   int ierr = 0;
-  if (A.mgData!=0) { // Go to next coarse level if defined
+  if (A.agglomeration!=0) { // Solve this level on the active processes
+    GatherAgglomeratedVector(A, r);
+    const SparseMatrix_type * Aa = A.agglomeration->A;
+    if (Aa!=0) {
+      Vector_type & xa = *A.agglomeration->x;
+      xa.time1 = xa.time2 = 0.0; xa.time3 = xa.time4 = 0.0;
+      ierr = ComputeMG_ref(*Aa, *A.agglomeration->r, xa, symmetric);
+      x.time1 += xa.time1; x.time2 += xa.time2;
+      x.time3 += xa.time3; x.time4 += xa.time4;
+    }
+    ScatterAgglomeratedVector(A, x);
+    return ierr;
+  }
+  else if (A.mgData!=0) { // Go to next coarse level if defined
     int numberOfPresmootherSteps = A.mgData->numberOfPresmootherSteps;
     if (symmetric) {
       for (int i=0; i< numberOfPresmootherSteps; ++i) ierr += ComputeSYMGS_ref(A, r, x);
@@ -95,7 +110,9 @@ int ComputeMG_ref(const SparseMatrix_type & A, const Vector_type & r, Vector_typ
   }
   else {
     // coarsest grid
-    if (symmetric) {
+    if (A.coarseSolver!=0) {
+      ierr = ComputeCoarseSolve(A, r, x);
+    } else if (symmetric) {
       ierr = ComputeSYMGS_ref(A, r, x);
     } else {
       ierr = ComputeGS_Forward_ref(A, r, x);
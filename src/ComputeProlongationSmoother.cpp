@@ -0,0 +1,177 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ComputeProlongationSmoother.cpp
+
+ HPGMP routine
+ */
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#include <vector>
+#include "Utils_MPI.hpp"
+#endif
+
+#include "ComputeProlongationSmoother.hpp"
+#include "mytimer.hpp"
+#include <cassert>
+
+/*!
+  Routine to apply the coarse grid correction followed by the first post-smoothing sweep, in one
+  pass over the fine matrix and vector.
+
+  The correction of a fine point is added when the Gauss-Seidel sweep first needs its value: before
+  row i is relaxed, the corrections of all injected points up to the largest local column of row i
+  are applied, which requires f2cOperator to be increasing (see OptimizeProblem).  Neighbors
+  receive their halo values with the correction already added, and the wait for the halo is
+  deferred to the first row with an external column.
+
+  For the symmetric smoother the backward sweep follows without further communication, as in
+  ComputeSYMGS_ref.  The rows with HPGMP_FULL_ROW_LENGTH nonzeros use the fully unrolled row kernel.
+
+  @param[in]    Af        The fine level matrix, containing the coarse correction in mgData->xc
+  @param[in]    r         The fine grid right hand side
+  @param[inout] xf        The fine grid approximation, on exit corrected and smoothed
+  @param[in]    symmetric If true, one symmetric Gauss-Seidel step, otherwise one forward sweep
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see ComputeProlongation_ref
+  @see ComputeGS_Forward_ref
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeProlongationSmoother(const SparseMatrix_type & Af, const Vector_type & r, Vector_type & xf, bool symmetric) {
+
+  assert(xf.localLength==Af.localNumberOfColumns); // Make sure x contain space for halo values
+  assert(Af.mgData->isProlongationFused);
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const local_int_t nrow = Af.localNumberOfRows;
+  const local_int_t nc = Af.mgData->rc->localLength;
+  const local_int_t * const f2c = Af.mgData->f2cOperator;
+  const scalar_type * const xcv = Af.mgData->xc->values;
+  const scalar_type * const rv = r.values;
+  scalar_type * const xv = xf.values;
+  scalar_type ** matrixDiagonal = Af.matrixDiagonal;
+
+  double t0 = 0.0;
+#ifndef HPGMP_NO_MPI
+  local_int_t firstHaloRow = nrow;
+  MPI_Datatype MPI_SCALAR_TYPE = MpiTypeTraits<scalar_type>::getType ();
+  const int num_neighbors = Af.geom->size > 1 ? Af.numberOfSendNeighbors : 0;
+  std::vector<MPI_Request> request(2*num_neighbors);
+  if (num_neighbors>0) {
+    int MPI_MY_TAG = 99;
+    scalar_type * x_external = xv + nrow;
+    for (int i=0; i<num_neighbors; i++) {
+      MPI_Irecv(x_external, Af.receiveLength[i], MPI_SCALAR_TYPE, Af.neighbors[i], MPI_MY_TAG, Af.comm, &request[i]);
+      x_external += Af.receiveLength[i];
+    }
+
+    // Send the boundary values with their correction
+    const local_int_t * const elementsToSend = Af.elementsToSend;
+    const local_int_t * const sendCorrection = Af.mgData->sendCorrection;
+    for (local_int_t i=0; i<Af.totalToBeSent; i++) {
+      scalar_type value = xv[elementsToSend[i]];
+      if (sendCorrection[i]>=0) value += xcv[sendCorrection[i]];
+      Af.sendBuffer[i] = value;
+    }
+    scalar_type * sendBuffer = Af.sendBuffer;
+    for (int i=0; i<num_neighbors; i++) {
+      MPI_Isend(sendBuffer, Af.sendLength[i], MPI_SCALAR_TYPE, Af.neighbors[i], MPI_MY_TAG, Af.comm, &request[num_neighbors+i]);
+      sendBuffer += Af.sendLength[i];
+    }
+    firstHaloRow = Af.mgData->firstHaloRow;
+  }
+#endif
+
+  TICK();
+  local_int_t c = 0; // corrections of the injected points f2c[0..c-1] have been applied
+  for (local_int_t i=0; i < nrow; i++) {
+#ifndef HPGMP_NO_MPI
+    if (i==firstHaloRow) MPI_Waitall(num_neighbors, request.data(), MPI_STATUSES_IGNORE);
+#endif
+    const scalar_type * const currentValues = Af.matrixValues[i];
+    const local_int_t * const currentColIndices = Af.mtxIndL[i];
+    const int currentNumberOfNonzeros = Af.nonzerosInRow[i];
+    const scalar_type currentDiagonal = matrixDiagonal[i][0]; // Current diagonal value
+
+    local_int_t lastColumn = i;
+    for (int j=0; j< currentNumberOfNonzeros; j++) {
+      local_int_t curCol = currentColIndices[j];
+      if (curCol<nrow && curCol>lastColumn) lastColumn = curCol;
+    }
+    for (; c<nc && f2c[c]<=lastColumn; ++c) xv[f2c[c]] += xcv[c];
+
+    scalar_type sum = rv[i]; // RHS value
+    if (currentNumberOfNonzeros==HPGMP_FULL_ROW_LENGTH) {
+      sum = Row<HPGMP_FULL_ROW_LENGTH>::Subtract(currentValues, currentColIndices, xv, sum);
+    } else {
+      for (int j=0; j< currentNumberOfNonzeros; j++) {
+        local_int_t curCol = currentColIndices[j];
+        sum -= currentValues[j] * xv[curCol];
+      }
+    }
+    sum += xv[i]*currentDiagonal; // Remove diagonal contribution from previous loop
+
+    xv[i] = sum/currentDiagonal;
+  }
+  for (; c<nc; ++c) xv[f2c[c]] += xcv[c];
+#ifndef HPGMP_NO_MPI
+  if (firstHaloRow>=nrow && num_neighbors>0) MPI_Waitall(num_neighbors, request.data(), MPI_STATUSES_IGNORE);
+  if (num_neighbors>0) MPI_Waitall(num_neighbors, request.data()+num_neighbors, MPI_STATUSES_IGNORE);
+#endif
+
+  if (symmetric) {
+    for (local_int_t i=nrow-1; i>=0; i--) {
+      const scalar_type * const currentValues = Af.matrixValues[i];
+      const local_int_t * const currentColIndices = Af.mtxIndL[i];
+      const int currentNumberOfNonzeros = Af.nonzerosInRow[i];
+      const scalar_type currentDiagonal = matrixDiagonal[i][0]; // Current diagonal value
+      scalar_type sum = rv[i]; // RHS value
+
+      if (currentNumberOfNonzeros==HPGMP_FULL_ROW_LENGTH) {
+        sum = Row<HPGMP_FULL_ROW_LENGTH>::Subtract(currentValues, currentColIndices, xv, sum);
+      } else {
+        for (int j = 0; j< currentNumberOfNonzeros; j++) {
+          local_int_t curCol = currentColIndices[j];
+          sum -= currentValues[j]*xv[curCol];
+        }
+      }
+      sum += xv[i]*currentDiagonal; // Remove diagonal contribution from previous loop
+
+      xv[i] = sum/currentDiagonal;
+    }
+  }
+  TOCK(xf.time2);
+
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeProlongationSmoother< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&, bool);
+
+template
+int ComputeProlongationSmoother< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, bool);
+
+#endif
@@ -48,6 +48,17 @@ int ComputeProlongation_ref(const SparseMatrix_type & Af, Vector_type & xf) {
   local_int_t * f2c = Af.mgData->f2cOperator;
   local_int_t nc = Af.mgData->rc->localLength;
 
+  if (Af.mgData->aggregates!=0) {
+    // Aggregation: every fine row takes the correction of its aggregate
+    const local_int_t * agg = Af.mgData->aggregates;
+    local_int_t nf = Af.localNumberOfRows;
+    #ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel for
+    #endif
+    for (local_int_t i=0; i<nf; ++i) xfv[i] += xcv[agg[i]];
+    return 0;
+  }
+
   #ifndef HPGMP_NO_OPENMP
   #pragma omp parallel for
   #endif
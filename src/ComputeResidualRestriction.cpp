@@ -0,0 +1,151 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ComputeResidualRestriction.cpp
+
+ HPGMP routine
+ */
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#include <vector>
+#include "Utils_MPI.hpp"
+#include "ExchangeHalo.hpp"
+#endif
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include "ComputeResidualRestriction.hpp"
+#include "ComputeSPMV.hpp"
+#include "ComputeRestriction_ref.hpp"
+
+#ifndef HPGMP_NO_MPI
+/*!
+  Communicates the external values of x referenced by the rows in f2cOperator.
+
+  @param[in]    A The fine level matrix, with mgData->restrictionHalo set up by SetupRestrictionHalo
+  @param[inout] x On exit, the external entries used by ComputeResidualRestriction are updated
+ */
+template<class SparseMatrix_type, class Vector_type>
+static void ExchangeRestrictionHalo(const SparseMatrix_type & A, Vector_type & x) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  MPI_Datatype MPI_SCALAR_TYPE = MpiTypeTraits<scalar_type>::getType ();
+  const RestrictionHaloData<scalar_type> & halo = *A.mgData->restrictionHalo;
+  const int num_neighbors = A.numberOfSendNeighbors;
+  scalar_type * const xv = x.values;
+  int MPI_MY_TAG = 97;
+
+  std::vector<MPI_Request> request(num_neighbors);
+  scalar_type * receiveBuffer = halo.receiveBuffer;
+  for (int i=0; i<num_neighbors; i++) {
+    MPI_Irecv(receiveBuffer, halo.receiveLength[i], MPI_SCALAR_TYPE, A.neighbors[i], MPI_MY_TAG, A.comm, &request[i]);
+    receiveBuffer += halo.receiveLength[i];
+  }
+
+  for (local_int_t i=0; i<halo.totalToBeSent; i++) halo.sendBuffer[i] = xv[halo.elementsToSend[i]];
+  scalar_type * sendBuffer = halo.sendBuffer;
+  for (int i=0; i<num_neighbors; i++) {
+    MPI_Send(sendBuffer, halo.sendLength[i], MPI_SCALAR_TYPE, A.neighbors[i], MPI_MY_TAG, A.comm);
+    sendBuffer += halo.sendLength[i];
+  }
+
+  MPI_Waitall(num_neighbors, request.data(), MPI_STATUSES_IGNORE);
+  for (local_int_t i=0; i<halo.totalToBeReceived; i++) xv[halo.externalColumns[i]] = halo.receiveBuffer[i];
+  return;
+}
+#endif
+
+/*!
+  Routine to compute the coarse residual vector rc = R*(rf - A*x), fusing the residual and the
+  injection: the product A*x is only evaluated at the fine rows in f2cOperator, about one eighth of
+  the rows for generated problems, and only the external values of x these rows reference are
+  communicated when SetupRestrictionHalo was called (the whole halo is exchanged otherwise).  The
+  columns of these rows are decoded from the compressed indices of A when they are set up.
+
+  Levels coarsened by aggregation need the residual at every fine row, so the full product is
+  computed in mgData->Axf and restricted with ComputeRestriction_ref.
+
+  @param[in]    A  The fine level matrix, the result is written to mgData->rc
+  @param[in]    rf The fine grid right hand side
+  @param[inout] x  The current fine grid approximation; its external entries are updated
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see ComputeRestriction_ref
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeResidualRestriction(const SparseMatrix_type & A, const Vector_type & rf, Vector_type & x) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+
+  if (A.mgData->f2cOperator==0) {
+    int ierr = ComputeSPMV(A, x, *A.mgData->Axf); if (ierr!=0) return ierr;
+    return ComputeRestriction_ref(A, rf);
+  }
+
+#ifndef HPGMP_NO_MPI
+  if (A.geom->size > 1) {
+    if (A.mgData->restrictionHalo!=0) ExchangeRestrictionHalo(A, x);
+    else ExchangeHalo(A, x);
+  }
+#endif
+
+  const scalar_type * const xv = x.values;
+  const scalar_type * const rfv = rf.values;
+  scalar_type * const rcv = A.mgData->rc->values;
+  const local_int_t * const f2c = A.mgData->f2cOperator;
+  const local_int_t nc = A.mgData->rc->localLength;
+  const CompressedIndexData * const indices = A.compressedIndices;
+
+  #ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+  #endif
+  for (local_int_t i=0; i<nc; ++i) {
+    const local_int_t row = f2c[i];
+    const scalar_type * const cur_vals = A.matrixValues[row];
+    const local_int_t * const cur_inds = A.mtxIndL[row];
+    const int cur_nnz = A.nonzerosInRow[row];
+
+    scalar_type sum = rfv[row];
+    if (indices!=0) {
+      rcv[i] = AccumulateCompressedRow<-1, false>(*indices, row, cur_nnz, cur_inds, cur_vals, xv, sum);
+      continue;
+    }
+    for (int j=0; j< cur_nnz; j++)
+      sum -= cur_vals[j]*xv[cur_inds[j]];
+    rcv[i] = sum;
+  }
+
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeResidualRestriction< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&);
+
+template
+int ComputeResidualRestriction< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&);
+
+#endif
@@ -50,6 +50,21 @@ int ComputeRestriction_ref(const SparseMatrix_type & A, const Vector_type & rf)
   local_int_t * f2c = A.mgData->f2cOperator;
   local_int_t nc = A.mgData->rc->localLength;
 
+  if (A.mgData->aggregates!=0) {
+    // Aggregation: sum the fine residual over the rows of each aggregate
+    const local_int_t * start = A.mgData->aggregateStart;
+    const local_int_t * rows = A.mgData->aggregateRows;
+    #ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel for
+    #endif
+    for (local_int_t i=0; i<nc; ++i) {
+      scalar_type sum = 0.0;
+      for (local_int_t k=start[i]; k<start[i+1]; ++k) sum += rfv[rows[k]] - Axfv[rows[k]];
+      rcv[i] = sum;
+    }
+    return 0;
+  }
+
   #ifndef HPGMP_NO_OPENMP
   #pragma omp parallel for
   #endif
@@ -22,6 +22,107 @@
 
 #include "ComputeSPMV.hpp"
 #include "ComputeSPMV_ref.hpp"
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+#include "ComputeSPMV_stencil.hpp"
+#include "SimdBackend.hpp"
+
+#ifndef HPGMP_NO_MPI
+#include "ExchangeHalo.hpp"
+#endif
+
+#ifndef HPGMP_NO_OPENMP
+ #include <omp.h>
+#endif
+#include <cassert>
+
+/*!
+  Computes y = Ax like ComputeSPMV_ref, with the columns decoded from the compressed indices of A
+  (see CompressedIndexData), and the products summed in the same order.
+
+  The codes are decoded in the scalar address computation of each load.  There is no separate SIMD
+  pass that decodes a row into a column array: the row sums keep the reference order, so they are a
+  chain of dependent additions, and the extra pass measured slower than plain CSR.
+ */
+template<class SparseMatrix_type, class Vector_type>
+static int ComputeSPMV_compressed(const SparseMatrix_type & A, Vector_type & x, Vector_type & y) {
+
+  assert(x.localLength>=A.localNumberOfColumns); // Test vector lengths
+  assert(y.localLength>=A.localNumberOfRows);
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+
+  const CompressedIndexData & indices = *A.compressedIndices;
+  const local_int_t nrow = A.localNumberOfRows;
+  scalar_type * const xv = x.values;
+  scalar_type * const yv = y.values;
+
+#ifndef HPGMP_NO_MPI
+  if (A.geom->size > 1) {
+    ExchangeHalo(A, x);
+  }
+#endif
+
+  #ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+  #endif
+  for (local_int_t i=0; i< nrow; i++)  {
+    scalar_type sum = 0.0;
+    yv[i] = AccumulateCompressedRow<1, false>(indices, i, A.nonzerosInRow[i], A.mtxIndL[i], A.matrixValues[i], xv, sum);
+  }
+
+  return 0;
+}
+
+/*!
+  Computes y = Ax like ComputeSPMV_ref, run by run (see RowRunData): the full rows with the SIMD backend,
+  or the fully unrolled Row<HPGMP_FULL_ROW_LENGTH>, and the stride of their run, and the other rows like the reference.
+ */
+template<class SparseMatrix_type, class Vector_type>
+static int ComputeSPMV_rows(const SparseMatrix_type & A, Vector_type & x, Vector_type & y) {
+
+  assert(x.localLength>=A.localNumberOfColumns); // Test vector lengths
+  assert(y.localLength>=A.localNumberOfRows);
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+
+  const RowRunData & runs = *A.rowRuns;
+  scalar_type * const xv = x.values;
+  scalar_type * const yv = y.values;
+
+#ifndef HPGMP_NO_MPI
+  if (A.geom->size > 1) {
+    ExchangeHalo(A, x);
+  }
+#endif
+
+  #ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for schedule(dynamic, 16)
+  #endif
+  for (local_int_t run=0; run<runs.numberOfRuns; run++) {
+    const local_int_t first = runs.runStart[run], last = runs.runStart[run+1];
+    if (run%2==1) {
+      const scalar_type * cur_vals = A.matrixValues[first];
+      const local_int_t * cur_inds = A.mtxIndL[first];
+      if (SimdSPMVFullRows(cur_vals, cur_inds, xv, yv+first, last-first)) continue;
+      for (local_int_t i=first; i<last; i++, cur_vals+=HPGMP_FULL_ROW_LENGTH, cur_inds+=HPGMP_FULL_ROW_LENGTH) {
+        scalar_type sum = 0.0;
+        yv[i] = Row<HPGMP_FULL_ROW_LENGTH>::Add(cur_vals, cur_inds, xv, sum);
+      }
+      continue;
+    }
+    for (local_int_t i=first; i<last; i++) {
+      scalar_type sum = 0.0;
+      const scalar_type * const cur_vals = A.matrixValues[i];
+      const local_int_t * const cur_inds = A.mtxIndL[i];
+      const int cur_nnz = A.nonzerosInRow[i];
+
+      for (int j=0; j< cur_nnz; j++)
+        sum += cur_vals[j]*xv[cur_inds[j]];
+      yv[i] = sum;
+    }
+  }
+
+  return 0;
+}
+#endif
 
 /*!
   Routine to compute sparse matrix vector product y = Ax where:
@@ -29,7 +130,9 @@
 
   This routine calls the reference SpMV implementation by default, but
   can be replaced by a custom, optimized routine suited for
-  the target system.
+  the target system.  Levels set up in the DIA format by OptimizeProblem use ComputeSPMV_stencil,
+  levels with compressed column indices decode them within the scalar row loop (not with SIMD, see
+  ComputeSPMV_compressed), and the full rows of the other levels use fixed-width kernels.
 
   @param[in]  A the known system matrix
   @param[in]  x the known vector
@@ -38,10 +141,17 @@
   @return returns 0 upon success and non-zero otherwise
 
   @see ComputeSPMV_ref
+  @see ComputeSPMV_stencil
 */
 template<class SparseMatrix_type, class Vector_type>
 int ComputeSPMV(const SparseMatrix_type & A, Vector_type & x, Vector_type & y) {
 
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+  if (A.stencilData!=0) return ComputeSPMV_stencil(A, x, y);
+  if (A.compressedIndices!=0) return ComputeSPMV_compressed(A, x, y);
+  if (A.rowRuns!=0) return ComputeSPMV_rows(A, x, y);
+#endif
+
   // This line and the next two lines should be removed and your version of ComputeSPMV should be used.
   A.isSpmvOptimized = false;
   return ComputeSPMV_ref(A, x, y);
@@ -0,0 +1,111 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ComputeSPMV_stencil.cpp
+
+ HPGMP routine
+ */
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+
+#include "ComputeSPMV_stencil.hpp"
+
+#ifndef HPGMP_NO_MPI
+#include "ExchangeHalo.hpp"
+#endif
+
+#ifndef HPGMP_NO_OPENMP
+ #include <omp.h>
+#endif
+#include <cassert>
+
+/*!
+  Routine to compute the matrix vector product y = Ax with the DIA copy of A (see StencilData):
+  the local entries of x are copied into the padded layout, whose ghost cells receive the halo
+  (see ExchangePaddedHalo, the external entries of x are not updated), and each x-line of the local grid
+  accumulates the products of the coefficient planes with the shifted x-lines, without column
+  indices.  The terms of a row are summed in the same order as in ComputeSPMV_ref.
+
+  @param[in]  A the known system matrix, with its stencil data set up by SetupStencilMatrix
+  @param[in]  x the known vector
+  @param[out] y the On exit contains the result: Ax.
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSPMV
+  @see ComputeSPMV_ref
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeSPMV_stencil(const SparseMatrix_type & A, Vector_type & x, Vector_type & y) {
+
+  assert(x.localLength>=A.localNumberOfColumns); // Test vector lengths
+  assert(y.localLength>=A.localNumberOfRows);
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+
+  const StencilData<scalar_type> & stencil = *A.stencilData;
+  const local_int_t nrow = A.localNumberOfRows;
+  const local_int_t nx = stencil.nx, numberOfLines = stencil.ny*stencil.nz;
+  const scalar_type * const xv = x.values;
+  scalar_type * const yv = y.values;
+
+  LoadPaddedVector(stencil, xv);
+#ifndef HPGMP_NO_MPI
+  if (A.geom->size > 1) {
+    ExchangePaddedHalo(A, x);
+  }
+#endif
+
+  #ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+  #endif
+  for (local_int_t line=0; line<numberOfLines; ++line) {
+    const local_int_t row = line*nx;
+    const scalar_type * const xline = stencil.paddedVector + PaddedIndex(stencil, 0, line%stencil.ny, line/stencil.ny);
+    scalar_type * const yline = yv + row;
+    for (local_int_t ix=0; ix<nx; ++ix) yline[ix] = 0.0;
+    for (int k=0; k<HPGMP_STENCIL_POINTS; ++k) {
+      const scalar_type * const cur_vals = stencil.values + ((size_t) k)*nrow + row;
+      const scalar_type * const cur_x = xline + stencil.offsets[k];
+      for (local_int_t ix=0; ix<nx; ++ix) yline[ix] += cur_vals[ix]*cur_x[ix];
+    }
+  }
+
+  // Rows that do not fit in the stencil
+  for (local_int_t f=0; f<stencil.numberOfFallbackRows; ++f) {
+    const local_int_t i = stencil.fallbackRows[f];
+    const scalar_type * const cur_vals = A.matrixValues[i];
+    const local_int_t * const cur_inds = A.mtxIndL[i];
+    scalar_type sum = 0.0;
+    for (int j=0; j<A.nonzerosInRow[i]; j++)
+      sum += cur_vals[j]*stencil.paddedVector[PaddedColumnIndex(stencil, nrow, cur_inds[j])];
+    yv[i] = sum;
+  }
+
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeSPMV_stencil< SparseMatrix<double>, Vector<double> >(const SparseMatrix<double> &, Vector<double>&, Vector<double>&);
+
+template
+int ComputeSPMV_stencil< SparseMatrix<float>, Vector<float> >(const SparseMatrix<float> &, Vector<float>&, Vector<float>&);
+
+#endif
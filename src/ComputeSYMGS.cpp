@@ -22,6 +22,7 @@
 
 #include "ComputeSYMGS.hpp"
 #include "ComputeSYMGS_ref.hpp"
+#include "ComputeGS_Forward.hpp"
 
 /*!
   Routine to compute one step of symmetric Gauss-Seidel:
@@ -42,6 +43,7 @@
   @param[in] A the known system matrix
   @param[in] r the input vector
   @param[inout] x On entry, x should contain relevant values, on exit x contains the result of one symmetric GS sweep with r as the RHS.
+  @param[in] xIsZero If true, x is assumed to be zero on entry (its values are ignored): the halo exchange and the upper triangular terms of the forward sweep are skipped.
 
   @return returns 0 upon success and non-zero otherwise
 
@@ -50,9 +52,51 @@
   @see ComputeSYMGS_ref
 */
 template<class SparseMatrix_type, class Vector_type>
-int ComputeSYMGS(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x) {
+int ComputeSYMGS(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool xIsZero) {
 
-  // This line and the next two lines should be removed and your version of ComputeSYMGS should be used.
+#if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
+  if (xIsZero) ZeroVector(x);
   return ComputeSYMGS_ref(A, r, x);
+#else
+  if (!xIsZero) return ComputeSYMGS_ref(A, r, x);
 
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const local_int_t nrow = A.localNumberOfRows;
+  const scalar_type * const rv = r.values;
+  scalar_type * const xv = x.values;
+  scalar_type ** matrixDiagonal = A.matrixDiagonal;
+
+  // Forward sweep from a zero initial guess, which also zeroes the halo values used by the back sweep
+  int ierr = ComputeGS_Forward(A, r, x, true);
+  if (ierr!=0) return ierr;
+
+  for (local_int_t i=nrow-1; i>=0; i--) {
+    const scalar_type * const currentValues = A.matrixValues[i];
+    const local_int_t * const currentColIndices = A.mtxIndL[i];
+    const int currentNumberOfNonzeros = A.nonzerosInRow[i];
+    const scalar_type currentDiagonal = matrixDiagonal[i][0]; // Current diagonal value
+    scalar_type sum = rv[i]; // RHS value
+
+    for (int j = 0; j< currentNumberOfNonzeros; j++) {
+      local_int_t curCol = currentColIndices[j];
+      sum -= currentValues[j]*xv[curCol];
+    }
+    sum += xv[i]*currentDiagonal; // Remove diagonal contribution from previous loop
+
+    xv[i] = sum/currentDiagonal;
+  }
+
+  return 0;
+#endif
 }
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeSYMGS< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&, bool);
+
+template
+int ComputeSYMGS< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, bool);
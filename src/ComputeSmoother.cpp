@@ -0,0 +1,111 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ComputeSmoother.cpp
+
+ HPGMP routine
+ */
+
+#include "ComputeSmoother.hpp"
+#include "ComputeSYMGS.hpp"
+#include "ComputeGS_Forward.hpp"
+#include "ComputeChebyshev.hpp"
+#include "ComputeL1Jacobi.hpp"
+#include "ComputeHybridGS.hpp"
+#include "ComputeTemporalGS.hpp"
+
+/*!
+  Routine to apply one smoothing step of the multigrid smoother of the level of A, selected at setup
+  (the SmootherData in A.optimizationData, see SetupMatrix and OptimizeProblem): Gauss-Seidel, a
+  Chebyshev polynomial, l1-Jacobi or hybrid Gauss-Seidel.  Levels without smoother data use Gauss-Seidel.
+
+  @param[in] A the known system matrix
+  @param[in] r the input vector
+  @param[inout] x On entry, x should contain relevant values, on exit x contains the result of the smoothing step with r as the RHS.
+  @param[in] symmetric If true, Gauss-Seidel is symmetric (ComputeSYMGS, or forward and backward hybrid sweeps), otherwise forward
+  @param[in] xIsZero If true, x is assumed to be zero on entry (its values are ignored).
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeGS_Forward
+  @see ComputeSYMGS
+  @see ComputeChebyshev
+  @see ComputeL1Jacobi
+  @see ComputeHybridGS
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeSmoother(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, bool symmetric, bool xIsZero) {
+
+  const SmootherData<typename SparseMatrix_type::scalar_type> * smoother = GetSmootherData(A);
+  int type = smoother!=0 ? smoother->type : HPGMP_SMOOTHER_GAUSS_SEIDEL;
+
+  if (type==HPGMP_SMOOTHER_CHEBYSHEV || type==HPGMP_SMOOTHER_JACOBI_CHEBYSHEV)
+    return ComputeChebyshev(A, r, x, xIsZero);
+  if (type==HPGMP_SMOOTHER_L1_JACOBI)
+    return ComputeL1Jacobi(A, r, x, xIsZero);
+  if (type==HPGMP_SMOOTHER_HYBRID_GAUSS_SEIDEL)
+    return ComputeHybridGS(A, r, x, symmetric, xIsZero);
+  if (symmetric)
+    return ComputeSYMGS(A, r, x, xIsZero);
+  return ComputeGS_Forward(A, r, x, xIsZero);
+}
+
+/*!
+  Routine to apply several smoothing steps of the multigrid smoother of the level of A (see ComputeSmoother).
+  Consecutive forward Gauss-Seidel sweeps are temporally blocked on the levels set up for it by
+  OptimizeProblem, on several processes for the rows without external columns (see ComputeTemporalGS); symmetric Gauss-Seidel alternates forward and backward
+  sweeps, which traverse the rows in opposite orders and are applied one step at a time.
+
+  @param[in] A the known system matrix
+  @param[in] r the input vector
+  @param[inout] x On entry, x should contain relevant values, on exit x contains the result of the smoothing steps with r as the RHS.
+  @param[in] numberOfSteps the number of smoothing steps
+  @param[in] symmetric If true, Gauss-Seidel is symmetric, otherwise forward
+  @param[in] xIsZero If true, x is assumed to be zero on entry (its values are ignored).
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSmoother
+  @see ComputeTemporalGS
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeSmootherSteps(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, int numberOfSteps, bool symmetric, bool xIsZero) {
+
+  if (numberOfSteps>1 && !symmetric && GetSmootherData(A)==0 && A.mgData!=0 && A.mgData->temporalTileRows>0)
+    return ComputeTemporalGS(A, r, x, numberOfSteps, xIsZero);
+
+  int ierr = 0;
+  for (int i=0; i<numberOfSteps; ++i) ierr += ComputeSmoother(A, r, x, symmetric, xIsZero && i==0);
+  return ierr;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeSmoother< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&, bool, bool);
+
+template
+int ComputeSmoother< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, bool, bool);
+
+template
+int ComputeSmootherSteps< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&, int, bool, bool);
+
+template
+int ComputeSmootherSteps< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, int, bool, bool);
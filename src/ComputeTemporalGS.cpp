@@ -0,0 +1,171 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ComputeTemporalGS.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_MPI
+#include "ExchangeHalo.hpp"
+#endif
+#include "ComputeTemporalGS.hpp"
+#include "mytimer.hpp"
+#include <algorithm>
+#include <cassert>
+
+/*!
+  Applies one forward Gauss-Seidel sweep to the rows first to last-1, with the same operations as
+  ComputeGS_Forward_ref, or as ComputeGS_Forward from a zero initial guess if lowerOnly is true.
+  The rows with HPGMP_FULL_ROW_LENGTH nonzeros use the fully unrolled row kernel (see RowRunData.hpp).
+ */
+template<class SparseMatrix_type, class scalar_type>
+static inline void ComputeGSRows(const SparseMatrix_type & A, const scalar_type * const rv, scalar_type * const xv,
+                                 local_int_t first, local_int_t last, bool lowerOnly) {
+  scalar_type ** matrixDiagonal = A.matrixDiagonal;
+  for (local_int_t i=first; i<last; i++) {
+    const scalar_type * const currentValues = A.matrixValues[i];
+    const local_int_t * const currentColIndices = A.mtxIndL[i];
+    const int currentNumberOfNonzeros = A.nonzerosInRow[i];
+    const scalar_type currentDiagonal = matrixDiagonal[i][0]; // Current diagonal value
+    scalar_type sum = rv[i]; // RHS value
+
+    if (lowerOnly) {
+      for (int j=0; j< currentNumberOfNonzeros; j++) {
+        local_int_t curCol = currentColIndices[j];
+        if (curCol<i) sum -= currentValues[j] * xv[curCol];
+      }
+    } else if (currentNumberOfNonzeros==HPGMP_FULL_ROW_LENGTH) {
+      sum = Row<HPGMP_FULL_ROW_LENGTH>::Subtract(currentValues, currentColIndices, xv, sum);
+      sum += xv[i]*currentDiagonal; // Remove diagonal contribution from previous loop
+    } else {
+      for (int j=0; j< currentNumberOfNonzeros; j++) {
+        local_int_t curCol = currentColIndices[j];
+        sum -= currentValues[j] * xv[curCol];
+      }
+      sum += xv[i]*currentDiagonal; // Remove diagonal contribution from previous loop
+    }
+    xv[i] = sum/currentDiagonal;
+  }
+}
+
+/*!
+  Applies one forward Gauss-Seidel sweep to the rows first to last-1 that are not boundary rows
+  (see ComputeGSRows), boundary pointing to the first boundary row not before first.
+ */
+template<class SparseMatrix_type, class scalar_type>
+static inline void ComputeInteriorGSRows(const SparseMatrix_type & A, const scalar_type * const rv, scalar_type * const xv,
+                                         local_int_t first, local_int_t last, const local_int_t * boundary,
+                                         const local_int_t * const boundaryEnd, bool lowerOnly) {
+  while (first<last) {
+    local_int_t end = boundary!=boundaryEnd && *boundary<last ? *boundary : last;
+    ComputeGSRows(A, rv, xv, first, end, lowerOnly);
+    first = end + 1;
+    ++boundary;
+  }
+}
+
+/*!
+  Routine to compute several forward Gauss-Seidel sweeps with temporal blocking: the rows are split
+  into tiles, and the sweeps advance together as a wavefront over the tiles, sweep s+1 trailing sweep s
+  by mgData->temporalSkew tiles.  The skew is the farthest tile referenced by a row of a tile, so every
+  row sees exactly the values it would see in consecutive sweeps.  Only the tiles within the wavefront
+  are accessed at a time, so the matrix and vectors are read from memory once for all sweeps instead
+  of once per sweep.  The tiles (mgData->temporalTileRows) are set up by OptimizeProblem; they span the
+  reach of the stencil along the row ordering rather than cache-sized 3D tiles of the grid, and
+  symmetric Gauss-Seidel is not blocked.
+
+  The boundary rows, which read external columns (mgData->temporalBoundaryRows), are left out of the
+  wavefront: after the blocked sweeps of the interior rows, each sweep exchanges the halo and sweeps
+  the boundary rows, as ComputeGS_Forward would with the interior rows ordered first.  Without
+  boundary rows, on a single process, the result is that of numberOfSweeps calls to
+  ComputeGS_Forward_ref.  The halo is exchanged as many times as by those calls, so that the
+  processes that do not block the level exchange along with those that do.
+
+  @param[in] A the known system matrix
+  @param[in] r the input vector
+  @param[inout] x On entry, x should contain relevant values, on exit x contains the result of the sweeps with r as the RHS.
+  @param[in] numberOfSweeps the number of sweeps
+  @param[in] xIsZero If true, x is assumed to be zero on entry (its values are ignored): the upper triangular terms of the first sweep are skipped.
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeGS_Forward
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ComputeTemporalGS(const SparseMatrix_type & A, const Vector_type & r, Vector_type & x, int numberOfSweeps, bool xIsZero) {
+
+  assert(x.localLength==A.localNumberOfColumns); // Make sure x contain space for halo values
+  assert(A.mgData!=0 && A.mgData->temporalTileRows>0);
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const local_int_t nrow = A.localNumberOfRows;
+  const local_int_t tileRows = A.mgData->temporalTileRows;
+  const local_int_t numberOfTiles = (nrow + tileRows - 1)/tileRows;
+  const int skew = A.mgData->temporalSkew;
+  const local_int_t * const boundaryRows = A.mgData->temporalBoundaryRows;
+  const local_int_t * const boundaryEnd = boundaryRows + A.mgData->numberOfTemporalBoundaryRows;
+  const scalar_type * const rv = r.values;
+  scalar_type * const xv = x.values;
+
+  double t0 = 0.0;
+  TICK();
+  // The boundary rows and the halo are zero while the interior rows are swept from a zero initial guess
+  if (xIsZero) {
+    for (const local_int_t * boundary=boundaryRows; boundary!=boundaryEnd; ++boundary) xv[*boundary] = 0.0;
+    for (local_int_t i=nrow; i<A.localNumberOfColumns; ++i) xv[i] = 0.0;
+  }
+  // At each step, sweep s processes tile step - s*skew, after sweep s-1 has processed the tiles it depends on
+  for (local_int_t step=0; step<numberOfTiles + (local_int_t) (numberOfSweeps-1)*skew; ++step) {
+    for (int sweep=0; sweep<numberOfSweeps; ++sweep) {
+      local_int_t tile = step - (local_int_t) sweep*skew;
+      if (tile<0) break;
+      if (tile>=numberOfTiles) continue;
+      local_int_t first = tile*tileRows, last = first + tileRows<nrow ? first + tileRows : nrow;
+      if (boundaryRows==boundaryEnd)
+        ComputeGSRows(A, rv, xv, first, last, xIsZero && sweep==0);
+      else
+        ComputeInteriorGSRows(A, rv, xv, first, last, std::lower_bound(boundaryRows, boundaryEnd, first), boundaryEnd, xIsZero && sweep==0);
+    }
+  }
+  TOCK(x.time2);
+
+  // Boundary rows, one sweep at a time; the first sweep from a zero initial guess keeps the zero halo
+  if (boundaryRows==boundaryEnd) return 0;
+  for (int sweep=0; sweep<numberOfSweeps; ++sweep) {
+#ifndef HPGMP_NO_MPI
+    if (!xIsZero || sweep>0) ExchangeHalo(A, x);
+#endif
+    TICK();
+    for (const local_int_t * boundary=boundaryRows; boundary!=boundaryEnd; ++boundary)
+      ComputeGSRows(A, rv, xv, *boundary, *boundary+1, false);
+    TOCK(x.time2);
+  }
+
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int ComputeTemporalGS< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, Vector<double> const&, Vector<double>&, int, bool);
+
+template
+int ComputeTemporalGS< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, Vector<float> const&, Vector<float>&, int, bool);
@@ -22,14 +22,16 @@
 
 #include "ComputeWAXPBY.hpp"
 #include "ComputeWAXPBY_ref.hpp"
+#include "SimdBackend.hpp"
+#include <cassert>
 
 /*!
   Routine to compute the update of a vector with the sum of two
   scaled vectors where: w = alpha*x + beta*y
 
-  This routine calls the reference WAXPBY implementation by default, but
-  can be replaced by a custom, optimized routine suited for
-  the target system.
+  This routine uses the SIMD backend when it is enabled (see SetupSimdBackend),
+  which rounds like the reference implementation, and the reference WAXPBY
+  implementation otherwise.
 
   @param[in] n the number of vector elements (on this processor)
   @param[in] alpha, beta the scalars applied to x and y respectively.
@@ -50,6 +52,13 @@ int ComputeWAXPBY(const local_int_t n,
                         VectorW_type & w,
                         bool & isOptimized) {
 
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+  assert(x.localLength>=n); // Test vector lengths
+  assert(y.localLength>=n);
+  if (n <= 0) return 0;
+  if (SimdWAXPBY(n, alpha, x.values, beta, y.values, w.values)) return 0;
+#endif
+
   // This line and the next two lines should be removed and your version of ComputeWAXPBY should be used.
   isOptimized = false;
   return ComputeWAXPBY_ref(n, alpha, x, beta, y, w);
@@ -16,10 +16,52 @@
 
 #ifndef EXCHANGEHALO_HPP
 #define EXCHANGEHALO_HPP
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+#include <vector>
 #include "SparseMatrix.hpp"
 #include "Vector.hpp"
 
 template<class SparseMatrix_type, class Vector_type>
 void ExchangeHalo(const SparseMatrix_type & A, Vector_type & x);
 
+template<class SparseMatrix_type, class Vector_type>
+void ExchangePaddedHalo(const SparseMatrix_type & A, Vector_type & x);
+
+/*!
+  Communicates integer ids of the rows at the border of the part of the domain assigned to this processor,
+  following the same pattern as ExchangeHalo.  Used during setup to learn how neighbors number their rows.
+
+  @param[in]    A   The known system matrix, with its halo set up
+  @param[inout] ids On entry: the ids of the local rows (at least localNumberOfRows entries);
+                    on exit: resized to localNumberOfColumns, with the ids of the external columns received from their owners
+ */
+template<class SparseMatrix_type>
+inline void ExchangeHaloIds(const SparseMatrix_type & A, std::vector<long long> & ids) {
+
+  ids.resize(A.localNumberOfColumns);
+#ifndef HPGMP_NO_MPI
+  int MPI_MY_TAG = 98;
+  int num_neighbors = A.numberOfSendNeighbors;
+  std::vector<long long> sendIds(A.totalToBeSent);
+  for (local_int_t i=0; i<A.totalToBeSent; ++i) sendIds[i] = ids[A.elementsToSend[i]];
+
+  MPI_Request * request = new MPI_Request[num_neighbors];
+  long long * externalIds = ids.data() + A.localNumberOfRows;
+  for (int i = 0; i < num_neighbors; i++) {
+    MPI_Irecv(externalIds, A.receiveLength[i], MPI_LONG_LONG, A.neighbors[i], MPI_MY_TAG, A.comm, request+i);
+    externalIds += A.receiveLength[i];
+  }
+  long long * sendBuffer = sendIds.data();
+  for (int i = 0; i < num_neighbors; i++) {
+    MPI_Send(sendBuffer, A.sendLength[i], MPI_LONG_LONG, A.neighbors[i], MPI_MY_TAG, A.comm);
+    sendBuffer += A.sendLength[i];
+  }
+  MPI_Waitall(num_neighbors, request, MPI_STATUSES_IGNORE);
+  delete [] request;
+#endif
+  return;
+}
+
 #endif // EXCHANGEHALO_HPP
@@ -119,6 +119,13 @@ int GMRES(const SparseMatrix_type & A, GMRESData_type & data, const Vector_type
   InitializeMatrix(ss, restart_length+1, 1);
   InitializeMultiVector(Q, nrow, restart_length+1, A.comm);
 
+  // The K-cycle is not a fixed linear operator, so its outputs are kept and x is updated
+  // from them at restart (flexible GMRES) instead of applying the preconditioner to Q*t
+  bool flexible = doPreconditioning && A.mgData!=0 && A.mgData->cycleType==HPGMP_MG_K_CYCLE;
+  MultiVector_type Z = MultiVector_type(); // Only allocated for the flexible variant
+  Vector_type Zk;
+  if (flexible) InitializeMultiVector(Z, A.localNumberOfColumns, restart_length, A.comm);
+
   if (!doPreconditioning && A.geom->rank==0) HPGMP_fout << "WARNING: PERFORMING UNPRECONDITIONED ITERATIONS" << std::endl;
 
   double flops = 0.0;
@@ -164,18 +171,21 @@ int GMRES(const SparseMatrix_type & A, GMRESData_type & data, const Vector_type
       GetVector(Q, k-1, Qkm1);
       GetVector(Q, k,   Qk);
 
+      Vector_type & zk = flexible ? Zk : z;
+      if (flexible) GetVector(Z, k-1, Zk);
+
       TICK();
       if (doPreconditioning) {
-        z.time1 = z.time2 = z.time3 = z.time4 = 0.0;
-        ComputeMG(A, Qkm1, z, symmetric); flops_gmg += (2*numSpMVs_MG*A.totalNumberOfMGNonzeros); // Apply preconditioner
-        t7 += z.time1; t8 += z.time2; t9 += z.time3; t10 += z.time4;
+        zk.time1 = zk.time2 = zk.time3 = zk.time4 = 0.0;
+        ComputeMG(A, Qkm1, zk, symmetric); flops_gmg += A.totalNumberOfMGFlops; // Apply preconditioner
+        t7 += zk.time1; t8 += zk.time2; t9 += zk.time3; t10 += zk.time4;
       } else {
         CopyVector(Qkm1, z);              // copy r to z (no preconditioning)
       }
       TOCK(t5); // Preconditioner apply time
 
       // Qk = A*z
-      TICK(); ComputeSPMV(A, z, Qk); flops_spmv += (2*A.totalNumberOfNonzeros); TOCK(t3);
+      TICK(); ComputeSPMV(A, zk, Qk); flops_spmv += (2*A.totalNumberOfNonzeros); TOCK(t3);
 
 
       // orthogonalize z against Q(:,0:k-1), using dots
@@ -277,12 +287,19 @@ int GMRES(const SparseMatrix_type & A, GMRESData_type & data, const Vector_type
     }
     // > update x
     ComputeTRSM(k-1, one, H, t);
-    if (doPreconditioning) {
+    if (flexible) {
+      TICK();
+      for (global_int_t j=0; j<k-1; j++) {
+        GetVector(Z, j, Zk);
+        ComputeWAXPBY(nrow, one, x, GetMatrixValue(t, j, 0), Zk, x, A.isWaxpbyOptimized); // x += Z*t
+      }
+      TOCK(t11); flops += (itwo*Nrow*(k-ione));
+    } else if (doPreconditioning) {
       ComputeGEMV(nrow, k-1, one, Q, t, zero, r, A.isGemvOptimized); flops += (itwo*Nrow*(k-ione)); // r = Q*t
 
       z.time1 = z.time2 = 0.0;
       TICK();
-      ComputeMG(A, r, z, symmetric); flops_gmg += (2*numSpMVs_MG*A.totalNumberOfMGNonzeros);      // z = M*r
+      ComputeMG(A, r, z, symmetric); flops_gmg += A.totalNumberOfMGFlops;      // z = M*r
       TOCK(t5); // Preconditioner apply time
       t7 += z.time1; t8 += z.time2; t9 += z.time3; t10 += z.time4;
 
@@ -308,6 +325,7 @@ int GMRES(const SparseMatrix_type & A, GMRESData_type & data, const Vector_type
     test_data.times[9]  += t9;  // > Restrict for GS
     test_data.times[10] += t10; // > Prolong for GS
     test_data.times[11] += t11; // Vector update time
+    CollectMGLevelTimes(A, test_data.mgLevelTimes);
 
     test_data.times_comp[1] += t1_comp; // dot-product time
     test_data.times_comm[1] += t1_comm; // dot-product time
@@ -318,7 +336,7 @@ int GMRES(const SparseMatrix_type & A, GMRESData_type & data, const Vector_type
   double flops_tot = flops + flops_gmg + flops_spmv + flops_orth;
   if (verbose && A.geom->rank==0) {
     HPGMP_fout << " > nnz(A)  : " << A.totalNumberOfNonzeros << std::endl;
-    HPGMP_fout << " > nnz(MG) : " << A.totalNumberOfMGNonzeros << " (" << numSpMVs_MG << ")" << std::endl;
+    HPGMP_fout << " > nnz(MG) : " << A.totalNumberOfMGNonzeros << " (" << numSpMVs_MG << ", " << A.totalNumberOfMGFlops << " flops per cycle)" << std::endl;
     HPGMP_fout << " > SpMV : " << (flops_spmv / 1000000000.0) << " / " << t3 << " = "
                               << (flops_spmv / 1000000000.0) / t3 << " Gflop/s" << std::endl;
     HPGMP_fout << " > GMG  : " << (flops_gmg  / 1000000000.0) << " / " << t5 << " = "
@@ -341,6 +359,7 @@ int GMRES(const SparseMatrix_type & A, GMRESData_type & data, const Vector_type
   DeleteDenseMatrix(cs);
   DeleteDenseMatrix(ss);
   DeleteMultiVector(Q);
+  if (flexible) DeleteMultiVector(Z);
 
   return ((converged && !IS_NAN(normr)) ? 0 : 1);
 }
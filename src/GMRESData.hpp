@@ -87,6 +87,7 @@ public:
   // from validation step
   int refNumIters;       //!< number of reference iterations
   int optNumIters;       //!< number of optimized iterations
+  int optNumItersCoarseSweep; //!< number of optimized iterations with one smoother sweep on the coarsest level (-1 if not run)
   int validation_nprocs; //!<
   double refResNorm0;
   double refResNorm;
@@ -97,6 +98,9 @@ public:
   double SetupTime;
   double OptimizeTime;
   double SpmvMgTime;
+  double TeardownTime;   //!< time to delete the two hierarchies of the benchmark phase
+  double SetupRSS;       //!< resident set size in bytes after the setup, maximum over the processes
+  double SetupArenaSize; //!< bytes mapped by the arenas of the two hierarchies, maximum over the processes
 
   // from benchmark step
   int numOfCalls;       //!< number of calls
@@ -124,6 +128,8 @@ public:
   double *ref_times_comm; //!< record from output of reference GMRES
   double *opt_times_comp; //!< record from output of optimized GMRES
   double *opt_times_comm; //!< record from output of optimized GMRES
+  std::vector<double> mgLevelTimes;     //!< time of ComputeMG on each level, accumulated in GMRES
+  std::vector<double> opt_mgLevelTimes; //!< record from output of optimized GMRES
 };
 
 #endif // CGDATA_HPP
@@ -27,6 +27,8 @@
 
 #include "GMRES_IR.hpp"
 #include "mytimer.hpp"
+#include "Profiler.hpp"
+#include "TrafficModel.hpp"
 #include "ComputeSPMV.hpp"
 #include "ComputeMG.hpp"
 #include "ComputeDotProduct.hpp"
@@ -117,6 +119,13 @@ int GMRES_IR(const SparseMatrix_type & A, const SparseMatrix_type2 & A_lo,
   InitializeMatrix(cs, restart_length+1, 1);
   InitializeMatrix(ss, restart_length+1, 1);
   InitializeMultiVector(Q, nrow, restart_length+1, A.comm);
+
+  // The K-cycle is not a fixed linear operator, so its outputs are kept and x is updated
+  // from them at restart (flexible GMRES) instead of applying the preconditioner to Q*t
+  bool flexible = doPreconditioning && A_lo.mgData!=0 && A_lo.mgData->cycleType==HPGMP_MG_K_CYCLE;
+  MultiVector_type2 Z = MultiVector_type2(); // Only allocated for the flexible variant
+  Vector_type2 Zk;
+  if (flexible) InitializeMultiVector(Z, A_lo.localNumberOfColumns, restart_length, A.comm);
   #define SINGLEREDUCE_GMRES_IR
   #ifdef SINGLEREDUCE_GMRES_IR
   MultiVector_type2 V;
@@ -162,6 +171,13 @@ int GMRES_IR(const SparseMatrix_type & A, const SparseMatrix_type2 & A_lo,
   double flops_spmv = 0.0;
   double flops_orth = 0.0;
   global_int_t numSpMVs_MG = 1+(A.mgData->numberOfPresmootherSteps + A.mgData->numberOfPostsmootherSteps);
+
+  // Modeled bytes (see TrafficModel.hpp) and flops of the kernels on the local rows, for the profiler
+  const double nnz = A.localNumberOfNonzeros, rows = nrow;
+  const double bytesSpMV_hi = ModelSpMVBytes(A), bytesSpMV_lo = ModelSpMVBytes(A_lo);
+  const double bytesVector_hi = rows*sizeof(scalar_type), bytesVector_lo = rows*sizeof(scalar_type2);
+
+  ProfileScope solverRegion("GMRES-IR");
   niters = 0;
   bool converged = false;
   double t_begin = mytimer();  // Start timing right away
@@ -169,9 +185,15 @@ int GMRES_IR(const SparseMatrix_type & A, const SparseMatrix_type2 & A_lo,
     // > Compute residual vector (higher working precision)
     // p is of length ncols, copy x to p for sparse MV operation
     CopyVector(x_hi, p_hi);
-    TICK(); ComputeSPMV(A, p_hi, Ap_hi); flops_spmv += (2*A.totalNumberOfNonzeros); TOCK(t3); t3_1 += p_hi.time1; t3_2 += p_hi.time2; // Ap = A*p
-    TICK(); ComputeWAXPBY(nrow, one_hi, b_hi, -one_hi, Ap_hi, r_hi, A.isWaxpbyOptimized); flops += (itwo*Nrow);  TOCK(t11); // r = b - Ax (x stored in p)
-    TICK(); ComputeDotProduct(nrow, r_hi, r_hi, normr_hi, t4, A.isDotProductOptimized); flops += (itwo*Nrow); TOCK(t11);
+    {
+      ProfileScope region("SpMV", -1, bytesSpMV_hi, 2.0*nnz);
+      TICK(); ComputeSPMV(A, p_hi, Ap_hi); flops_spmv += (2*A.totalNumberOfNonzeros); TOCK(t3); t3_1 += p_hi.time1; t3_2 += p_hi.time2; // Ap = A*p
+    }
+    {
+      ProfileScope region("Residual", -1, 4.0*bytesVector_hi, 4.0*rows);
+      TICK(); ComputeWAXPBY(nrow, one_hi, b_hi, -one_hi, Ap_hi, r_hi, A.isWaxpbyOptimized); flops += (itwo*Nrow);  TOCK(t11); // r = b - Ax (x stored in p)
+      TICK(); ComputeDotProduct(nrow, r_hi, r_hi, normr_hi, t4, A.isDotProductOptimized); flops += (itwo*Nrow); TOCK(t11);
+    }
     normr_hi = sqrt(normr_hi);
     test_data.numOfSPCalls++;
     // Record initial residual for convergence testing
@@ -208,7 +230,10 @@ int GMRES_IR(const SparseMatrix_type & A, const SparseMatrix_type2 & A_lo,
     }
 
     // > Scale to the residual vector in working precision
-    TICK(); ScaleVectorValue<Vector_type, scalar_type> (r_hi, one_hi/normr_hi); flops += Nrow; TOCK(t11);
+    {
+      ProfileScope region("Scale", -1, 2.0*bytesVector_hi, rows);
+      TICK(); ScaleVectorValue<Vector_type, scalar_type> (r_hi, one_hi/normr_hi); flops += Nrow; TOCK(t11);
+    }
 
     // > Copy r as the initial basis vector (lower precision)
     GetVector(Q, 0, Qj);
@@ -224,79 +249,107 @@ int GMRES_IR(const SparseMatrix_type & A, const SparseMatrix_type2 & A_lo,
       GetVector(Q, k-1, Qkm1);
       GetVector(Q, k,   Qk);
 
+      Vector_type2 & zk = flexible ? Zk : z;
+      if (flexible) GetVector(Z, k-1, Zk);
+
       TICK();
       if (doPreconditioning) {
-        z.time1 = z.time2 = z.time3 = z.time4 = 0.0;
-        ComputeMG(A_lo, Qkm1, z, symmetric); flops_gmg += (2*numSpMVs_MG*A.totalNumberOfMGNonzeros); // Apply preconditioner
+        ProfileScope region("MG");
+        zk.time1 = zk.time2 = zk.time3 = zk.time4 = 0.0;
+        ComputeMG(A_lo, Qkm1, zk, symmetric); flops_gmg += A.totalNumberOfMGFlops; // Apply preconditioner
         test_data.numOfMGCalls++;
-        t7 += z.time1; t8 += z.time2; t9 += z.time3; t10 += z.time4;
+        t7 += zk.time1; t8 += zk.time2; t9 += zk.time3; t10 += zk.time4;
       } else {
         CopyVector(Qkm1, z);       // copy r to z (no preconditioning)
       }
       TOCK(t5); // Preconditioner apply time
 
       // Qk = A*z
-      TICK(); ComputeSPMV(A_lo, z, Qk); flops_spmv += (2*A.totalNumberOfNonzeros); TOCK(t3); t3_1 += z.time1; t3_2 += z.time2;
+      {
+        ProfileScope region("SpMV", -1, bytesSpMV_lo, 2.0*nnz);
+        TICK(); ComputeSPMV(A_lo, zk, Qk); flops_spmv += (2*A.totalNumberOfNonzeros); TOCK(t3); t3_1 += zk.time1; t3_2 += zk.time2;
+      }
       test_data.numOfSPCalls++;
 
       // orthogonalize z against Q(:,0:k-1), using dots
       bool use_mgs = false;
-      TICK();
-      if (use_mgs) {
-        // MGS2
-        for (int j = 0; j < k; j++) {
-          // get j-th column of Q
-          GetVector(Q, j, Qj);
-
-          alpha = zero_pr;
-          for (int i = 0; i < 2; i++) {
-            // beta = Qk'*Qj
-            START_T(); ComputeDotProduct<Vector_type2, project_type>
-                         (nrow, Qk, Qj, beta, t4, A.isDotProductOptimized); STOP_T(t1);
-
-            // Qk = Qk - beta * Qj
-            START_T(); ComputeWAXPBY(nrow, one, Qk, -beta, Qj, Qk, A.isWaxpbyOptimized); STOP_T(t2);
-            alpha += beta;
+      {
+        ProfileScope orthogonalizationRegion("Orthogonalization");
+        TICK();
+        if (use_mgs) {
+          // MGS2
+          for (int j = 0; j < k; j++) {
+            // get j-th column of Q
+            GetVector(Q, j, Qj);
+
+            alpha = zero_pr;
+            for (int i = 0; i < 2; i++) {
+              // beta = Qk'*Qj
+              START_T(); ComputeDotProduct<Vector_type2, project_type>
+                           (nrow, Qk, Qj, beta, t4, A.isDotProductOptimized); STOP_T(t1);
+
+              // Qk = Qk - beta * Qj
+              START_T(); ComputeWAXPBY(nrow, one, Qk, -beta, Qj, Qk, A.isWaxpbyOptimized); STOP_T(t2);
+              alpha += beta;
+            }
+            SetMatrixValue(H, j, k-1, alpha);
+          }
+          flops_orth += (ifour*k*Nrow);
+        } else {
+          // CGS2
+          // first orthogonalization
+          GetMultiVector(Q, 0, k-1, P);
+          {
+            ProfileScope region("GEMVT", -1, (k+1)*bytesVector_lo, 2.0*k*rows);
+            START_T(); ComputeGEMVT (nrow, k,  one, P, Qk, zero_pr, h, A.isGemvOptimized); STOP_T(t1); // h = Q(1:k)'*q(k+1), mul and add in proj_type
+          }
+          {
+            ProfileScope region("GEMV", -1, (k+2)*bytesVector_lo, 2.0*k*rows);
+            START_T(); ComputeGEMV  (nrow, k, -one, P, h,  one,    Qk, A.isGemvOptimized); STOP_T(t2); // q(k+1) = q(k+1) - Q(1:k)*h
+          }
+          t1_comp += h.time1; t1_comm += h.time2;
+          for(int i = 0; i < k; i++) {
+            SetMatrixValue(H, i, k-1, h.values[i]);
+          }
+          flops_orth += (ifour*k*Nrow);
+
+          {
+            ProfileScope region("GEMVT", -1, (k+1)*bytesVector_lo, 2.0*k*rows);
+            START_T();
+            // reorthogonalization
+            // h = Q(1:k)'*q(k+1)
+            ComputeGEMVT (nrow, k,  one, P, Qk, zero_pr, h, A.isGemvOptimized);
+            STOP_T(t1);
           }
-          SetMatrixValue(H, j, k-1, alpha);
-        }
-        flops_orth += (ifour*k*Nrow);
-      } else {
-        // CGS2
-        // first orthogonalization
-        GetMultiVector(Q, 0, k-1, P);
-        START_T(); ComputeGEMVT (nrow, k,  one, P, Qk, zero_pr, h, A.isGemvOptimized); STOP_T(t1); // h = Q(1:k)'*q(k+1), mul and add in proj_type
-        START_T(); ComputeGEMV  (nrow, k, -one, P, h,  one,    Qk, A.isGemvOptimized); STOP_T(t2); // q(k+1) = q(k+1) - Q(1:k)*h
-        t1_comp += h.time1; t1_comm += h.time2;
-        for(int i = 0; i < k; i++) {
-          SetMatrixValue(H, i, k-1, h.values[i]);
-        }
-        flops_orth += (ifour*k*Nrow);
-
-        START_T();
-        // reorthogonalization
-        // h = Q(1:k)'*q(k+1)
-        ComputeGEMVT (nrow, k,  one, P, Qk, zero_pr, h, A.isGemvOptimized);
-        STOP_T(t1);
-
-        START_T(); ComputeGEMV (nrow, k, -one, P, h,  one, Qk, A.isGemvOptimized); STOP_T(t2); // q(k+1) = q(k+1) - Q(1:k)*h
-        t1_comp += h.time1; t1_comm += h.time2;
-        for(int i = 0; i < k; i++) {
-          AddMatrixValue(H, i, k-1, h.values[i]);
-        }
-        flops_orth += (ifour*k*Nrow);
-      } // end or CGS2
 
-      // beta = norm(Qk)
-      START_T(); ComputeDotProduct<Vector_type2, project_type>(nrow, Qk, Qk, beta, t4, A.isDotProductOptimized); STOP_T(t1_);
-      flops_orth += (itwo*Nrow);
-      beta = sqrt(beta);
+          {
+            ProfileScope region("GEMV", -1, (k+2)*bytesVector_lo, 2.0*k*rows);
+            START_T(); ComputeGEMV (nrow, k, -one, P, h,  one, Qk, A.isGemvOptimized); STOP_T(t2); // q(k+1) = q(k+1) - Q(1:k)*h
+          }
+          t1_comp += h.time1; t1_comm += h.time2;
+          for(int i = 0; i < k; i++) {
+            AddMatrixValue(H, i, k-1, h.values[i]);
+          }
+          flops_orth += (ifour*k*Nrow);
+        } // end or CGS2
 
-      // Qk = Qk / beta
-      START_T(); ScaleVectorValue(Qk, one_pr/beta); STOP_T(t2);
-      flops_orth += (Nrow);
+        // beta = norm(Qk)
+        {
+          ProfileScope region("DotProduct", -1, bytesVector_lo, 2.0*rows);
+          START_T(); ComputeDotProduct<Vector_type2, project_type>(nrow, Qk, Qk, beta, t4, A.isDotProductOptimized); STOP_T(t1_);
+        }
+        flops_orth += (itwo*Nrow);
+        beta = sqrt(beta);
 
-      TOCK(t6); // Ortho time
+        // Qk = Qk / beta
+        {
+          ProfileScope region("Scale", -1, 2.0*bytesVector_lo, rows);
+          START_T(); ScaleVectorValue(Qk, one_pr/beta); STOP_T(t2);
+        }
+        flops_orth += (Nrow);
+
+        TOCK(t6); // Ortho time
+      }
       SetMatrixValue(H, k, k-1, beta);
       #if 0
       for (int i = 0; i <= k; ++i) HPGMP_fout << " + h[" << i << "] = " << GetMatrixValue(H, i, k-1) << std::endl;
@@ -396,15 +449,27 @@ int GMRES_IR(const SparseMatrix_type & A, const SparseMatrix_type2 & A_lo,
     if (verbose && A.geom->rank==0)
       HPGMP_fout << "GMRES_IR restart: k = "<< k << " (" << niters << ")" << std::endl;
     // > update x
+    ProfileScope updateRegion("Solution Update");
     ComputeTRSM(k-1, one_pr, H, t);
-    if (doPreconditioning) {
+    if (flexible) {
+      // mixed-precision
+      TICK();
+      for (global_int_t j=0; j<k-1; j++) {
+        GetVector(Z, j, Zk);
+        ComputeWAXPBY(nrow, one_hi, x_hi, (scalar_type2) GetMatrixValue(t, j, 0), Zk, x_hi, A.isWaxpbyOptimized); // x += Z*t
+      }
+      TOCK(t11); flops += (itwo*Nrow*(k-ione));
+    } else if (doPreconditioning) {
       #ifdef HPGMRES_IR_UPDATE_X_IN_HIGH
       ComputeGEMV (nrow, k-1, one, Q, t, zero_hi, r_hi, A.isGemvOptimized); flops += (itwo*Nrow*(k-ione)); // r = Q*t
 
       z.time1 = z.time2 = z.time3 = z.time4 = 0.0;
-      TICK();
-      ComputeMG(A, r_hi, z_hi, symmetric); flops_gmg += (2*numSpMVs_MG*A.totalNumberOfMGNonzeros);    // z = M*r
-      TOCK(t5); // Preconditioner apply time
+      {
+        ProfileScope region("MG");
+        TICK();
+        ComputeMG(A, r_hi, z_hi, symmetric); flops_gmg += A.totalNumberOfMGFlops;    // z = M*r
+        TOCK(t5); // Preconditioner apply time
+      }
       test_data.numOfMGCalls++;
       t7 += z.time1; t8 += z.time2; t9 += z.time3; t10 += z.time4;
 
@@ -414,9 +479,12 @@ int GMRES_IR(const SparseMatrix_type & A, const SparseMatrix_type2 & A_lo,
       ComputeGEMV (nrow, k-1, one, Q, t, zero, r, A.isGemvOptimized); flops += (itwo*Nrow*(k-ione)); // r = Q*t
 
       z.time1 = z.time2 = z.time3 = z.time4 = 0.0;
-      TICK();
-      ComputeMG(A_lo, r, z, symmetric); flops_gmg += (2*numSpMVs_MG*A.totalNumberOfMGNonzeros);    // z = M*r
-      TOCK(t5); // Preconditioner apply time
+      {
+        ProfileScope region("MG");
+        TICK();
+        ComputeMG(A_lo, r, z, symmetric); flops_gmg += A.totalNumberOfMGFlops;    // z = M*r
+        TOCK(t5); // Preconditioner apply time
+      }
       test_data.numOfMGCalls++;
       t7 += z.time1; t8 += z.time2; t9 += z.time3; t10 += z.time4;
 
@@ -445,6 +513,8 @@ int GMRES_IR(const SparseMatrix_type & A, const SparseMatrix_type2 & A_lo,
     test_data.times[9]  += t9;       // > Restrict for GS
     test_data.times[10] += t10;      // > Prolong for GS
     test_data.times[11] += t11;      // Vector update time
+    CollectMGLevelTimes(A, test_data.mgLevelTimes);
+    CollectMGLevelTimes(A_lo, test_data.mgLevelTimes);
 
     test_data.times_comp[1] += t1_comp; // dot-product time
     test_data.times_comm[1] += t1_comm; // dot-product time
@@ -454,7 +524,7 @@ int GMRES_IR(const SparseMatrix_type & A, const SparseMatrix_type2 & A_lo,
   double flops_tot = flops + flops_gmg + flops_spmv + flops_orth;
   if (verbose && A.geom->rank==0) {
     HPGMP_fout << " > nnz(A)  : " << A.totalNumberOfNonzeros << std::endl;
-    HPGMP_fout << " > nnz(MG) : " << A.totalNumberOfMGNonzeros << " (" << numSpMVs_MG << ")" << std::endl;
+    HPGMP_fout << " > nnz(MG) : " << A.totalNumberOfMGNonzeros << " (" << numSpMVs_MG << ", " << A.totalNumberOfMGFlops << " flops per cycle)" << std::endl;
     HPGMP_fout << " > SpMV : " << (flops_spmv / 1000000000.0) << " / " << t3 << " = "
                                << (flops_spmv / 1000000000.0) / t3 << " Gflop/s" << std::endl;
     HPGMP_fout << " > GMG  : " << (flops_gmg  / 1000000000.0) << " / " << t5 << " = "
@@ -477,6 +547,7 @@ int GMRES_IR(const SparseMatrix_type & A, const SparseMatrix_type2 & A_lo,
   DeleteDenseMatrix(cs);
   DeleteDenseMatrix(ss);
   DeleteMultiVector(Q);
+  if (flexible) DeleteMultiVector(Z);
 
   return ((converged && !IS_NAN(normr)) ? 0 : 1);
 }
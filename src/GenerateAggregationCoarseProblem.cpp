@@ -0,0 +1,207 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file GenerateAggregationCoarseProblem.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <cmath>
+#include <vector>
+#include "GenerateAggregationCoarseProblem.hpp"
+#include "ExchangeHalo.hpp"
+#include "ReadProblem.hpp"
+#include "SetupHalo.hpp"
+
+/*!
+  Routine to construct a coarse problem by aggregation for a fine grid matrix without grid structure,
+  such as one read by ReadProblem.
+
+  The local rows are grouped into aggregates with a greedy three-phase algorithm on the graph of the
+  local part of Af: (1) every row whose local neighbors are all unaggregated becomes the root of an
+  aggregate made of itself and those neighbors, (2) the remaining rows join the aggregate of the
+  neighbor they are most strongly coupled to, and (3) rows still left form aggregates with their
+  unaggregated neighbors.  Aggregates do not cross process boundaries, so the piecewise constant
+  prolongation P is local and the Galerkin operator Ac = P^T Af P is computed row by row from the
+  aggregate numbers of the columns of Af, the external ones being received from their owners.
+
+  Restriction and prolongation then use the aggregate map in mgData instead of f2cOperator.
+
+  @param[inout]  Af - The known system matrix, on output its coarse operator and MG data will be defined.
+
+  @return Returns zero on success and a non-zero value otherwise, on all processes (for example when a
+          coarse row has more than 127 nonzeros).
+
+  Note that the matrix Af is considered const because the attributes we are modifying are declared as mutable.
+*/
+template<class SparseMatrix_type>
+int GenerateAggregationCoarseProblem(const SparseMatrix_type & Af) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  typedef Vector<scalar_type> Vector_type;
+  typedef MGData<scalar_type> MGData_type;
+
+  const local_int_t nrow = Af.localNumberOfRows;
+  local_int_t * aggregates = new local_int_t[nrow];
+  for (local_int_t i=0; i<nrow; ++i) aggregates[i] = -1;
+
+  // Phase 1: roots with a fully unaggregated local neighborhood
+  local_int_t numberOfAggregates = 0;
+  for (local_int_t i=0; i<nrow; ++i) {
+    if (aggregates[i]>=0) continue;
+    bool free = true;
+    for (int j=0; j<Af.nonzerosInRow[i] && free; ++j) {
+      local_int_t col = Af.mtxIndL[i][j];
+      if (col<nrow && aggregates[col]>=0) free = false;
+    }
+    if (!free) continue;
+    for (int j=0; j<Af.nonzerosInRow[i]; ++j) {
+      local_int_t col = Af.mtxIndL[i][j];
+      if (col<nrow) aggregates[col] = numberOfAggregates;
+    }
+    aggregates[i] = numberOfAggregates++;
+  }
+
+  // Phase 2: attach the remaining rows to the most strongly coupled phase 1 aggregate
+  std::vector<local_int_t> phase1(aggregates, aggregates+nrow);
+  for (local_int_t i=0; i<nrow; ++i) {
+    if (phase1[i]>=0) continue;
+    double strongest = 0.0;
+    for (int j=0; j<Af.nonzerosInRow[i]; ++j) {
+      local_int_t col = Af.mtxIndL[i][j];
+      if (col<nrow && col!=i && phase1[col]>=0 && std::fabs((double) Af.matrixValues[i][j])>strongest) {
+        strongest = std::fabs((double) Af.matrixValues[i][j]);
+        aggregates[i] = phase1[col];
+      }
+    }
+  }
+
+  // Phase 3: rows without an aggregated neighbor aggregate with their free neighbors
+  for (local_int_t i=0; i<nrow; ++i) {
+    if (aggregates[i]>=0) continue;
+    for (int j=0; j<Af.nonzerosInRow[i]; ++j) {
+      local_int_t col = Af.mtxIndL[i][j];
+      if (col<nrow && aggregates[col]<0) aggregates[col] = numberOfAggregates;
+    }
+    aggregates[i] = numberOfAggregates++;
+  }
+
+  // Fine rows of each aggregate, grouped by aggregate (the sparsity of P^T)
+  local_int_t * aggregateStart = new local_int_t[numberOfAggregates+1];
+  local_int_t * aggregateRows = new local_int_t[nrow];
+  for (local_int_t a=0; a<=numberOfAggregates; ++a) aggregateStart[a] = 0;
+  for (local_int_t i=0; i<nrow; ++i) ++aggregateStart[aggregates[i]+1];
+  for (local_int_t a=0; a<numberOfAggregates; ++a) aggregateStart[a+1] += aggregateStart[a];
+  std::vector<local_int_t> fill(aggregateStart, aggregateStart+numberOfAggregates);
+  for (local_int_t i=0; i<nrow; ++i) aggregateRows[fill[aggregates[i]]++] = i;
+
+  // Global numbering of the aggregates, contiguous per process
+  long long localAggregates = numberOfAggregates, firstAggregate = 0, totalAggregates = localAggregates;
+#ifndef HPGMP_NO_MPI
+  MPI_Exscan(&localAggregates, &firstAggregate, 1, MPI_LONG_LONG, MPI_SUM, Af.comm);
+  MPI_Allreduce(&localAggregates, &totalAggregates, 1, MPI_LONG_LONG, MPI_SUM, Af.comm);
+  int rank;
+  MPI_Comm_rank(Af.comm, &rank);
+  if (rank==0) firstAggregate = 0; // MPI_Exscan leaves the result undefined on process 0
+#endif
+  std::vector<long long> columnAggregates(nrow);
+  for (local_int_t i=0; i<nrow; ++i) columnAggregates[i] = firstAggregate + aggregates[i];
+  ExchangeHaloIds(Af, columnAggregates);
+
+  // Galerkin product: coarse row a sums the fine rows of aggregate a, with columns merged by aggregate
+  std::vector<std::vector<long long> > coarseColumns(numberOfAggregates);
+  std::vector<std::vector<double> > coarseValues(numberOfAggregates);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for schedule(dynamic, 64)
+#endif
+  for (local_int_t a=0; a<numberOfAggregates; ++a) {
+    std::vector<long long> & cols = coarseColumns[a];
+    std::vector<double> & vals = coarseValues[a];
+    for (local_int_t k=aggregateStart[a]; k<aggregateStart[a+1]; ++k) {
+      local_int_t i = aggregateRows[k];
+      for (int j=0; j<Af.nonzerosInRow[i]; ++j) {
+        long long col = columnAggregates[Af.mtxIndL[i][j]];
+        size_t c = 0;
+        while (c<cols.size() && cols[c]!=col) ++c;
+        if (c==cols.size()) {
+          cols.push_back(col);
+          vals.push_back(0.0);
+        }
+        vals[c] += Af.matrixValues[i][j];
+      }
+    }
+  }
+
+  std::vector<long long> rowPointers(numberOfAggregates+1, 0), columns;
+  std::vector<scalar_type> values;
+  for (local_int_t a=0; a<numberOfAggregates; ++a) rowPointers[a+1] = rowPointers[a] + coarseColumns[a].size();
+  columns.reserve(rowPointers[numberOfAggregates]);
+  values.reserve(rowPointers[numberOfAggregates]);
+  for (local_int_t a=0; a<numberOfAggregates; ++a) {
+    columns.insert(columns.end(), coarseColumns[a].begin(), coarseColumns[a].end());
+    values.insert(values.end(), coarseValues[a].begin(), coarseValues[a].end());
+  }
+
+  Geometry * geomc = new Geometry;
+  SparseMatrix_type * Ac = new SparseMatrix_type;
+  InitializeSparseMatrix(*Ac, geomc, Af.comm);
+  int ierr = BuildRowBlockMatrix(*Ac, totalAggregates, firstAggregate, numberOfAggregates, rowPointers, columns, values);
+  if (ierr) {
+    delete [] aggregates;
+    delete [] aggregateStart;
+    delete [] aggregateRows;
+    delete Ac;
+    delete geomc;
+    return ierr;
+  }
+  SetupHalo(*Ac);
+
+  Vector_type *rc = new Vector_type;
+  Vector_type *xc = new Vector_type;
+  Vector_type * Axf = new Vector_type;
+  InitializeVector(*rc, Ac->localNumberOfRows, Ac->comm);
+  InitializeVector(*xc, Ac->localNumberOfColumns, Ac->comm);
+  InitializeVector(*Axf, Af.localNumberOfColumns, Ac->comm);
+  Af.Ac = Ac;
+  MGData_type * mgData = new MGData_type;
+  InitializeMGData((local_int_t *) 0, rc, xc, Axf, *mgData);
+  mgData->aggregates = aggregates;
+  mgData->aggregateStart = aggregateStart;
+  mgData->aggregateRows = aggregateRows;
+  Af.mgData = mgData;
+
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int GenerateAggregationCoarseProblem< SparseMatrix<double> >(SparseMatrix<double> const&);
+
+template
+int GenerateAggregationCoarseProblem< SparseMatrix<float> >(SparseMatrix<float> const&);
@@ -108,9 +108,9 @@ void GenerateNonsymCoarseProblem(const SparseMatrix_type & Af) {
   Vector_type *rc = new Vector_type;
   Vector_type *xc = new Vector_type;
   Vector_type * Axf = new Vector_type;
-  InitializeVector(*rc, Ac->localNumberOfRows, Ac->comm);
-  InitializeVector(*xc, Ac->localNumberOfColumns, Ac->comm);
-  InitializeVector(*Axf, Af.localNumberOfColumns, Ac->comm);
+  InitializeVector(*rc, Ac->localNumberOfRows, Ac->comm, Ac->arena);
+  InitializeVector(*xc, Ac->localNumberOfColumns, Ac->comm, Ac->arena);
+  InitializeVector(*Axf, Af.localNumberOfColumns, Ac->comm, Af.arena);
   Af.Ac = Ac;
   MGData_type * mgData = new MGData_type;
   InitializeMGData(f2cOperator, rc, xc, Axf, *mgData);
@@ -49,6 +49,22 @@ using std::endl;
   @see GenerateGeometry
 */
 
+/*!
+  Returns the size in bytes of the arena of a generated level: its rows, its halo lists, bounded by
+  the ghost layer of the local grid, and the multigrid vectors of the level, also of that size.
+ */
+template<class matrix_scalar_type>
+static size_t EstimateMemoryArenaSize(const Geometry & geom, local_int_t numberOfNonzerosPerRow) {
+  const size_t nx = geom.nx, ny = geom.ny, nz = geom.nz;
+  const size_t numberOfRows = nx*ny*nz;
+  const size_t numberOfGhosts = 2*(nx*ny + ny*nz + nx*nz) + 4*(nx + ny + nz) + 8;
+  const size_t numberOfMgVectors = 8;
+  return numberOfRows*numberOfNonzerosPerRow*(sizeof(local_int_t) + sizeof(matrix_scalar_type) + sizeof(global_int_t))
+       + numberOfGhosts*(sizeof(local_int_t) + sizeof(double))
+       + numberOfMgVectors*(numberOfRows + numberOfGhosts)*sizeof(double)
+       + 64*HPGMP_ARRAY_ALIGNMENT;
+}
+
 
 template<class SparseMatrix_type, class Vector_type>
 void GenerateNonsymProblem_v1_ref(SparseMatrix_type & A, Vector_type * b, Vector_type * x, Vector_type * xexact, bool init_vect) {
@@ -110,27 +126,25 @@ void GenerateNonsymProblem_v1_ref(SparseMatrix_type & A, Vector_type * b, Vector
     mtxIndL[i] = 0;
   }
 
-#ifndef HPGMP_CONTIGUOUS_ARRAYS
-  // Now allocate the arrays pointed to
-  for (local_int_t i=0; i< localNumberOfRows; ++i)
-    mtxIndL[i] = new local_int_t[numberOfNonzerosPerRow];
-  for (local_int_t i=0; i< localNumberOfRows; ++i)
-    matrixValues[i] = new matrix_scalar_type[numberOfNonzerosPerRow];
-  for (local_int_t i=0; i< localNumberOfRows; ++i)
-   mtxIndG[i] = new global_int_t[numberOfNonzerosPerRow];
-
-#else
-  // Now allocate the arrays pointed to
-  mtxIndL[0] = new local_int_t[localNumberOfRows * numberOfNonzerosPerRow];
-  matrixValues[0] = new matrix_scalar_type[localNumberOfRows * numberOfNonzerosPerRow];
-  mtxIndG[0] = new global_int_t[localNumberOfRows * numberOfNonzerosPerRow];
+  // Now allocate the arrays pointed to from the arena of the level, which also holds its halo lists
+  // and multigrid vectors: the rows are contiguous, first touched with the static schedule of the kernels
+  if (A.arena==0) {
+    A.arena = new MemoryArena;
+    InitializeMemoryArena(*A.arena, EstimateMemoryArenaSize<matrix_scalar_type>(*A.geom, numberOfNonzerosPerRow));
+  }
+  const size_t numberOfEntries = ((size_t) localNumberOfRows) * numberOfNonzerosPerRow;
+  mtxIndL[0] = ArenaAllocate<local_int_t>(*A.arena, numberOfEntries);
+  matrixValues[0] = ArenaAllocate<matrix_scalar_type>(*A.arena, numberOfEntries);
+  mtxIndG[0] = ArenaAllocate<global_int_t>(*A.arena, numberOfEntries);
+  FirstTouchArray(mtxIndL[0], numberOfEntries);
+  FirstTouchArray(matrixValues[0], numberOfEntries);
+  FirstTouchArray(mtxIndG[0], numberOfEntries);
 
   for (local_int_t i=1; i< localNumberOfRows; ++i) {
-  mtxIndL[i] = mtxIndL[0] + i * numberOfNonzerosPerRow;
-  matrixValues[i] = matrixValues[0] + i * numberOfNonzerosPerRow;
-  mtxIndG[i] = mtxIndG[0] + i * numberOfNonzerosPerRow;
+    mtxIndL[i] = mtxIndL[0] + i * numberOfNonzerosPerRow;
+    matrixValues[i] = matrixValues[0] + i * numberOfNonzerosPerRow;
+    mtxIndG[i] = mtxIndG[0] + i * numberOfNonzerosPerRow;
   }
-#endif
 
   local_int_t localNumberOfNonzeros = 0;
 //printf( "A=[\n" );
@@ -27,6 +27,13 @@
 #include "DataTypes.hpp"
 #include "SparseMatrix.hpp"
 #include "Vector.hpp"
+#include "RestrictionHaloData.hpp"
+
+const int HPGMP_MG_V_CYCLE = 0; //!< One coarse grid correction per level
+const int HPGMP_MG_W_CYCLE = 1; //!< Two coarse grid corrections per level
+const int HPGMP_MG_F_CYCLE = 2; //!< An F-cycle followed by a V-cycle on the coarse grid
+const int HPGMP_MG_K_CYCLE = 3; //!< Two flexible Krylov (GCR) iterations on the coarse grid, preconditioned by a K-cycle
+const int HPGMP_MG_ADDITIVE_CYCLE = 4; //!< Additive cycle: all levels smooth their restriction of the fine residual independently
 
 template<class SC>
 class MGData {
@@ -35,9 +42,28 @@ public:
   int numberOfPresmootherSteps; // Call ComputeSYMGS this many times prior to coarsening
   int numberOfPostsmootherSteps; // Call ComputeSYMGS this many times after coarsening
   local_int_t * f2cOperator; //!< 1D array containing the fine operator local IDs that will be injected into coarse space.
+  local_int_t * aggregates; //!< If not 0, transfers are by aggregation (f2cOperator is 0): coarse local ID of each fine row
+  local_int_t * aggregateStart; //!< Offsets of the fine rows of each aggregate in aggregateRows (number of coarse rows + 1 entries)
+  local_int_t * aggregateRows; //!< Fine local IDs grouped by aggregate
   Vector_type * rc; // coarse grid residual vector
   Vector_type * xc; // coarse grid solution vector
   Vector_type * Axf; // fine grid residual vector
+  int cycleType; //!< HPGMP_MG_V_CYCLE, HPGMP_MG_W_CYCLE, HPGMP_MG_F_CYCLE, HPGMP_MG_K_CYCLE or HPGMP_MG_ADDITIVE_CYCLE, used by ComputeMG
+  Vector_type * rc2; //!< second coarse residual (all cycles but V, 0 otherwise)
+  Vector_type * xc2; //!< second coarse correction (all cycles but V, 0 otherwise)
+  Vector_type * Axc; //!< coarse matrix times xc (all cycles but V, 0 otherwise)
+  Vector_type * Axc2; //!< coarse matrix times xc2 (K-cycle, 0 otherwise)
+  int numberOfAdditiveLevels; //!< number of levels of the additive cycle, including this one (finest level of the additive cycle, 0 otherwise)
+  local_int_t ** additiveRows; //!< for each coarser level, the local ID on this level of each of its rows (finest level of the additive cycle, 0 otherwise)
+  bool isAdditiveConcurrent; //!< if true, the levels of the additive cycle are smoothed concurrently
+  RestrictionHaloData<SC> * restrictionHalo; //!< if not 0, halo of the f2cOperator rows, set up by OptimizeProblem
+  bool isProlongationFused; //!< if true, ComputeMG applies the prolongation within the first post-smoothing sweep (set up by OptimizeProblem)
+  local_int_t firstHaloRow; //!< first fine row with an external column
+  local_int_t * sendCorrection; //!< for each entry of the fine elementsToSend, coarse local ID of its correction or -1
+  local_int_t temporalTileRows; //!< if not 0, rows per tile of the temporally blocked Gauss-Seidel sweeps (set up by OptimizeProblem)
+  int temporalSkew; //!< tiles by which each temporally blocked sweep trails the previous one
+  local_int_t numberOfTemporalBoundaryRows; //!< number of rows with external columns, swept one step at a time after the blocked sweeps
+  local_int_t * temporalBoundaryRows; //!< local IDs of the rows with external columns in increasing order (0 if there are none)
   /*!
    This is for storing optimized data structres created in OptimizeProblem and
    used inside optimized ComputeSPMV().
@@ -82,9 +108,28 @@ inline void InitializeMGData(local_int_t * f2cOperator,
   data.numberOfPresmootherSteps = 1;
   data.numberOfPostsmootherSteps = 1;
   data.f2cOperator = f2cOperator; // Space for injection operator
+  data.aggregates = 0;
+  data.aggregateStart = 0;
+  data.aggregateRows = 0;
   data.rc = rc;
   data.xc = xc;
   data.Axf = Axf;
+  data.cycleType = HPGMP_MG_V_CYCLE;
+  data.rc2 = 0;
+  data.xc2 = 0;
+  data.Axc = 0;
+  data.Axc2 = 0;
+  data.numberOfAdditiveLevels = 0;
+  data.additiveRows = 0;
+  data.isAdditiveConcurrent = false;
+  data.restrictionHalo = 0;
+  data.isProlongationFused = false;
+  data.firstHaloRow = 0;
+  data.sendCorrection = 0;
+  data.temporalTileRows = 0;
+  data.temporalSkew = 0;
+  data.numberOfTemporalBoundaryRows = 0;
+  data.temporalBoundaryRows = 0;
   return;
 }
 
@@ -97,12 +142,29 @@ template <class MGData_type>
 inline void DeleteMGData(MGData_type & data) {
 
   delete [] data.f2cOperator;
+  delete [] data.aggregates;
+  delete [] data.aggregateStart;
+  delete [] data.aggregateRows;
+  delete [] data.sendCorrection;
+  delete [] data.temporalBoundaryRows;
+  for (int i=0; i<data.numberOfAdditiveLevels-1; ++i) delete [] data.additiveRows[i];
+  delete [] data.additiveRows;
+  if (data.restrictionHalo!=0) {
+    DeleteRestrictionHaloData(*data.restrictionHalo);
+    delete data.restrictionHalo;
+  }
   DeleteVector(*data.Axf);
   DeleteVector(*data.rc);
   DeleteVector(*data.xc);
   delete data.Axf;
   delete data.rc;
   delete data.xc;
+  typename MGData_type::Vector_type * cycleVectors[4] = {data.rc2, data.xc2, data.Axc, data.Axc2};
+  for (int i=0; i<4; ++i) {
+    if (cycleVectors[i]==0) continue;
+    DeleteVector(*cycleVectors[i]);
+    delete cycleVectors[i];
+  }
   return;
 }
 
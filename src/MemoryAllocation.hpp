@@ -0,0 +1,128 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file MemoryAllocation.hpp
+
+ HPGMP routines for the allocation of the large arrays of vectors and matrices
+ */
+
+#ifndef MEMORYALLOCATION_HPP
+#define MEMORYALLOCATION_HPP
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#if defined(HPGMP_HUGE_PAGES) && defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "Geometry.hpp"
+
+const size_t HPGMP_ARRAY_ALIGNMENT = 64; //!< alignment of the arrays: a cache line, and the width of an AVX-512 register
+const size_t HPGMP_HUGE_PAGE_SIZE = 2*1024*1024; //!< size of the transparent huge pages requested with HPGMP_HUGE_PAGES
+
+/*!
+  Allocates an uninitialized array of n entries, aligned on HPGMP_ARRAY_ALIGNMENT bytes, to be
+  released with FreeArray.  Its pages are not touched, so that FirstTouchArray places them on the
+  NUMA nodes of the threads using them.
+
+  When HPGMP_HUGE_PAGES is defined (Linux), the arrays of at least HPGMP_HUGE_PAGE_SIZE bytes are
+  aligned on a huge page and advised to be backed by transparent huge pages.
+
+  @param[in] n the number of entries
+
+  @return returns the array; throws std::bad_alloc like new if it cannot be allocated
+*/
+template<class T>
+inline T * AllocateArray(size_t n) {
+  const size_t bytes = n*sizeof(T);
+  size_t alignment = HPGMP_ARRAY_ALIGNMENT;
+#if defined(HPGMP_HUGE_PAGES) && defined(__linux__)
+  if (bytes>=HPGMP_HUGE_PAGE_SIZE) alignment = HPGMP_HUGE_PAGE_SIZE;
+#endif
+  void * p = 0;
+#ifdef _WIN32
+  p = _aligned_malloc(bytes>0 ? bytes : alignment, alignment);
+#else
+  if (posix_memalign(&p, alignment, bytes>0 ? bytes : alignment)!=0) p = 0;
+#endif
+  if (p==0) throw std::bad_alloc();
+#if defined(HPGMP_HUGE_PAGES) && defined(__linux__)
+  if (bytes>=HPGMP_HUGE_PAGE_SIZE) madvise(p, bytes - bytes%HPGMP_HUGE_PAGE_SIZE, MADV_HUGEPAGE); // a hint, failures are ignored
+#endif
+  return static_cast<T *>(p);
+}
+
+/*!
+  Releases an array allocated by AllocateArray.
+
+  @param[in] a the array, or 0
+*/
+template<class T>
+inline void FreeArray(T * a) {
+#ifdef _WIN32
+  _aligned_free(a);
+#else
+  free(a);
+#endif
+  return;
+}
+
+/*!
+  Zeroes the n entries of a with the static schedule of the kernels over the rows, so that on
+  first touch each page lands on the NUMA node of the thread that reads it.
+
+  @param[out] a the array, newly allocated
+  @param[in] n the number of entries
+*/
+template<class T>
+inline void FirstTouchArray(T * a, size_t n) {
+  const long long length = n;
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (long long i=0; i<length; ++i) a[i] = T();
+  return;
+}
+
+/*!
+  Zeroes the n columns of m entries of a, each one with the static schedule of the kernels over
+  the rows, like FirstTouchArray, so that the rows of every column are on the node of their thread.
+
+  @param[out] a the array of the columns, newly allocated
+  @param[in] m the number of entries of a column
+  @param[in] n the number of columns
+*/
+template<class T>
+inline void FirstTouchArray(T * a, local_int_t m, local_int_t n) {
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel
+#endif
+  for (local_int_t j=0; j<n; ++j) {
+    T * const column = a + ((size_t) j)*m;
+#ifndef HPGMP_NO_OPENMP
+    #pragma omp for schedule(static) nowait
+#endif
+    for (local_int_t i=0; i<m; ++i) column[i] = T();
+  }
+  return;
+}
+
+#endif // MEMORYALLOCATION_HPP
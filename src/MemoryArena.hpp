@@ -0,0 +1,150 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file MemoryArena.hpp
+
+ HPGMP data structure
+ */
+
+#ifndef MEMORYARENA_HPP
+#define MEMORYARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#include "MemoryAllocation.hpp"
+
+/*!
+  Bump allocator holding the rows, halo lists and multigrid vectors of one level of a
+  hierarchy, so that a level is built without an allocation per row and released at once.
+
+  The arena maps one region sized for the level when it is created; should a level need more,
+  further regions of at least the same size are mapped.  The pages of a region are only backed
+  when written, so the arrays are placed on the NUMA nodes of the threads that first write them
+  (see FirstTouchArray), and an overestimated region costs address space but no memory.
+ */
+class MemoryArena {
+public:
+  std::vector<char *> regions;     //!< mapped regions, arrays being allocated from the last one
+  std::vector<size_t> regionSizes; //!< size in bytes of each region
+  size_t used;                     //!< bytes of the last region already allocated
+  size_t allocatedBytes;           //!< bytes of the arrays allocated from the arena, with their alignment
+};
+
+/*!
+  Maps a region of at least the given size and adds it to the arena.
+ */
+inline void MapMemoryArenaRegion(MemoryArena & arena, size_t bytes) {
+  const size_t size = (bytes + HPGMP_HUGE_PAGE_SIZE - 1)/HPGMP_HUGE_PAGE_SIZE*HPGMP_HUGE_PAGE_SIZE;
+#ifndef _WIN32
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+  flags |= MAP_NORESERVE;
+#endif
+  void * region = mmap(0, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (region==MAP_FAILED) throw std::bad_alloc();
+#if defined(HPGMP_HUGE_PAGES) && defined(__linux__)
+  madvise(region, size, MADV_HUGEPAGE); // a hint, failures are ignored
+#endif
+#else
+  void * region = AllocateArray<char>(size);
+#endif
+  arena.regions.push_back(static_cast<char *>(region));
+  arena.regionSizes.push_back(size);
+  arena.used = 0;
+  return;
+}
+
+/*!
+ Constructor for the memory arena.
+
+ @param[out] arena the arena, with one mapped region
+ @param[in] bytes the estimated size of the arrays of the level
+ */
+inline void InitializeMemoryArena(MemoryArena & arena, size_t bytes) {
+  arena.regions.clear();
+  arena.regionSizes.clear();
+  arena.used = 0;
+  arena.allocatedBytes = 0;
+  MapMemoryArenaRegion(arena, bytes>0 ? bytes : 1);
+  return;
+}
+
+/*!
+  Allocates an array of n entries from the arena, aligned on HPGMP_ARRAY_ALIGNMENT bytes.  It is
+  released with the arena, by DeleteMemoryArena.
+
+  @param[inout] arena the arena
+  @param[in] n the number of entries
+
+  @return returns the uninitialized array
+*/
+template<class T>
+inline T * ArenaAllocate(MemoryArena & arena, size_t n) {
+  const size_t bytes = (n*sizeof(T) + HPGMP_ARRAY_ALIGNMENT - 1)/HPGMP_ARRAY_ALIGNMENT*HPGMP_ARRAY_ALIGNMENT;
+  if (arena.used + bytes > arena.regionSizes.back())
+    MapMemoryArenaRegion(arena, bytes > arena.regionSizes.back() ? bytes : arena.regionSizes.back());
+  T * a = reinterpret_cast<T *>(arena.regions.back() + arena.used);
+  arena.used += bytes;
+  arena.allocatedBytes += bytes;
+  return a;
+}
+
+/*!
+  Allocates an array of n entries from the arena if it is not 0, and with new otherwise.
+
+  @return returns the array, to be released with the arena, or with delete [] if arena is 0
+*/
+template<class T>
+inline T * NewArray(MemoryArena * arena, size_t n) {
+  return arena!=0 ? ArenaAllocate<T>(*arena, n) : new T[n];
+}
+
+/*!
+  Returns the size in bytes of the regions mapped by the arena.
+ */
+inline size_t MemoryArenaSize(const MemoryArena & arena) {
+  size_t size = 0;
+  for (size_t i=0; i<arena.regionSizes.size(); ++i) size += arena.regionSizes[i];
+  return size;
+}
+
+/*!
+ Destructor for the memory arena: unmaps its regions, which releases all of its arrays.
+
+ @param[inout] arena the arena whose storage is deallocated
+ */
+inline void DeleteMemoryArena(MemoryArena & arena) {
+  for (size_t i=0; i<arena.regions.size(); ++i) {
+#ifndef _WIN32
+    munmap(arena.regions[i], arena.regionSizes[i]);
+#else
+    FreeArray(arena.regions[i]);
+#endif
+  }
+  arena.regions.clear();
+  arena.regionSizes.clear();
+  arena.used = 0;
+  arena.allocatedBytes = 0;
+  return;
+}
+
+#endif // MEMORYARENA_HPP
@@ -28,6 +28,7 @@
 
 #include "DataTypes.hpp"
 #include "Vector.hpp"
+#include "MemoryAllocation.hpp"
 
 template<class SC>
 class MultiVector {
@@ -68,7 +69,8 @@ inline void InitializeMultiVector(MultiVector_type & V, local_int_t localLength,
 
   V.localLength = localLength;
   V.n = n;
-  V.values = new scalar_type[localLength * n];
+  V.values = AllocateArray<scalar_type>(((size_t) localLength) * n);
+  FirstTouchArray(V.values, localLength, n);
   V.comm = comm;
   #if defined(HPGMP_WITH_CUDA)
   if (CUBLAS_STATUS_SUCCESS != cublasCreate(&V.handle)) {
@@ -102,8 +104,7 @@ inline void ZeroMultiVector(MultiVector_type & V) {
   local_int_t n = V.n;
   local_int_t m = V.localLength;
   scalar_type * vv = V.values;
-  for (int i=0; i<m*n; ++i)
-    vv[i] = 0.0;
+  FirstTouchArray(vv, m, n);
   return;
 }
 
@@ -146,7 +147,7 @@ inline void GetVector(MultiVector_type & V, local_int_t j, Vector_type & vj) {
 template<class MultiVector_type>
 inline void DeleteMultiVector(MultiVector_type & V) {
 
-  delete [] V.values;
+  FreeArray(V.values);
   V.localLength = 0;
   #if defined(HPGMP_WITH_CUDA)
   cudaFree (V.d_values);
@@ -20,7 +20,360 @@
  HPGMP routine
  */
 
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <cmath>
+#include <algorithm>
+#include <sys/mman.h>
 #include "OptimizeProblem.hpp"
+#include "SetupRestrictionHalo.hpp"
+#include "ComputeSPMV.hpp"
+#include "ComputeDotProduct.hpp"
+#include "ComputeWAXPBY.hpp"
+#include "MultiVector.hpp"
+#include "ReorderProblem.hpp"
+#include "SetupStencilMatrix.hpp"
+#include "SetupCompressedIndices.hpp"
+
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+/*!
+  Copies the rows of the levels of A mapped from a problem snapshot to the heap, and releases the
+  mapping.  The index sections of a snapshot are mapped read-only, so this has to precede any
+  pass that rewrites the rows in place.  Each row gets room for the longest row of its level, as
+  PermuteRows expects of a generated level.
+ */
+template<class SparseMatrix_type>
+static void CopySnapshotRows(SparseMatrix_type & A) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  void * mapping = A.snapshotData;
+  size_t mappingLength = A.snapshotLength;
+  if (mapping==0) return;
+
+  for (SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; curLevelMatrix = curLevelMatrix->Ac) {
+    if (curLevelMatrix->snapshotData==0) continue;
+    curLevelMatrix->snapshotData = 0;
+    curLevelMatrix->snapshotLength = 0;
+    const local_int_t nrow = curLevelMatrix->localNumberOfRows;
+    if (nrow<=0) {
+      curLevelMatrix->nonzerosInRow = 0;
+      continue;
+    }
+    int maxNonzerosPerRow = 0;
+    for (local_int_t i=0; i<nrow; ++i) maxNonzerosPerRow = std::max(maxNonzerosPerRow, (int) curLevelMatrix->nonzerosInRow[i]);
+
+    char * nonzerosInRow = new char[nrow];
+    std::copy(curLevelMatrix->nonzerosInRow, curLevelMatrix->nonzerosInRow + nrow, nonzerosInRow);
+#ifdef HPGMP_CONTIGUOUS_ARRAYS
+    const size_t numberOfEntries = ((size_t) nrow) * maxNonzerosPerRow;
+    local_int_t * indL = AllocateArray<local_int_t>(numberOfEntries);
+    global_int_t * indG = AllocateArray<global_int_t>(numberOfEntries);
+    scalar_type * values = AllocateArray<scalar_type>(numberOfEntries);
+#endif
+#ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (local_int_t i=0; i<nrow; ++i) {
+      const int nnz = curLevelMatrix->nonzerosInRow[i];
+      const local_int_t diagonal = curLevelMatrix->matrixDiagonal[i] - curLevelMatrix->matrixValues[i];
+#ifndef HPGMP_CONTIGUOUS_ARRAYS
+      local_int_t * rowIndL = new local_int_t[maxNonzerosPerRow];
+      global_int_t * rowIndG = new global_int_t[maxNonzerosPerRow];
+      scalar_type * rowValues = new scalar_type[maxNonzerosPerRow];
+#else
+      local_int_t * rowIndL = indL + ((size_t) i)*maxNonzerosPerRow;
+      global_int_t * rowIndG = indG + ((size_t) i)*maxNonzerosPerRow;
+      scalar_type * rowValues = values + ((size_t) i)*maxNonzerosPerRow;
+#endif
+      std::copy(curLevelMatrix->mtxIndL[i], curLevelMatrix->mtxIndL[i] + nnz, rowIndL);
+      std::copy(curLevelMatrix->mtxIndG[i], curLevelMatrix->mtxIndG[i] + nnz, rowIndG);
+      std::copy(curLevelMatrix->matrixValues[i], curLevelMatrix->matrixValues[i] + nnz, rowValues);
+      curLevelMatrix->mtxIndL[i] = rowIndL;
+      curLevelMatrix->mtxIndG[i] = rowIndG;
+      curLevelMatrix->matrixValues[i] = rowValues;
+      curLevelMatrix->matrixDiagonal[i] = rowValues + diagonal;
+    }
+    curLevelMatrix->nonzerosInRow = nonzerosInRow;
+  }
+  munmap(mapping, mappingLength);
+  return;
+}
+
+/*!
+  Prepares ComputeProlongationSmoother for a level coarsened by injection: the correction of each
+  boundary value sent to the neighbors, and the first row with an external column.  The fused
+  kernel applies the corrections in the order of f2cOperator, so it is only enabled when
+  f2cOperator is increasing.
+ */
+template<class SparseMatrix_type>
+static void SetupProlongationSmoother(const SparseMatrix_type & A) {
+
+  MGData<typename SparseMatrix_type::scalar_type> & mgData = *A.mgData;
+  if (mgData.f2cOperator==0 || mgData.isProlongationFused) return;
+
+  const local_int_t nrow = A.localNumberOfRows;
+  const local_int_t nc = mgData.rc->localLength;
+  for (local_int_t i=1; i<nc; ++i)
+    if (mgData.f2cOperator[i]<=mgData.f2cOperator[i-1]) return;
+
+  mgData.firstHaloRow = nrow;
+#ifndef HPGMP_NO_MPI
+  std::vector<local_int_t> fineToCoarse(nrow, -1);
+  for (local_int_t i=0; i<nc; ++i) fineToCoarse[mgData.f2cOperator[i]] = i;
+  mgData.sendCorrection = new local_int_t[A.totalToBeSent];
+  for (local_int_t i=0; i<A.totalToBeSent; ++i) mgData.sendCorrection[i] = fineToCoarse[A.elementsToSend[i]];
+
+  for (local_int_t i=0; i<nrow && mgData.firstHaloRow==nrow; ++i)
+    for (int j=0; j<A.nonzerosInRow[i]; ++j)
+      if (A.mtxIndL[i][j]>=nrow) mgData.firstHaloRow = i;
+#endif
+  mgData.isProlongationFused = true;
+  return;
+}
+#endif
+
+/*!
+  Prepares the temporal blocking of consecutive Gauss-Seidel sweeps (see ComputeTemporalGS).  A
+  sweep of a row reads the rows within the reach of its local columns, which is one plane of the grid
+  plus one line and one point for the generated problem, so the tiles are made of that many rows:
+  each sweep then trails the previous one by the farthest tile referenced, at most a couple of
+  tiles, and the wavefront of k sweeps spans about k planes.
+
+  The rows with external columns need the halo of the previous sweep, so they are left out of the
+  wavefront and listed as boundary rows, which are swept one step at a time, with a halo exchange
+  before each step, after the blocked sweeps of the interior rows.  On a single process all rows are
+  blocked; on several, the fraction of blocked rows is the interior of the local grid, which the
+  report lists for each level.  The tiles are the stencil reach along the row ordering, not
+  cache-sized 3D tiles of the grid, and only forward sweeps are blocked: symmetric Gauss-Seidel is not.
+ */
+template<class SparseMatrix_type>
+static void SetupTemporalBlocking(const SparseMatrix_type & A) {
+
+  MGData<typename SparseMatrix_type::scalar_type> & mgData = *A.mgData;
+  const local_int_t nrow = A.localNumberOfRows;
+  if (nrow==0 || mgData.temporalTileRows>0) return;
+  if (mgData.numberOfPresmootherSteps<2 && mgData.numberOfPostsmootherSteps<2) return;
+
+  std::vector<local_int_t> boundaryRows;
+  local_int_t reach = 1;
+  for (local_int_t i=0; i<nrow; ++i) {
+    bool isBoundary = false;
+    for (int j=0; j<A.nonzerosInRow[i]; ++j) {
+      const local_int_t col = A.mtxIndL[i][j];
+      if (col>=nrow) {
+        isBoundary = true;
+        continue;
+      }
+      local_int_t distance = col>i ? col-i : i-col;
+      if (distance>reach) reach = distance;
+    }
+    if (isBoundary) boundaryRows.push_back(i);
+  }
+  if ((local_int_t) boundaryRows.size()==nrow) return; // No interior rows to block
+
+  // Only the interior rows are in the wavefront, and they only read local columns
+  local_int_t skew = 1;
+  std::vector<local_int_t>::const_iterator boundary = boundaryRows.begin();
+  for (local_int_t i=0; i<nrow; ++i) {
+    if (boundary!=boundaryRows.end() && *boundary==i) {
+      ++boundary;
+      continue;
+    }
+    for (int j=0; j<A.nonzerosInRow[i]; ++j) {
+      local_int_t tiles = A.mtxIndL[i][j]/reach - i/reach;
+      if (tiles<0) tiles = -tiles;
+      if (tiles>skew) skew = tiles;
+    }
+  }
+  mgData.temporalTileRows = reach;
+  mgData.temporalSkew = skew;
+  mgData.numberOfTemporalBoundaryRows = boundaryRows.size();
+  if (!boundaryRows.empty()) {
+    mgData.temporalBoundaryRows = new local_int_t[boundaryRows.size()];
+    std::copy(boundaryRows.begin(), boundaryRows.end(), mgData.temporalBoundaryRows);
+  }
+  return;
+}
+
+/*!
+  Partitions the rows of a CSR level into runs of generic rows and of full rows (see RowRunData): a
+  row is full if it has HPGMP_FULL_ROW_LENGTH nonzeros, HPGMP_FULL_ROW_LENGTH entries after the previous
+  row of its run in mtxIndL and matrixValues, and its diagonal at HPGMP_FULL_ROW_DIAGONAL between its
+  lower and upper triangular terms.  These are the interior rows of the generated levels.
+ */
+template<class SparseMatrix_type>
+static void SetupRowRuns(const SparseMatrix_type & A) {
+
+  const local_int_t nrow = A.localNumberOfRows;
+  if (A.rowRuns!=0 || nrow==0) return;
+
+  std::vector<local_int_t> runStart(1, 0); // Starts of the runs so far, the last one is open
+  local_int_t numberOfFullRows = 0;
+  for (local_int_t i=0; i<nrow; ++i) {
+    bool isFull = A.nonzerosInRow[i]==HPGMP_FULL_ROW_LENGTH && A.matrixDiagonal[i]==A.matrixValues[i]+HPGMP_FULL_ROW_DIAGONAL;
+    for (int j=0; j<HPGMP_FULL_ROW_LENGTH && isFull; ++j)
+      if ((j<HPGMP_FULL_ROW_DIAGONAL && A.mtxIndL[i][j]>=i) || (j>HPGMP_FULL_ROW_DIAGONAL && A.mtxIndL[i][j]<=i)) isFull = false;
+    const bool isFullRun = runStart.size()%2==0;
+    if (isFull && isFullRun && i>runStart.back()
+        && (A.mtxIndL[i]!=A.mtxIndL[i-1]+HPGMP_FULL_ROW_LENGTH || A.matrixValues[i]!=A.matrixValues[i-1]+HPGMP_FULL_ROW_LENGTH)) {
+      runStart.push_back(i); // Not stored after the previous row: an empty generic run separates the two full runs
+      runStart.push_back(i);
+    } else if (isFull!=isFullRun) {
+      runStart.push_back(i);
+    }
+    if (isFull) ++numberOfFullRows;
+  }
+  if (runStart.size()%2==0) runStart.push_back(nrow); // The last run is generic, possibly empty
+  runStart.push_back(nrow);
+  if (numberOfFullRows==0) return;
+
+  RowRunData * runs = new RowRunData;
+  InitializeRowRunData(*runs);
+  runs->numberOfRuns = runStart.size()-1;
+  runs->runStart = new local_int_t[runStart.size()];
+  std::copy(runStart.begin(), runStart.end(), runs->runStart);
+  runs->numberOfFullRows = numberOfFullRows;
+  A.rowRuns = runs;
+  return;
+}
+
+/*!
+  Prepares the Chebyshev smoother of a level: the inverse diagonal (Jacobi-preconditioned Chebyshev only),
+  the update vector, and the eigenvalue bounds.  The largest eigenvalue of M^{-1}A is estimated by
+  the largest Ritz value of a few Arnoldi (Lanczos for symmetric M^{-1}A) steps started from a
+  pseudo-random vector of the global row ids, so that the estimate does not depend on the number
+  of processes, and enlarged by 10%; the polynomial damps the eigenvalues down to
+  HPGMP_CHEBYSHEV_EIG_RATIO times less.  Power iterations converge too slowly for this purpose, since
+  the top of the spectrum of the discretized operators is clustered.
+ */
+template<class SparseMatrix_type>
+static void SetupChebyshev(const SparseMatrix_type & A) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  typedef Vector<scalar_type> Vector_type;
+  typedef MultiVector<scalar_type> MultiVector_type;
+  SmootherData<scalar_type> & smoother = *GetSmootherData(A);
+  if (smoother.work!=0) return;
+
+  const local_int_t nrow = A.localNumberOfRows;
+  // The first step scales the previous update by zero, so it has to start out finite
+  smoother.work = new scalar_type[nrow];
+  for (local_int_t i=0; i<nrow; ++i) smoother.work[i] = 0.0;
+  if (smoother.type==HPGMP_SMOOTHER_JACOBI_CHEBYSHEV) {
+    smoother.inverseDiagonal = new scalar_type[nrow];
+    for (local_int_t i=0; i<nrow; ++i) smoother.inverseDiagonal[i] = 1.0/A.matrixDiagonal[i][0];
+  }
+
+  // Arnoldi basis V (with room for the halo values) and Hessenberg matrix H
+  const int m = HPGMP_CHEBYSHEV_ARNOLDI_STEPS;
+  MultiVector_type V;
+  Vector_type vj, vi, w;
+  InitializeMultiVector(V, A.localNumberOfColumns, m+1, A.comm);
+  InitializeVector(w, nrow, A.comm);
+  std::vector<double> H((m+1)*m, 0.0);
+  GetVector(V, 0, vj);
+  for (local_int_t i=0; i<nrow; ++i) {
+    unsigned long long h = (unsigned long long) A.localToGlobalMap[i] * 2862933555777941757ULL + 3037000493ULL;
+    vj.values[i] = 2.0*(double) (h>>40)/(double) (1ULL<<24) - 1.0;
+  }
+  bool isOptimized = true;
+  double t = 0.0;
+  scalar_type dot = 0.0;
+  ComputeDotProduct(nrow, vj, vj, dot, t, isOptimized);
+  ScaleVectorValue(vj, (scalar_type) (1.0/std::sqrt((double) dot)));
+
+  int k = 0;
+  for (; k<m; ++k) {
+    GetVector(V, k, vj);
+    ComputeSPMV(A, vj, w);
+    if (smoother.inverseDiagonal!=0)
+      for (local_int_t i=0; i<nrow; ++i) w.values[i] *= smoother.inverseDiagonal[i];
+    for (int i=0; i<=k; ++i) { // modified Gram-Schmidt
+      GetVector(V, i, vi);
+      ComputeDotProduct(nrow, w, vi, dot, t, isOptimized);
+      H[i+k*(m+1)] = dot;
+      ComputeWAXPBY(nrow, (scalar_type) 1.0, w, -dot, vi, w, isOptimized);
+    }
+    ComputeDotProduct(nrow, w, w, dot, t, isOptimized);
+    double norm = std::sqrt((double) dot);
+    H[k+1+k*(m+1)] = norm;
+    if (norm<=1.0e-12*std::fabs(H[k+k*(m+1)])) { ++k; break; } // invariant subspace
+    GetVector(V, k+1, vi);
+    for (local_int_t i=0; i<nrow; ++i) vi.values[i] = w.values[i]/norm;
+  }
+
+  // Largest Ritz value: power iterations on the (small, replicated) Hessenberg matrix
+  std::vector<double> y(k, 1.0), z(k);
+  double lambda = 0.0;
+  for (int it=0; it<HPGMP_CHEBYSHEV_RITZ_ITERATIONS; ++it) {
+    double znorm = 0.0, yz = 0.0, yy = 0.0;
+    for (int i=0; i<k; ++i) {
+      z[i] = 0.0;
+      for (int j=(i>0 ? i-1 : 0); j<k; ++j) z[i] += H[i+j*(m+1)]*y[j];
+    }
+    for (int i=0; i<k; ++i) { yz += y[i]*z[i]; yy += y[i]*y[i]; znorm += z[i]*z[i]; }
+    lambda = yz/yy;
+    znorm = std::sqrt(znorm);
+    if (znorm==0.0) break;
+    for (int i=0; i<k; ++i) y[i] = z[i]/znorm;
+  }
+  smoother.lambdaMax = 1.1*lambda;
+  smoother.lambdaMin = smoother.lambdaMax/HPGMP_CHEBYSHEV_EIG_RATIO;
+  DeleteMultiVector(V);
+  DeleteVector(w);
+  return;
+}
+
+/*!
+  Prepares the l1-Jacobi or hybrid Gauss-Seidel smoother of a level.  The hybrid smoother splits the
+  rows into one block per thread, made of whole z-planes of the local grid (of single rows if the
+  rows do not follow the grid, e.g. for imported matrices) so that the blocks are balanced and
+  mostly coupled within themselves.  The inverse of the diagonal, augmented in each row with the
+  absolute values of the entries outside the row's block (every off-diagonal entry for l1-Jacobi),
+  is stored so that the smoothers multiply instead of dividing by the diagonal.
+ */
+template<class SparseMatrix_type>
+static void SetupL1Smoother(const SparseMatrix_type & A) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  SmootherData<scalar_type> & smoother = *GetSmootherData(A);
+  if (smoother.work!=0) return;
+
+  const local_int_t nrow = A.localNumberOfRows;
+  smoother.work = new scalar_type[nrow];
+  smoother.inverseDiagonal = new scalar_type[nrow];
+
+  if (smoother.type==HPGMP_SMOOTHER_HYBRID_GAUSS_SEIDEL) {
+    int numThreads = 1;
+#ifndef HPGMP_NO_OPENMP
+    numThreads = omp_get_max_threads();
+#endif
+    const Geometry & geom = *A.geom;
+    local_int_t planeSize = ((global_int_t) geom.nx)*geom.ny*geom.nz==nrow ? geom.nx*geom.ny : 1;
+    local_int_t numberOfPlanes = nrow/planeSize;
+    smoother.numberOfBlocks = std::max(1, (int) std::min((local_int_t) numThreads, numberOfPlanes));
+    smoother.blockStart = new local_int_t[smoother.numberOfBlocks+1];
+    for (int b=0; b<=smoother.numberOfBlocks; ++b)
+      smoother.blockStart[b] = (local_int_t) (((global_int_t) b)*numberOfPlanes/smoother.numberOfBlocks)*planeSize;
+  }
+
+  for (int b=0; b<std::max(1, smoother.numberOfBlocks); ++b) {
+    local_int_t start = smoother.blockStart!=0 ? smoother.blockStart[b] : 0;
+    local_int_t end = smoother.blockStart!=0 ? smoother.blockStart[b+1] : nrow;
+    for (local_int_t i=start; i<end; ++i) {
+      double diagonal = A.matrixDiagonal[i][0], l1 = 0.0;
+      for (int j=0; j<A.nonzerosInRow[i]; ++j) {
+        local_int_t curCol = A.mtxIndL[i][j];
+        bool outside = smoother.blockStart!=0 ? curCol<start || curCol>=end : curCol!=i;
+        if (outside) l1 += std::fabs((double) A.matrixValues[i][j]);
+      }
+      smoother.inverseDiagonal[i] = 1.0/(diagonal + l1);
+    }
+  }
+  return;
+}
 
 /*!
   Optimizes the data structures used for CG iteration to increase the
@@ -100,6 +453,37 @@ int OptimizeProblem(SparseMatrix_type & A, GMRESData_type & data, Vector_type &
     colors[i] = counters[colors[i]]++;
 #endif
 
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+  // Locality-improving ordering of the rows, before any data that depends on it is set up.  The
+  // rows are permuted in place, so a hierarchy mapped from a snapshot is first copied out of it.
+  // b, x and xexact are shared with the other precision, and are permuted once by the caller
+  if (A.rowOrdering!=HPGMP_ROW_ORDER_LEXICOGRAPHIC) CopySnapshotRows(A);
+  if (ReorderProblem(A)) return -1;
+
+  // Halo of the rows injected into the coarse grids, for the fused residual and restriction in ComputeMG,
+  // DIA copy of the matrix or compressed column indices for the SpMV and Gauss-Seidel kernels, or the runs of full
+  // rows of the plain CSR levels, and data for the prolongation fused with the Gauss-Seidel post-smoother and its
+  // temporal blocking (plain CSR levels only), or for the other smoothers
+  for (const SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; curLevelMatrix = curLevelMatrix->Ac) {
+    curLevelMatrix = ActiveLevelMatrix(curLevelMatrix);
+    if (SetupRestrictionHalo(*curLevelMatrix)) return -1;
+    if (SetupStencilMatrix(*curLevelMatrix, A.matrixFormat)) return -1;
+    if (SetupCompressedIndices(*curLevelMatrix, A.matrixFormat)) return -1;
+    if (curLevelMatrix->stencilData==0 && curLevelMatrix->compressedIndices==0) SetupRowRuns(*curLevelMatrix);
+    const SmootherData<typename SparseMatrix_type::scalar_type> * smoother = GetSmootherData(*curLevelMatrix);
+    if (smoother==0) {
+      if (curLevelMatrix->mgData!=0 && curLevelMatrix->stencilData==0 && curLevelMatrix->compressedIndices==0) {
+        SetupProlongationSmoother(*curLevelMatrix);
+        SetupTemporalBlocking(*curLevelMatrix);
+      }
+    } else if (smoother->type==HPGMP_SMOOTHER_CHEBYSHEV || smoother->type==HPGMP_SMOOTHER_JACOBI_CHEBYSHEV) {
+      SetupChebyshev(*curLevelMatrix);
+    } else {
+      SetupL1Smoother(*curLevelMatrix);
+    }
+  }
+#endif
+
 #if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
   {
     typedef typename SparseMatrix_type::scalar_type SC;
@@ -759,7 +1143,44 @@ int OptimizeProblem(SparseMatrix_type & A, GMRESData_type & data, Vector_type &
 template<class SparseMatrix_type>
 double OptimizeProblemMemoryUse(const SparseMatrix_type & A) {
 
-  return 0.0;
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+
+  double numberOfBytes = 0.0;
+  for (const SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; curLevelMatrix = curLevelMatrix->Ac) {
+    curLevelMatrix = ActiveLevelMatrix(curLevelMatrix);
+    const SmootherData<scalar_type> * smoother = GetSmootherData(*curLevelMatrix);
+    if (smoother!=0) {
+      // Work vector and inverse diagonal of the smoother (the blocks are negligible)
+      double vectors = smoother->inverseDiagonal!=0 ? 2.0 : 1.0;
+      numberOfBytes += vectors*sizeof(scalar_type)*curLevelMatrix->totalNumberOfRows;
+    }
+    if (curLevelMatrix->stencilData!=0) {
+      // Coefficient planes and padded vector, estimated for all processes from the local sizes (the ghost cell lists are negligible)
+      const StencilData<scalar_type> & stencil = *curLevelMatrix->stencilData;
+      double paddedLength = (stencil.nx+2.0)*(stencil.ny+2.0)*(stencil.nz+2.0);
+      double localBytes = (HPGMP_STENCIL_POINTS*((double) curLevelMatrix->localNumberOfRows) + paddedLength)*sizeof(scalar_type);
+      numberOfBytes += localBytes*curLevelMatrix->geom->size;
+    }
+    if (curLevelMatrix->rowRuns!=0) {
+      // Run starts, estimated for all processes from the local sizes
+      numberOfBytes += ((double) curLevelMatrix->rowRuns->numberOfRuns+1.0)*sizeof(local_int_t)*curLevelMatrix->geom->size;
+    }
+    if (curLevelMatrix->compressedIndices!=0) {
+      // Codes and row bases, estimated for all processes from the local sizes
+      const CompressedIndexData & indices = *curLevelMatrix->compressedIndices;
+      double localBytes = ((double) curLevelMatrix->localNumberOfRows)*(indices.rowLength*indices.indexWidth + sizeof(local_int_t));
+      numberOfBytes += localBytes*curLevelMatrix->geom->size;
+    }
+    if (curLevelMatrix->mgData==0 || curLevelMatrix->mgData->restrictionHalo==0) continue;
+#ifndef HPGMP_NO_MPI
+    const RestrictionHaloData<scalar_type> & halo = *curLevelMatrix->mgData->restrictionHalo;
+    // Estimate for all processes using the local sizes
+    double entries = (double) halo.totalToBeSent + (double) halo.totalToBeReceived;
+    double localBytes = entries*(sizeof(local_int_t) + sizeof(scalar_type)) + 2.0*curLevelMatrix->numberOfSendNeighbors*sizeof(local_int_t);
+    numberOfBytes += localBytes*curLevelMatrix->geom->size;
+#endif
+  }
+  return numberOfBytes;
 
 }
 
@@ -0,0 +1,136 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ParallelFile.hpp
+
+ HPGMP thin wrappers around MPI-IO for collective access to a shared file
+ (stdio is used when compiled without MPI)
+ */
+
+#ifndef PARALLELFILE_HPP
+#define PARALLELFILE_HPP
+
+#include <cstdio>
+#include "hpgmp.hpp"
+
+#ifndef HPGMP_NO_MPI
+typedef MPI_File ParallelFile_type;
+#else
+typedef FILE * ParallelFile_type;
+#endif
+
+// MPI-IO counts are ints, so larger transfers are split into pieces of this many bytes
+const long long parallelFileChunk = 1LL << 30;
+
+/*!
+  Collectively opens a shared file, truncating it when opened for writing.
+
+  @return Returns zero on success and a non-zero value otherwise.
+ */
+inline int ParallelFileOpen(const char * fname, bool write, comm_type comm, ParallelFile_type & fh) {
+#ifndef HPGMP_NO_MPI
+  int amode = write ? (MPI_MODE_CREATE | MPI_MODE_WRONLY) : MPI_MODE_RDONLY;
+  if (MPI_File_open(comm, (char *) fname, amode, MPI_INFO_NULL, &fh) != MPI_SUCCESS) return -1;
+  if (write && MPI_File_set_size(fh, 0) != MPI_SUCCESS) return -1;
+  return 0;
+#else
+  (void) comm;
+  fh = fopen(fname, write ? "wb" : "rb");
+  return fh==0 ? -1 : 0;
+#endif
+}
+
+/*!
+  Collectively writes bytes bytes of buf at offset; every process must call it, possibly with bytes equal to 0.
+
+  @return Returns zero on success and a non-zero value otherwise.
+ */
+inline int ParallelFileWriteAt(ParallelFile_type fh, long long offset, const void * buf, long long bytes, comm_type comm) {
+  const char * cbuf = (const char *) buf;
+#ifndef HPGMP_NO_MPI
+  long long localChunks = (bytes + parallelFileChunk - 1)/parallelFileChunk, chunks = 0;
+  MPI_Allreduce(&localChunks, &chunks, 1, MPI_LONG_LONG, MPI_MAX, comm);
+  int ierr = 0;
+  for (long long c=0; c<chunks; ++c) {
+    long long start = c*parallelFileChunk;
+    int count = start<bytes ? (int) (bytes-start<parallelFileChunk ? bytes-start : parallelFileChunk) : 0;
+    MPI_Status status;
+    if (MPI_File_write_at_all(fh, offset+start, (void *) (cbuf+start), count, MPI_BYTE, &status) != MPI_SUCCESS) ierr = -1;
+  }
+  return ierr;
+#else
+  (void) comm;
+  if (bytes==0) return 0;
+  if (fseek(fh, offset, SEEK_SET) || fwrite(cbuf, 1, bytes, fh) != (size_t) bytes) return -1;
+  return 0;
+#endif
+}
+
+/*!
+  Collectively reads bytes bytes at offset into buf; every process must call it, possibly with bytes equal to 0.
+
+  @return Returns zero on success and a non-zero value otherwise.
+ */
+inline int ParallelFileReadAt(ParallelFile_type fh, long long offset, void * buf, long long bytes, comm_type comm) {
+  char * cbuf = (char *) buf;
+#ifndef HPGMP_NO_MPI
+  long long localChunks = (bytes + parallelFileChunk - 1)/parallelFileChunk, chunks = 0;
+  MPI_Allreduce(&localChunks, &chunks, 1, MPI_LONG_LONG, MPI_MAX, comm);
+  int ierr = 0;
+  for (long long c=0; c<chunks; ++c) {
+    long long start = c*parallelFileChunk;
+    int count = start<bytes ? (int) (bytes-start<parallelFileChunk ? bytes-start : parallelFileChunk) : 0;
+    MPI_Status status;
+    if (MPI_File_read_at_all(fh, offset+start, cbuf+start, count, MPI_BYTE, &status) != MPI_SUCCESS) ierr = -1;
+  }
+  return ierr;
+#else
+  (void) comm;
+  if (bytes==0) return 0;
+  if (fseek(fh, offset, SEEK_SET) || fread(cbuf, 1, bytes, fh) != (size_t) bytes) return -1;
+  return 0;
+#endif
+}
+
+/*!
+  Returns the size of the file in bytes, or -1 on error.
+ */
+inline long long ParallelFileSize(ParallelFile_type fh) {
+#ifndef HPGMP_NO_MPI
+  MPI_Offset size;
+  if (MPI_File_get_size(fh, &size) != MPI_SUCCESS) return -1;
+  return size;
+#else
+  if (fseek(fh, 0, SEEK_END)) return -1;
+  return ftell(fh);
+#endif
+}
+
+/*!
+  Collectively closes a file opened with ParallelFileOpen.
+ */
+inline int ParallelFileClose(ParallelFile_type & fh) {
+#ifndef HPGMP_NO_MPI
+  return MPI_File_close(&fh) == MPI_SUCCESS ? 0 : -1;
+#else
+  int ierr = fclose(fh);
+  fh = 0;
+  return ierr ? -1 : 0;
+#endif
+}
+
+#endif // PARALLELFILE_HPP
@@ -0,0 +1,215 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file PerfCounters.cpp
+
+ HPGMP routines of the hardware performance counters read by the profiler
+ */
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__linux__) && !defined(HPGMP_NO_PERF_COUNTERS)
+#define HPGMP_PERF_EVENTS
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <string>
+#include <vector>
+
+#include "PerfCounters.hpp"
+
+static std::string perfStatus = "Disabled"; //!< counters in use, or why there are none
+static bool perfCountersOpen = false; //!< whether the counters of the threads are open
+static bool perfCounterOpen[HPGMP_PERF_COUNTERS]; //!< whether each counter could be opened on all threads
+
+#ifdef HPGMP_PERF_EVENTS
+/*!
+  Group of counters of one thread: the cycles lead the group, so that all of its counters are
+  scheduled on the core together, and are read at once.
+ */
+struct PerfCounterGroup {
+  int fds[HPGMP_PERF_COUNTERS]; //!< file descriptors of the counters, -1 for those not available
+  int numberOfCounters;         //!< number of counters opened in the group
+};
+
+static std::vector<PerfCounterGroup> perfGroups; //!< one group per OpenMP thread
+
+/*!
+  Opens a counter of the calling thread, of the user space code only, in the group of groupFd.
+
+  @return returns the file descriptor, or -1 with errno set
+ */
+static int OpenPerfCounter(int counter, int groupFd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  if (counter==HPGMP_PERF_CYCLES) attr.config = PERF_COUNT_HW_CPU_CYCLES;
+  else if (counter==HPGMP_PERF_INSTRUCTIONS) attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+  else attr.config = PERF_COUNT_HW_CACHE_MISSES;
+  attr.disabled = groupFd<0 ? 1 : 0; // The group is enabled through its leader
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+#endif
+
+/*!
+  Opens the hardware counters (core cycles, instructions and last level cache misses) of every
+  OpenMP thread with Linux perf_event_open, and starts them.  Without them, for example in
+  containers, where perf events are often forbidden, or on other systems, the profiler records
+  times only.  The cache misses are optional, since virtual machines seldom expose them.  Calling
+  it again keeps the counters already open.
+
+  The threads must keep running the parallel regions that follow, like the threads of the OpenMP
+  runtime do.
+
+  @param[in] enable whether the counters are requested (--hwc=1)
+
+  @return returns 0 if the counters are in use, and nonzero otherwise
+*/
+int SetupPerfCounters(bool enable) {
+  if (perfCountersOpen || !enable) return perfCountersOpen ? 0 : 1;
+#ifdef HPGMP_PERF_EVENTS
+  int numberOfThreads = 1;
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel
+  {
+    #pragma omp single
+    numberOfThreads = omp_get_num_threads();
+  }
+#endif
+  perfGroups.assign(numberOfThreads, PerfCounterGroup());
+  std::vector<int> errors(numberOfThreads*HPGMP_PERF_COUNTERS, 0);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel num_threads(numberOfThreads)
+#endif
+  {
+    int thread = 0;
+#ifndef HPGMP_NO_OPENMP
+    thread = omp_get_thread_num();
+#endif
+    PerfCounterGroup & group = perfGroups[thread];
+    group.numberOfCounters = 0;
+    for (int i=0; i<HPGMP_PERF_COUNTERS; ++i) {
+      group.fds[i] = -1;
+      if (i>0 && group.fds[0]<0) continue;
+      group.fds[i] = OpenPerfCounter(i, i==0 ? -1 : group.fds[0]);
+      if (group.fds[i]<0) errors[thread*HPGMP_PERF_COUNTERS+i] = errno;
+      else ++group.numberOfCounters;
+    }
+  }
+
+  // The cycles and instructions are required, the cache misses on all threads or on none
+  int error = 0;
+  for (int i=0; i<HPGMP_PERF_COUNTERS; ++i) {
+    perfCounterOpen[i] = true;
+    for (int thread=0; thread<numberOfThreads; ++thread)
+      if (errors[thread*HPGMP_PERF_COUNTERS+i]!=0) {
+        perfCounterOpen[i] = false;
+        if (i!=HPGMP_PERF_LLC_MISSES && error==0) error = errors[thread*HPGMP_PERF_COUNTERS+i];
+      }
+  }
+  if (error!=0) {
+    perfStatus = std::string("Unavailable (") + strerror(error) + ")";
+    DeletePerfCounters();
+    return 1;
+  }
+  for (int thread=0; thread<numberOfThreads; ++thread) {
+    PerfCounterGroup & group = perfGroups[thread];
+    if (!perfCounterOpen[HPGMP_PERF_LLC_MISSES] && group.fds[HPGMP_PERF_LLC_MISSES]>=0) {
+      close(group.fds[HPGMP_PERF_LLC_MISSES]); // Not counted on every thread, so on none
+      group.fds[HPGMP_PERF_LLC_MISSES] = -1;
+      --group.numberOfCounters;
+    }
+    ioctl(group.fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+  perfCountersOpen = true;
+  perfStatus = perfCounterOpen[HPGMP_PERF_LLC_MISSES] ? "Cycles, instructions, LLC misses" : "Cycles, instructions";
+  return 0;
+#else
+  perfStatus = "Unavailable (not supported on this system)";
+  return 1;
+#endif
+}
+
+/*!
+  Returns whether the counters are in use.
+ */
+bool PerfCountersAvailable() {
+  return perfCountersOpen;
+}
+
+/*!
+  Returns whether the given counter (HPGMP_PERF_CYCLES, ...) is in use.
+ */
+bool PerfCounterAvailable(int counter) {
+  return perfCountersOpen && perfCounterOpen[counter];
+}
+
+/*!
+  Returns the counters in use, or why there are none, for the report.
+ */
+const char * PerfCountersStatus() {
+  return perfStatus.c_str();
+}
+
+/*!
+  Reads the counters, summed over the threads.  Must be called outside of parallel regions.
+
+  @param[out] counts the counts since the counters were started (0 for the counters not in use)
+
+  @return returns false, leaving counts unchanged, if the counters are not in use
+*/
+bool ReadPerfCounters(double counts[HPGMP_PERF_COUNTERS]) {
+  if (!perfCountersOpen) return false;
+#ifdef HPGMP_PERF_EVENTS
+  for (int i=0; i<HPGMP_PERF_COUNTERS; ++i) counts[i] = 0.0;
+  for (size_t thread=0; thread<perfGroups.size(); ++thread) {
+    const PerfCounterGroup & group = perfGroups[thread];
+    unsigned long long values[1+HPGMP_PERF_COUNTERS]; // number of counters, then their values in opening order
+    if (read(group.fds[0], values, sizeof(values))<(ssize_t) ((1+group.numberOfCounters)*sizeof(values[0]))) continue;
+    int j = 1;
+    for (int i=0; i<HPGMP_PERF_COUNTERS; ++i)
+      if (group.fds[i]>=0) counts[i] += (double) values[j++];
+  }
+#endif
+  return true;
+}
+
+/*!
+  Closes the counters of all threads.
+ */
+void DeletePerfCounters() {
+#ifdef HPGMP_PERF_EVENTS
+  for (size_t thread=0; thread<perfGroups.size(); ++thread)
+    for (int i=HPGMP_PERF_COUNTERS-1; i>=0; --i)
+      if (perfGroups[thread].fds[i]>=0) close(perfGroups[thread].fds[i]);
+  perfGroups.clear();
+#endif
+  perfCountersOpen = false;
+  return;
+}
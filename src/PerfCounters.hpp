@@ -0,0 +1,38 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file PerfCounters.hpp
+
+ HPGMP routines of the hardware performance counters read by the profiler
+ */
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+const int HPGMP_PERF_CYCLES = 0;       //!< index of the core cycles in the counts
+const int HPGMP_PERF_INSTRUCTIONS = 1; //!< index of the instructions retired
+const int HPGMP_PERF_LLC_MISSES = 2;   //!< index of the last level cache misses
+const int HPGMP_PERF_COUNTERS = 3;     //!< number of counters
+
+int SetupPerfCounters(bool enable);
+bool PerfCountersAvailable();
+bool PerfCounterAvailable(int counter);
+const char * PerfCountersStatus();
+bool ReadPerfCounters(double counts[HPGMP_PERF_COUNTERS]);
+void DeletePerfCounters();
+
+#endif // PERFCOUNTERS_HPP
@@ -0,0 +1,477 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ProblemSnapshot.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ProblemSnapshot.hpp"
+#include "MGData.hpp"
+#include "mytimer.hpp"
+using std::endl;
+
+namespace {
+
+const char snapshotMagic[8] = {'H', 'P', 'G', 'M', 'P', 'S', 'N', 'P'};
+const long long snapshotVersion = 1;
+const long long snapshotAlignment = 65536; // Sections start on a boundary valid for 4K and 64K pages
+const int maxSnapshotLevels = 16;
+
+// Sections before SNAP_VALUES hold indices and are mapped read-only.  The values are mapped
+// copy-on-write, so the matrix can still be modified in place (e.g., ReplaceMatrixDiagonal).
+enum {
+  SNAP_NONZEROS_IN_ROW = 0, SNAP_DIAGONAL, SNAP_INDEX_G, SNAP_INDEX_L, SNAP_LOCAL_TO_GLOBAL,
+  SNAP_PARTZ_IDS, SNAP_PARTZ_NZ, SNAP_ELEMENTS_TO_SEND, SNAP_NEIGHBORS, SNAP_RECEIVE_LENGTH,
+  SNAP_SEND_LENGTH, SNAP_F2C, SNAP_VALUES, SNAP_NUMBER_OF_SECTIONS
+};
+
+struct SnapshotLevel {
+  long long size, rank, numThreads, nx, ny, nz, npx, npy, npz, pz, npartz, ipx, ipy, ipz;
+  long long gnx, gny, gnz, gix0, giy0, giz0;
+  long long totalNumberOfRows, totalNumberOfNonzeros;
+  long long localNumberOfRows, localNumberOfColumns, localNumberOfNonzeros;
+  long long numberOfExternalValues, numberOfSendNeighbors, totalToBeSent;
+  long long rowStride; //!< entries reserved per row in the index and value sections
+  long long offset[SNAP_NUMBER_OF_SECTIONS];
+  long long length[SNAP_NUMBER_OF_SECTIONS];
+};
+
+struct SnapshotHeader {
+  char magic[8];
+  long long version, matrixScalarSize, vectorScalarSize, localIntSize, globalIntSize;
+  long long numberOfMgLevels, hasVectors, alignment, fileLength;
+  long long vectorOffset[3]; //!< b, x and xexact
+  SnapshotLevel level[maxSnapshotLevels];
+};
+
+template<class SC>
+inline char PrecisionTag() { return sizeof(SC)==sizeof(double) ? 'd' : 's'; }
+
+// One file per rank, communicator size and precision pair
+inline void SnapshotFileName(char * fname, const Geometry & geom, char matrixTag, char vectorTag) {
+  sprintf(fname, "hpgmp_snapshot_%c%c_np%d_r%d.bin", matrixTag, vectorTag, geom.size, geom.rank);
+}
+
+/*!
+  Sequential writer that places each section on an aligned file offset.
+ */
+class SnapshotWriter {
+public:
+  SnapshotWriter(FILE * f, long long pos) : f(f), pos(pos), ok(true) {}
+
+  template<class T>
+  long long Append(const T * data, long long count) {
+    Align();
+    long long start = pos;
+    if (count>0 && fwrite(data, sizeof(T), count, f) != (size_t) count) ok = false;
+    pos += count*sizeof(T);
+    return start;
+  }
+
+  // Rows are padded to a fixed stride so they can be addressed in place once mapped
+  template<class T>
+  long long AppendRows(T * const * rows, const char * nonzerosInRow, local_int_t nrow, int stride) {
+    Align();
+    long long start = pos;
+    std::vector<T> padding(stride, T(0));
+    for (local_int_t i=0; i<nrow; ++i) {
+      int nnz = nonzerosInRow[i];
+      if (nnz>0 && fwrite(rows[i], sizeof(T), nnz, f) != (size_t) nnz) ok = false;
+      if (nnz<stride && fwrite(padding.data(), sizeof(T), stride-nnz, f) != (size_t) (stride-nnz)) ok = false;
+    }
+    pos += ((long long) nrow)*stride*sizeof(T);
+    return start;
+  }
+
+  FILE * f;
+  long long pos;
+  bool ok;
+
+private:
+  void Align() {
+    long long pad = (snapshotAlignment - pos%snapshotAlignment) % snapshotAlignment;
+    if (pad>0 && fseek(f, pad, SEEK_CUR)) ok = false;
+    pos += pad;
+  }
+};
+
+template<class T>
+inline void RecordSection(SnapshotLevel & rec, int section, long long offset, long long count) {
+  rec.offset[section] = offset;
+  rec.length[section] = count*sizeof(T);
+}
+
+} // anonymous namespace
+
+/*!
+  Writes the complete MG hierarchy of A (matrices, halo lists, fine-to-coarse operators and
+  geometries), and optionally b, x and xexact, to a per-rank binary snapshot file.
+
+  The file is written under a temporary name and renamed once complete, so that snapshots
+  that are mapped by live matrices are never modified.
+
+  @param[in] numberOfMgLevels Number of levels in the hierarchy, including the finest
+  @param[in] A                The fine-level matrix with its coarse levels attached
+  @param[in] b, x, xexact     Vectors to save with the matrix (only used if init_vect is true)
+  @param[in] init_vect        True if the vectors have been generated
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see ReadProblemSnapshot
+*/
+template<class SparseMatrix_type, class Vector_type>
+int WriteProblemSnapshot(int numberOfMgLevels, const SparseMatrix_type & A,
+                         const Vector_type * b, const Vector_type * x, const Vector_type * xexact, bool init_vect) {
+
+  typedef typename SparseMatrix_type::scalar_type matrix_scalar_type;
+  typedef typename Vector_type::scalar_type vector_scalar_type;
+
+  if (numberOfMgLevels>maxSnapshotLevels) return -1;
+
+  char fname[128], tname[160];
+  SnapshotFileName(fname, *A.geom, PrecisionTag<matrix_scalar_type>(), PrecisionTag<vector_scalar_type>());
+  sprintf(tname, "%s.tmp", fname);
+  FILE * f = fopen(tname, "wb");
+  if (f==0) return -1;
+
+  SnapshotHeader * header = new SnapshotHeader;
+  memset(header, 0, sizeof(SnapshotHeader));
+  memcpy(header->magic, snapshotMagic, sizeof(snapshotMagic));
+  header->version = snapshotVersion;
+  header->matrixScalarSize = sizeof(matrix_scalar_type);
+  header->vectorScalarSize = sizeof(vector_scalar_type);
+  header->localIntSize = sizeof(local_int_t);
+  header->globalIntSize = sizeof(global_int_t);
+  header->numberOfMgLevels = numberOfMgLevels;
+  header->hasVectors = init_vect;
+  header->alignment = snapshotAlignment;
+
+  SnapshotWriter out(f, sizeof(SnapshotHeader));
+  if (fseek(f, sizeof(SnapshotHeader), SEEK_SET)) out.ok = false;
+
+  const SparseMatrix_type * cur = &A;
+  for (int level=0; level<numberOfMgLevels; ++level) {
+    SnapshotLevel & rec = header->level[level];
+    const Geometry & geom = *cur->geom;
+    local_int_t nrow = cur->localNumberOfRows;
+
+    rec.size = geom.size; rec.rank = geom.rank; rec.numThreads = geom.numThreads;
+    rec.nx = geom.nx; rec.ny = geom.ny; rec.nz = geom.nz;
+    rec.npx = geom.npx; rec.npy = geom.npy; rec.npz = geom.npz;
+    rec.pz = geom.pz; rec.npartz = geom.npartz;
+    rec.ipx = geom.ipx; rec.ipy = geom.ipy; rec.ipz = geom.ipz;
+    rec.gnx = geom.gnx; rec.gny = geom.gny; rec.gnz = geom.gnz;
+    rec.gix0 = geom.gix0; rec.giy0 = geom.giy0; rec.giz0 = geom.giz0;
+    rec.totalNumberOfRows = cur->totalNumberOfRows;
+    rec.totalNumberOfNonzeros = cur->totalNumberOfNonzeros;
+    rec.localNumberOfRows = nrow;
+    rec.localNumberOfColumns = cur->localNumberOfColumns;
+    rec.localNumberOfNonzeros = cur->localNumberOfNonzeros;
+
+    int stride = 0;
+    std::vector<char> diagonal(nrow);
+    for (local_int_t i=0; i<nrow; ++i) {
+      if (cur->nonzerosInRow[i]>stride) stride = cur->nonzerosInRow[i];
+      diagonal[i] = (char) (cur->matrixDiagonal[i] - cur->matrixValues[i]);
+    }
+    rec.rowStride = stride;
+
+    RecordSection<char>(rec, SNAP_NONZEROS_IN_ROW, out.Append(cur->nonzerosInRow, nrow), nrow);
+    RecordSection<char>(rec, SNAP_DIAGONAL, out.Append(diagonal.data(), nrow), nrow);
+    RecordSection<global_int_t>(rec, SNAP_INDEX_G, out.AppendRows(cur->mtxIndG, cur->nonzerosInRow, nrow, stride), ((long long) nrow)*stride);
+    RecordSection<local_int_t>(rec, SNAP_INDEX_L, out.AppendRows(cur->mtxIndL, cur->nonzerosInRow, nrow, stride), ((long long) nrow)*stride);
+    RecordSection<global_int_t>(rec, SNAP_LOCAL_TO_GLOBAL, out.Append(cur->localToGlobalMap.data(), nrow), nrow);
+    RecordSection<int>(rec, SNAP_PARTZ_IDS, out.Append(geom.partz_ids, geom.npartz), geom.npartz);
+    RecordSection<local_int_t>(rec, SNAP_PARTZ_NZ, out.Append(geom.partz_nz, geom.npartz), geom.npartz);
+#ifndef HPGMP_NO_MPI
+    rec.numberOfExternalValues = cur->numberOfExternalValues;
+    rec.numberOfSendNeighbors = cur->numberOfSendNeighbors;
+    rec.totalToBeSent = cur->totalToBeSent;
+    RecordSection<local_int_t>(rec, SNAP_ELEMENTS_TO_SEND, out.Append(cur->elementsToSend, cur->totalToBeSent), cur->totalToBeSent);
+    RecordSection<int>(rec, SNAP_NEIGHBORS, out.Append(cur->neighbors, cur->numberOfSendNeighbors), cur->numberOfSendNeighbors);
+    RecordSection<local_int_t>(rec, SNAP_RECEIVE_LENGTH, out.Append(cur->receiveLength, cur->numberOfSendNeighbors), cur->numberOfSendNeighbors);
+    RecordSection<local_int_t>(rec, SNAP_SEND_LENGTH, out.Append(cur->sendLength, cur->numberOfSendNeighbors), cur->numberOfSendNeighbors);
+#endif
+    if (level<numberOfMgLevels-1) {
+      local_int_t nrowc = cur->Ac->localNumberOfRows;
+      RecordSection<local_int_t>(rec, SNAP_F2C, out.Append(cur->mgData->f2cOperator, nrowc), nrowc);
+    }
+    RecordSection<matrix_scalar_type>(rec, SNAP_VALUES, out.AppendRows(cur->matrixValues, cur->nonzerosInRow, nrow, stride), ((long long) nrow)*stride);
+
+    cur = cur->Ac;
+  }
+
+  if (init_vect) {
+    header->vectorOffset[0] = out.Append(b->values, b->localLength);
+    header->vectorOffset[1] = out.Append(x->values, x->localLength);
+    header->vectorOffset[2] = out.Append(xexact->values, xexact->localLength);
+  }
+  header->fileLength = out.pos;
+
+  if (fseek(f, 0, SEEK_SET) || fwrite(header, sizeof(SnapshotHeader), 1, f) != 1) out.ok = false;
+  if (fclose(f)) out.ok = false;
+  delete header;
+
+  if (!out.ok || rename(tname, fname)) {
+    remove(tname);
+    return -1;
+  }
+  if (A.geom->rank==0) HPGMP_fout << "Problem snapshot written to " << fname << endl;
+  return 0;
+}
+
+/*!
+  Reconstructs the MG hierarchy of A from the per-rank snapshot written by WriteProblemSnapshot.
+
+  The file is mapped rather than read: the matrix rows point directly into the mapping, index
+  sections are made read-only and value sections are private copy-on-write pages.  Only the
+  small halo lists, fine-to-coarse operators and vectors are copied to the heap.  The mapping
+  is released by DeleteMatrix, or by OptimizeProblem when it copies the rows out to reorder them.
+
+  Only the CSR rows of the hierarchy are saved: the layouts set up by OptimizeProblem (DIA copy,
+  compressed column indices, row reordering, runs of full rows, smoother data) and the direct
+  coarse solver are rebuilt after every restart.
+
+  All processes agree on the outcome; if the snapshot is missing or does not match the
+  current geometry on any process, A is left untouched on all of them.
+
+  @param[in]    numberOfMgLevels Number of levels in the hierarchy, including the finest
+  @param[inout] A                Initialized matrix that will receive the hierarchy
+  @param[in]    geom             The geometry of the fine level, which the snapshot must match
+  @param[out]   b, x, xexact     Newly allocated vectors with the saved values (only if init_vect is true)
+  @param[in]    init_vect        True if the vectors should be restored
+  @param[in]    comm             Communicator of the matrix
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see WriteProblemSnapshot
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ReadProblemSnapshot(int numberOfMgLevels, SparseMatrix_type & A, Geometry * geom,
+                        Vector_type * b, Vector_type * x, Vector_type * xexact, bool init_vect, comm_type comm) {
+
+  typedef typename SparseMatrix_type::scalar_type matrix_scalar_type;
+  typedef typename Vector_type::scalar_type vector_scalar_type;
+  typedef Vector<matrix_scalar_type> MatrixVector_type;
+  typedef MGData<matrix_scalar_type> MGData_type;
+
+  double t0 = mytimer();
+  char fname[128];
+  SnapshotFileName(fname, *geom, PrecisionTag<matrix_scalar_type>(), PrecisionTag<vector_scalar_type>());
+
+  SnapshotHeader * header = new SnapshotHeader;
+  char * base = 0;
+  int ierr = 0;
+  int fd = open(fname, O_RDONLY);
+  if (fd<0) ierr = 1;
+  if (!ierr && pread(fd, header, sizeof(SnapshotHeader), 0) != (ssize_t) sizeof(SnapshotHeader)) ierr = 1;
+  if (!ierr) {
+    const SnapshotLevel & rec = header->level[0];
+    struct stat st;
+    if (memcmp(header->magic, snapshotMagic, sizeof(snapshotMagic)) || header->version!=snapshotVersion ||
+        header->matrixScalarSize!=(long long) sizeof(matrix_scalar_type) ||
+        header->vectorScalarSize!=(long long) sizeof(vector_scalar_type) ||
+        header->localIntSize!=(long long) sizeof(local_int_t) || header->globalIntSize!=(long long) sizeof(global_int_t) ||
+        header->numberOfMgLevels!=numberOfMgLevels || (init_vect && !header->hasVectors) ||
+        rec.size!=geom->size || rec.rank!=geom->rank ||
+        rec.nx!=geom->nx || rec.ny!=geom->ny || rec.nz!=geom->nz ||
+        rec.npx!=geom->npx || rec.npy!=geom->npy || rec.npz!=geom->npz ||
+        rec.pz!=geom->pz || rec.npartz!=geom->npartz ||
+        rec.gnx!=geom->gnx || rec.gny!=geom->gny || rec.gnz!=geom->gnz ||
+        fstat(fd, &st) || st.st_size!=header->fileLength)
+      ierr = 1;
+  }
+  if (!ierr) {
+    void * mapping = mmap(0, header->fileLength, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (mapping==MAP_FAILED) ierr = 1;
+    else base = (char *) mapping;
+  }
+  if (!ierr) { // Nonuniform z partitions must match as well
+    const local_int_t * partz_nz = (const local_int_t *) (base + header->level[0].offset[SNAP_PARTZ_NZ]);
+    for (int i=0; i<geom->npartz; ++i)
+      if (partz_nz[i]!=geom->partz_nz[i]) ierr = 1;
+  }
+  if (fd>=0) close(fd);
+
+  // Falling back to problem generation involves collectives, so all processes have to agree
+#ifndef HPGMP_NO_MPI
+  int localErr = ierr;
+  MPI_Allreduce(&localErr, &ierr, 1, MPI_INT, MPI_MAX, comm);
+#endif
+  if (ierr) {
+    if (base!=0) munmap(base, header->fileLength);
+    delete header;
+    return ierr;
+  }
+
+  long long pageSize = sysconf(_SC_PAGESIZE);
+  SparseMatrix_type * cur = &A;
+  for (int level=0; level<numberOfMgLevels; ++level) {
+    const SnapshotLevel & rec = header->level[level];
+
+    if (pageSize>0 && header->alignment%pageSize==0) {
+      for (int section=0; section<SNAP_VALUES; ++section) {
+        if (rec.length[section]==0) continue;
+        long long length = ((rec.length[section]+pageSize-1)/pageSize)*pageSize;
+        mprotect(base + rec.offset[section], length, PROT_READ);
+      }
+    }
+
+    Geometry * geomc = geom;
+    if (level>0) {
+      geomc = new Geometry;
+      geomc->size = rec.size; geomc->rank = rec.rank; geomc->numThreads = rec.numThreads;
+      geomc->nx = rec.nx; geomc->ny = rec.ny; geomc->nz = rec.nz;
+      geomc->npx = rec.npx; geomc->npy = rec.npy; geomc->npz = rec.npz;
+      geomc->pz = rec.pz; geomc->npartz = rec.npartz;
+      geomc->ipx = rec.ipx; geomc->ipy = rec.ipy; geomc->ipz = rec.ipz;
+      geomc->gnx = rec.gnx; geomc->gny = rec.gny; geomc->gnz = rec.gnz;
+      geomc->gix0 = rec.gix0; geomc->giy0 = rec.giy0; geomc->giz0 = rec.giz0;
+      geomc->partz_ids = new int[rec.npartz];
+      geomc->partz_nz = new local_int_t[rec.npartz];
+      memcpy(geomc->partz_ids, base + rec.offset[SNAP_PARTZ_IDS], rec.length[SNAP_PARTZ_IDS]);
+      memcpy(geomc->partz_nz, base + rec.offset[SNAP_PARTZ_NZ], rec.length[SNAP_PARTZ_NZ]);
+      InitializeSparseMatrix(*cur, geomc, comm);
+    }
+
+    local_int_t nrow = rec.localNumberOfRows;
+    int stride = rec.rowStride;
+    cur->totalNumberOfRows = rec.totalNumberOfRows;
+    cur->totalNumberOfNonzeros = rec.totalNumberOfNonzeros;
+    cur->localNumberOfRows = nrow;
+    cur->localNumberOfColumns = rec.localNumberOfColumns;
+    cur->localNumberOfNonzeros = rec.localNumberOfNonzeros;
+
+    char * nonzerosInRow = base + rec.offset[SNAP_NONZEROS_IN_ROW];
+    const char * diagonal = base + rec.offset[SNAP_DIAGONAL];
+    global_int_t * indG = (global_int_t *) (base + rec.offset[SNAP_INDEX_G]);
+    local_int_t * indL = (local_int_t *) (base + rec.offset[SNAP_INDEX_L]);
+    matrix_scalar_type * values = (matrix_scalar_type *) (base + rec.offset[SNAP_VALUES]);
+    cur->nonzerosInRow = nonzerosInRow;
+    cur->mtxIndG = new global_int_t*[nrow];
+    cur->mtxIndL = new local_int_t*[nrow];
+    cur->matrixValues = new matrix_scalar_type*[nrow];
+    cur->matrixDiagonal = new matrix_scalar_type*[nrow];
+#ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel for
+#endif
+    for (local_int_t i=0; i<nrow; ++i) {
+      cur->mtxIndG[i] = indG + ((long long) i)*stride;
+      cur->mtxIndL[i] = indL + ((long long) i)*stride;
+      cur->matrixValues[i] = values + ((long long) i)*stride;
+      cur->matrixDiagonal[i] = cur->matrixValues[i] + diagonal[i];
+    }
+
+    const global_int_t * localToGlobal = (const global_int_t *) (base + rec.offset[SNAP_LOCAL_TO_GLOBAL]);
+    cur->localToGlobalMap.assign(localToGlobal, localToGlobal + nrow);
+    cur->globalToLocalMap.clear();
+#if __cplusplus >= 201103L
+    cur->globalToLocalMap.reserve(nrow);
+#endif
+    for (local_int_t i=0; i<nrow; ++i) cur->globalToLocalMap[localToGlobal[i]] = i;
+
+#ifndef HPGMP_NO_MPI
+    cur->numberOfExternalValues = rec.numberOfExternalValues;
+    cur->numberOfSendNeighbors = rec.numberOfSendNeighbors;
+    cur->totalToBeSent = rec.totalToBeSent;
+    cur->elementsToSend = new local_int_t[rec.totalToBeSent];
+    cur->neighbors = new int[rec.numberOfSendNeighbors];
+    cur->receiveLength = new local_int_t[rec.numberOfSendNeighbors];
+    cur->sendLength = new local_int_t[rec.numberOfSendNeighbors];
+    cur->sendBuffer = new matrix_scalar_type[rec.totalToBeSent];
+    memcpy(cur->elementsToSend, base + rec.offset[SNAP_ELEMENTS_TO_SEND], rec.length[SNAP_ELEMENTS_TO_SEND]);
+    memcpy(cur->neighbors, base + rec.offset[SNAP_NEIGHBORS], rec.length[SNAP_NEIGHBORS]);
+    memcpy(cur->receiveLength, base + rec.offset[SNAP_RECEIVE_LENGTH], rec.length[SNAP_RECEIVE_LENGTH]);
+    memcpy(cur->sendLength, base + rec.offset[SNAP_SEND_LENGTH], rec.length[SNAP_SEND_LENGTH]);
+#endif
+    cur->snapshotData = base;
+
+    if (level<numberOfMgLevels-1) {
+      const SnapshotLevel & recc = header->level[level+1];
+      local_int_t * f2cOperator = new local_int_t[recc.localNumberOfRows];
+      memcpy(f2cOperator, base + rec.offset[SNAP_F2C], rec.length[SNAP_F2C]);
+      MatrixVector_type * rc = new MatrixVector_type;
+      MatrixVector_type * xc = new MatrixVector_type;
+      MatrixVector_type * Axf = new MatrixVector_type;
+      InitializeVector(*rc, recc.localNumberOfRows, comm);
+      InitializeVector(*xc, recc.localNumberOfColumns, comm);
+      InitializeVector(*Axf, rec.localNumberOfColumns, comm);
+      MGData_type * mgData = new MGData_type;
+      InitializeMGData(f2cOperator, rc, xc, Axf, *mgData);
+      cur->mgData = mgData;
+      cur->Ac = new SparseMatrix_type;
+      cur = cur->Ac;
+    }
+  }
+  A.snapshotLength = header->fileLength;
+
+  if (init_vect) {
+    local_int_t nrow = A.localNumberOfRows;
+    Vector_type * vectors[3] = {b, x, xexact};
+    for (int i=0; i<3; ++i) {
+      InitializeVector(*vectors[i], nrow, comm);
+      memcpy(vectors[i]->values, base + header->vectorOffset[i], nrow*sizeof(vector_scalar_type));
+    }
+  }
+  delete header;
+
+  if (geom->rank==0) HPGMP_fout << "Problem snapshot mapped from " << fname << " in " << mytimer() - t0 << " seconds." << endl;
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+// uniform
+template
+int WriteProblemSnapshot< SparseMatrix<double>, Vector<double> >(int, SparseMatrix<double> const&, Vector<double> const*, Vector<double> const*, Vector<double> const*, bool);
+
+template
+int WriteProblemSnapshot< SparseMatrix<float>, Vector<float> >(int, SparseMatrix<float> const&, Vector<float> const*, Vector<float> const*, Vector<float> const*, bool);
+
+template
+int ReadProblemSnapshot< SparseMatrix<double>, Vector<double> >(int, SparseMatrix<double>&, Geometry*, Vector<double>*, Vector<double>*, Vector<double>*, bool, comm_type);
+
+template
+int ReadProblemSnapshot< SparseMatrix<float>, Vector<float> >(int, SparseMatrix<float>&, Geometry*, Vector<float>*, Vector<float>*, Vector<float>*, bool, comm_type);
+
+
+// mixed
+template
+int WriteProblemSnapshot< SparseMatrix<float>, Vector<double> >(int, SparseMatrix<float> const&, Vector<double> const*, Vector<double> const*, Vector<double> const*, bool);
+
+template
+int ReadProblemSnapshot< SparseMatrix<float>, Vector<double> >(int, SparseMatrix<float>&, Geometry*, Vector<double>*, Vector<double>*, Vector<double>*, bool, comm_type);
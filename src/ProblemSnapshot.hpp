@@ -0,0 +1,32 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+#ifndef PROBLEMSNAPSHOT_HPP
+#define PROBLEMSNAPSHOT_HPP
+#include "hpgmp.hpp"
+#include "Geometry.hpp"
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+
+template<class SparseMatrix_type, class Vector_type>
+int WriteProblemSnapshot(int numberOfMgLevels, const SparseMatrix_type & A,
+                         const Vector_type * b, const Vector_type * x, const Vector_type * xexact, bool init_vect);
+
+template<class SparseMatrix_type, class Vector_type>
+int ReadProblemSnapshot(int numberOfMgLevels, SparseMatrix_type & A, Geometry * geom,
+                        Vector_type * b, Vector_type * x, Vector_type * xexact, bool init_vect, comm_type comm);
+
+#endif // PROBLEMSNAPSHOT_HPP
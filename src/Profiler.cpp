@@ -0,0 +1,404 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file Profiler.cpp
+
+ HPGMP routines of the hierarchical region profiler
+ */
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Profiler.hpp"
+#include "TrafficModel.hpp"
+#include "mytimer.hpp"
+
+const int HPGMP_PROFILE_CALLS = 0;     //!< index of the number of calls in the values of a region
+const int HPGMP_PROFILE_INCLUSIVE = 1; //!< index of the inclusive time
+const int HPGMP_PROFILE_EXCLUSIVE = 2; //!< index of the exclusive time
+const int HPGMP_PROFILE_BYTES = 3;     //!< index of the bytes moved
+const int HPGMP_PROFILE_FLOPS = 4;     //!< index of the floating-point operations
+const int HPGMP_PROFILE_COUNTERS = 5;  //!< index of the first hardware counter (see PerfCounters.hpp)
+const int HPGMP_PROFILE_VALUES = HPGMP_PROFILE_COUNTERS + HPGMP_PERF_COUNTERS; //!< number of values of a region
+
+/*!
+  Region recorded by this process; region 0 is the root of the tree, which is never timed.
+ */
+struct ProfileRegion {
+  std::string name;          //!< name of the region, with its level if it has one
+  int parent;                //!< parent region
+  std::vector<int> children; //!< child regions, in the order they were first entered
+  double values[HPGMP_PROFILE_VALUES]; //!< calls, times, bytes, flops and counters, with the time spent in the children in place of the exclusive time
+};
+
+/*!
+  Region of the tree merged over the processes by CollectProfile.
+ */
+struct ProfileSummary {
+  std::string name;          //!< name of the region
+  int parent;                //!< parent region, or -1 for a region at the top of the tree
+  std::vector<int> children; //!< child regions
+  double minimum[HPGMP_PROFILE_VALUES]; //!< minimum over the processes (0 on processes without the region)
+  double maximum[HPGMP_PROFILE_VALUES]; //!< maximum over the processes
+  double sum[HPGMP_PROFILE_VALUES];     //!< sum over the processes
+};
+
+const double HPGMP_CACHE_LINE_SIZE = 64.0; //!< bytes moved from memory by a last level cache miss
+
+static bool profilerEnabled = false; //!< whether the scopes are recorded
+static std::vector<ProfileRegion> regions(1); //!< regions recorded by this process
+static int currentRegion = 0; //!< innermost region open
+static std::vector<ProfileSummary> summary; //!< regions merged by CollectProfile (process 0)
+static int numberOfProcesses = 1; //!< number of processes merged by CollectProfile
+
+ProfileScope::ProfileScope(const char * name, int level, double bytes, double flops) : region(-1), start(0.0) {
+  if (!profilerEnabled) return;
+#ifndef HPGMP_NO_OPENMP
+  if (omp_in_parallel()) return; // The tree is not shared between the threads
+#endif
+  std::string key(name);
+  if (level>=0) {
+    std::ostringstream levelName;
+    levelName << name << " " << level;
+    key = levelName.str();
+  }
+  int child = -1;
+  const std::vector<int> & children = regions[currentRegion].children;
+  for (size_t i=0; i<children.size() && child<0; ++i)
+    if (regions[children[i]].name==key) child = children[i];
+  if (child<0) {
+    child = regions.size();
+    regions.push_back(ProfileRegion());
+    regions[child].name = key;
+    regions[child].parent = currentRegion;
+    for (int i=0; i<HPGMP_PROFILE_VALUES; ++i) regions[child].values[i] = 0.0;
+    regions[currentRegion].children.push_back(child);
+  }
+  regions[child].values[HPGMP_PROFILE_CALLS] += 1.0;
+  regions[child].values[HPGMP_PROFILE_BYTES] += bytes;
+  regions[child].values[HPGMP_PROFILE_FLOPS] += flops;
+  currentRegion = region = child;
+  fence();
+  ReadPerfCounters(counters);
+  start = mytimer();
+}
+
+ProfileScope::~ProfileScope() {
+  if (region<0) return;
+  fence(); double time = mytimer() - start;
+  double counts[HPGMP_PERF_COUNTERS];
+  if (ReadPerfCounters(counts))
+    for (int i=0; i<HPGMP_PERF_COUNTERS; ++i) regions[region].values[HPGMP_PROFILE_COUNTERS+i] += counts[i] - counters[i];
+  regions[region].values[HPGMP_PROFILE_INCLUSIVE] += time;
+  currentRegion = regions[region].parent;
+  regions[currentRegion].values[HPGMP_PROFILE_EXCLUSIVE] += time;
+}
+
+/*!
+  Starts or stops the recording of the scopes.  Regions still open when the profiler is disabled
+  are closed normally.
+ */
+void EnableProfiler(bool enable) {
+  profilerEnabled = enable;
+  return;
+}
+
+/*!
+  Discards the regions recorded by this process.  No region may be open.
+ */
+void ResetProfiler() {
+  regions.assign(1, ProfileRegion());
+  regions[0].parent = 0;
+  for (int i=0; i<HPGMP_PROFILE_VALUES; ++i) regions[0].values[i] = 0.0;
+  currentRegion = 0;
+  return;
+}
+
+/*!
+  Merges the trees recorded by the processes of comm, on process 0, for ReportProfile: the regions
+  are identified by their path from the root, and their values reduced to their minimum, maximum and
+  sum over the processes.  Collective on comm.
+
+  @param[in] comm the communicator of the processes that recorded the regions
+ */
+void CollectProfile(comm_type comm) {
+  // Paths of the regions of this process, whose parents come first
+  std::vector<std::string> paths(regions.size());
+  std::string localPaths;
+  for (size_t i=1; i<regions.size(); ++i) {
+    paths[i] = paths[regions[i].parent] + "/" + regions[i].name;
+    localPaths += paths[i] + "\n";
+  }
+
+  // Union of the paths of all processes, in the order of process 0 followed by the new ones
+  int rank = 0;
+  numberOfProcesses = 1;
+  std::string allPaths = localPaths;
+#ifndef HPGMP_NO_MPI
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &numberOfProcesses);
+  int length = localPaths.size();
+  std::vector<int> lengths(numberOfProcesses), displacements(numberOfProcesses+1, 0);
+  MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, comm);
+  for (int i=0; i<numberOfProcesses; ++i) displacements[i+1] = displacements[i] + lengths[i];
+  std::vector<char> gatheredPaths(rank==0 ? displacements[numberOfProcesses]+1 : 1);
+  MPI_Gatherv(const_cast<char *>(localPaths.data()), length, MPI_CHAR,
+              gatheredPaths.data(), lengths.data(), displacements.data(), MPI_CHAR, 0, comm);
+  if (rank==0) allPaths.assign(gatheredPaths.begin(), gatheredPaths.begin() + displacements[numberOfProcesses]);
+#else
+  (void) comm;
+#endif
+  std::vector<std::string> unionPaths;
+  std::map<std::string, int> unionIndex;
+  {
+    std::istringstream lines(allPaths);
+    std::string path;
+    while (std::getline(lines, path))
+      if (unionIndex.find(path)==unionIndex.end()) {
+        unionIndex[path] = unionPaths.size();
+        unionPaths.push_back(path);
+      }
+  }
+#ifndef HPGMP_NO_MPI
+  std::string mergedPaths;
+  for (size_t i=0; i<unionPaths.size(); ++i) mergedPaths += unionPaths[i] + "\n";
+  length = mergedPaths.size();
+  MPI_Bcast(&length, 1, MPI_INT, 0, comm);
+  std::vector<char> broadcastPaths(mergedPaths.begin(), mergedPaths.end());
+  broadcastPaths.resize(length+1);
+  MPI_Bcast(broadcastPaths.data(), length, MPI_CHAR, 0, comm);
+  if (rank!=0) {
+    unionPaths.clear();
+    unionIndex.clear();
+    std::istringstream lines(std::string(broadcastPaths.begin(), broadcastPaths.begin() + length));
+    std::string path;
+    while (std::getline(lines, path)) {
+      unionIndex[path] = unionPaths.size();
+      unionPaths.push_back(path);
+    }
+  }
+#endif
+
+  // Values of this process on the merged tree, and their reductions
+  const int numberOfRegions = unionPaths.size();
+  std::vector<double> values(numberOfRegions*HPGMP_PROFILE_VALUES, 0.0);
+  for (size_t i=1; i<regions.size(); ++i) {
+    double * v = values.data() + unionIndex[paths[i]]*HPGMP_PROFILE_VALUES;
+    for (int j=0; j<HPGMP_PROFILE_VALUES; ++j) v[j] = regions[i].values[j];
+    v[HPGMP_PROFILE_EXCLUSIVE] = v[HPGMP_PROFILE_INCLUSIVE] - regions[i].values[HPGMP_PROFILE_EXCLUSIVE];
+  }
+  std::vector<double> minimum(values), maximum(values), sum(values);
+#ifndef HPGMP_NO_MPI
+  MPI_Reduce(values.data(), minimum.data(), values.size(), MPI_DOUBLE, MPI_MIN, 0, comm);
+  MPI_Reduce(values.data(), maximum.data(), values.size(), MPI_DOUBLE, MPI_MAX, 0, comm);
+  MPI_Reduce(values.data(), sum.data(), values.size(), MPI_DOUBLE, MPI_SUM, 0, comm);
+#endif
+
+  summary.clear();
+  if (rank!=0) return;
+  summary.resize(numberOfRegions);
+  for (int i=0; i<numberOfRegions; ++i) {
+    const std::string & path = unionPaths[i];
+    size_t separator = path.rfind('/');
+    ProfileSummary & s = summary[i];
+    s.name = path.substr(separator+1);
+    s.parent = separator==0 ? -1 : unionIndex[path.substr(0, separator)];
+    if (s.parent>=0) summary[s.parent].children.push_back(i);
+    for (int j=0; j<HPGMP_PROFILE_VALUES; ++j) {
+      s.minimum[j] = minimum[i*HPGMP_PROFILE_VALUES+j];
+      s.maximum[j] = maximum[i*HPGMP_PROFILE_VALUES+j];
+      s.sum[j] = sum[i*HPGMP_PROFILE_VALUES+j];
+    }
+  }
+  return;
+}
+
+/*!
+  Adds a region merged by CollectProfile and its children to element.
+ */
+static void ReportProfileRegion(OutputFile * element, int region) {
+  const ProfileSummary & s = summary[region];
+  element->add(s.name, "");
+  OutputFile * e = element->get(s.name);
+  e->add("Calls", s.sum[HPGMP_PROFILE_CALLS]/numberOfProcesses);
+  e->add("Inclusive Time Avg", s.sum[HPGMP_PROFILE_INCLUSIVE]/numberOfProcesses);
+  e->add("Inclusive Time Min", s.minimum[HPGMP_PROFILE_INCLUSIVE]);
+  e->add("Inclusive Time Max", s.maximum[HPGMP_PROFILE_INCLUSIVE]);
+  e->add("Exclusive Time Avg", s.sum[HPGMP_PROFILE_EXCLUSIVE]/numberOfProcesses);
+  e->add("Exclusive Time Min", s.minimum[HPGMP_PROFILE_EXCLUSIVE]);
+  e->add("Exclusive Time Max", s.maximum[HPGMP_PROFILE_EXCLUSIVE]);
+  // Rates of all processes together, over the time of the slowest one
+  const double time = s.maximum[HPGMP_PROFILE_INCLUSIVE];
+  if (s.sum[HPGMP_PROFILE_BYTES]>0.0) {
+    e->add("Bytes Avg", s.sum[HPGMP_PROFILE_BYTES]/numberOfProcesses);
+    if (time>0.0) e->add("GB/s", s.sum[HPGMP_PROFILE_BYTES]/time/1.0e9);
+  }
+  if (s.sum[HPGMP_PROFILE_FLOPS]>0.0) {
+    e->add("Flops Avg", s.sum[HPGMP_PROFILE_FLOPS]/numberOfProcesses);
+    if (time>0.0) e->add("GFLOP/s", s.sum[HPGMP_PROFILE_FLOPS]/time/1.0e9);
+  }
+  // Hardware counters, summed over the threads and processes: bytes per cycle of one core
+  const double cycles = s.sum[HPGMP_PROFILE_COUNTERS+HPGMP_PERF_CYCLES];
+  if (PerfCountersAvailable() && cycles>0.0) {
+    const double instructions = s.sum[HPGMP_PROFILE_COUNTERS+HPGMP_PERF_INSTRUCTIONS];
+    e->add("Cycles Avg", cycles/numberOfProcesses);
+    e->add("Instructions Avg", instructions/numberOfProcesses);
+    e->add("IPC", instructions/cycles);
+    if (s.sum[HPGMP_PROFILE_BYTES]>0.0) e->add("Bytes/Cycle", s.sum[HPGMP_PROFILE_BYTES]/cycles);
+    if (PerfCounterAvailable(HPGMP_PERF_LLC_MISSES)) {
+      const double misses = s.sum[HPGMP_PROFILE_COUNTERS+HPGMP_PERF_LLC_MISSES];
+      e->add("LLC Misses Avg", misses/numberOfProcesses);
+      e->add("LLC Miss Bytes/Cycle", misses*HPGMP_CACHE_LINE_SIZE/cycles); // Memory traffic proxy
+    }
+  }
+  for (size_t i=0; i<s.children.size(); ++i) ReportProfileRegion(e, s.children[i]);
+  return;
+}
+
+/*!
+  Adds the tree of regions merged by CollectProfile to element, on process 0: for each region, its
+  average number of calls, the average, minimum and maximum over the processes of its inclusive and
+  exclusive times, the bytes and flops it was given with their rates, and, if the hardware counters
+  are in use, its instructions per cycle, its modeled bytes per cycle and the bytes of its last level
+  cache misses per cycle.
+
+  @param[inout] element the element of the report holding the profile
+ */
+void ReportProfile(OutputFile * element) {
+  element->add("Number of Processes", numberOfProcesses);
+  for (size_t i=0; i<summary.size(); ++i)
+    if (summary[i].parent<0) ReportProfileRegion(element, i);
+  return;
+}
+
+/*!
+  Bytes, flops and time of the regions of a kernel or of a multigrid level, for ReportRoofline.
+ */
+struct RooflineEntry {
+  std::string name; //!< name of the kernel or level
+  double bytes;     //!< bytes moved by all processes
+  double flops;     //!< floating-point operations of all processes
+  double time;      //!< time of the slowest process, summed over the regions
+};
+
+/*!
+  Adds the bytes, flops and time of a region to the entry of the given name, created if needed.
+ */
+static void AddRooflineEntry(std::vector<RooflineEntry> & entries, const std::string & name, double bytes, double flops, double time) {
+  size_t i = 0;
+  while (i<entries.size() && entries[i].name!=name) ++i;
+  if (i==entries.size()) {
+    RooflineEntry entry = {name, 0.0, 0.0, 0.0};
+    entries.push_back(entry);
+  }
+  entries[i].bytes += bytes;
+  entries[i].flops += flops;
+  entries[i].time += time;
+  return;
+}
+
+/*!
+  Adds the bytes and flops of the regions below the given one to those of its level, down to the
+  regions of the coarser levels, whose time is subtracted from that of the level.
+ */
+static void AddLevelRegions(int region, double & bytes, double & flops, double & time) {
+  const std::vector<int> & children = summary[region].children;
+  for (size_t i=0; i<children.size(); ++i) {
+    const ProfileSummary & s = summary[children[i]];
+    if (s.name.compare(0, 6, "Level ")==0) {
+      time -= s.maximum[HPGMP_PROFILE_INCLUSIVE];
+      continue;
+    }
+    bytes += s.sum[HPGMP_PROFILE_BYTES];
+    flops += s.sum[HPGMP_PROFILE_FLOPS];
+    AddLevelRegions(children[i], bytes, flops, time);
+  }
+  return;
+}
+
+/*!
+  Adds the rates of the entries to element, against the bandwidth of the STREAM triad if it was measured.
+ */
+static void ReportRooflineEntries(OutputFile * element, const std::vector<RooflineEntry> & entries) {
+  const double stream = StreamTriadBandwidth();
+  for (size_t i=0; i<entries.size(); ++i) {
+    const RooflineEntry & entry = entries[i];
+    if (entry.bytes<=0.0 || entry.time<=0.0) continue;
+    element->add(entry.name, "");
+    OutputFile * e = element->get(entry.name);
+    const double bandwidth = entry.bytes/entry.time/1.0e9;
+    e->add("Bytes Avg", entry.bytes/numberOfProcesses);
+    e->add("Time", entry.time);
+    e->add("GB/s", bandwidth);
+    if (stream>0.0) e->add("% of STREAM Triad", 100.0*bandwidth/stream);
+    if (entry.flops>0.0) {
+      // The bandwidth bound of the roofline, below the peak of the cores for these arithmetic intensities
+      e->add("Flops/Byte", entry.flops/entry.bytes);
+      e->add("GFLOP/s", entry.flops/entry.time/1.0e9);
+      if (stream>0.0) e->add("Roofline GFLOP/s", entry.flops/entry.bytes*stream);
+    }
+  }
+  return;
+}
+
+/*!
+  Adds the achieved bandwidth of each kernel and of each multigrid level to element, on process 0,
+  from the modeled bytes of the regions merged by CollectProfile (see TrafficModel.hpp), with its
+  percentage of the bandwidth of the STREAM triad (see SetupStreamTriad), the roofline of kernels of
+  such low arithmetic intensity, and the bound it puts on their GFLOP/s.
+
+  A kernel gathers the regions of its name over the tree, timed without their child regions (the
+  halo exchanges, whose bytes are counted in their own entry).  A level gathers the regions below
+  those of its name, timed without its coarser levels.  The times are those of the slowest process.
+
+  @param[inout] element the element of the report holding the rates
+ */
+void ReportRoofline(OutputFile * element) {
+  std::vector<RooflineEntry> kernels, levels;
+  for (size_t i=0; i<summary.size(); ++i) {
+    const ProfileSummary & s = summary[i];
+    if (s.sum[HPGMP_PROFILE_BYTES]>0.0)
+      AddRooflineEntry(kernels, s.name, s.sum[HPGMP_PROFILE_BYTES], s.sum[HPGMP_PROFILE_FLOPS], s.maximum[HPGMP_PROFILE_EXCLUSIVE]);
+    if (s.name.compare(0, 6, "Level ")==0) {
+      double bytes = 0.0, flops = 0.0, time = s.maximum[HPGMP_PROFILE_INCLUSIVE];
+      AddLevelRegions(i, bytes, flops, time);
+      AddRooflineEntry(levels, s.name, bytes, flops, time);
+    }
+  }
+  const double stream = StreamTriadBandwidth();
+  if (stream>0.0) {
+    element->add("STREAM Triad GB/s", stream);
+    element->add("STREAM Triad Array Size (MB)", StreamTriadArraySize());
+  } else {
+    element->add("STREAM Triad GB/s", "Not measured");
+  }
+  element->add("Kernels", "");
+  ReportRooflineEntries(element->get("Kernels"), kernels);
+  element->add("Multigrid Levels", "");
+  ReportRooflineEntries(element->get("Multigrid Levels"), levels);
+  return;
+}
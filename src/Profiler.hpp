@@ -0,0 +1,62 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file Profiler.hpp
+
+ HPGMP data structure and routines of the hierarchical region profiler
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include "hpgmp.hpp"
+#include "OutputFile.hpp"
+#include "PerfCounters.hpp"
+
+/*!
+  Scoped timer of a named region of the benchmark, recorded in a tree keyed by the enclosing
+  regions: the region opened by a ProfileScope is the child of the innermost one still open.
+
+  Each region counts its calls, its inclusive time (the time between the construction and the
+  destruction of the scope, taken with mytimer after a fence like TICK and TOCK), its exclusive
+  time (the inclusive time not spent in its child regions), and the bytes and flops of the kernel
+  it times, if the caller models them, and the hardware counters of the threads while it runs, if
+  they are in use (see SetupPerfCounters).  The same name may be opened on several multigrid levels:
+  a region with a level is distinct from the same name on other levels.
+
+  Scopes are only recorded while the profiler is enabled (see EnableProfiler), and never inside
+  an OpenMP parallel region, so that a disabled profiler costs one test per scope.
+ */
+class ProfileScope {
+public:
+  ProfileScope(const char * name, int level = -1, double bytes = 0.0, double flops = 0.0);
+  ~ProfileScope();
+private:
+  int region;   //!< region recorded, or -1 if the scope is not recorded
+  double start; //!< time at which the region was entered
+  double counters[HPGMP_PERF_COUNTERS]; //!< hardware counters when the region was entered
+  ProfileScope(const ProfileScope &);
+  ProfileScope & operator=(const ProfileScope &);
+};
+
+void EnableProfiler(bool enable);
+void ResetProfiler();
+void CollectProfile(comm_type comm);
+void ReportProfile(OutputFile * element);
+void ReportRoofline(OutputFile * element);
+
+#endif // PROFILER_HPP
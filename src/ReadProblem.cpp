@@ -0,0 +1,546 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ReadProblem.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <vector>
+#include "ReadProblem.hpp"
+#include "WriteProblem.hpp"
+#include "ParallelFile.hpp"
+
+/*!
+  Converts values stored with valueSize bytes each (4 or 8) to the scalar type T.
+ */
+template<class T>
+static void ConvertValues(const std::vector<char> & raw, long long valueSize, T * out, long long count) {
+  if (valueSize==(long long) sizeof(double)) {
+    const double * in = (const double *) raw.data();
+    for (long long i=0; i<count; ++i) out[i] = (T) in[i];
+  } else {
+    const float * in = (const float *) raw.data();
+    for (long long i=0; i<count; ++i) out[i] = (T) in[i];
+  }
+}
+
+/*!
+  Describes a contiguous block of rows of a matrix without grid structure as a one-dimensional geometry,
+  so that code that only reports sizes and ranks keeps working.  Ownership of rows by processes is given by
+  the row partition of the matrix, not by this geometry.
+ */
+static void GenerateRowBlockGeometry(int size, int rank, global_int_t numberOfRows, global_int_t firstRow,
+                                     local_int_t localNumberOfRows, Geometry * geom) {
+  geom->size = size;
+  geom->rank = rank;
+#ifdef HPGMP_NO_OPENMP
+  geom->numThreads = 1;
+#else
+  geom->numThreads = omp_get_max_threads();
+#endif
+  geom->nx = localNumberOfRows;
+  geom->ny = 1;
+  geom->nz = 1;
+  geom->npx = size;
+  geom->npy = 1;
+  geom->npz = 1;
+  geom->pz = 0;
+  geom->npartz = 1;
+  geom->partz_ids = new int[1];
+  geom->partz_nz = new local_int_t[1];
+  geom->partz_ids[0] = 1;
+  geom->partz_nz[0] = 1;
+  geom->ipx = rank;
+  geom->ipy = 0;
+  geom->ipz = 0;
+  geom->gnx = numberOfRows;
+  geom->gny = 1;
+  geom->gnz = 1;
+  geom->gix0 = firstRow;
+  geom->giy0 = 0;
+  geom->giz0 = 0;
+  return;
+}
+
+/*!
+  Fills A with a block of rows given in CSR form with global column indices, and sets up the row
+  partition of A.  SetupHalo must be called afterwards.
+
+  @param[inout] A                  Initialized matrix whose geometry is overwritten with a row-block geometry
+  @param[in]    numberOfRows       Global number of rows
+  @param[in]    firstRow           Global index of the first local row
+  @param[in]    localNumberOfRows  Number of local rows
+  @param[in]    rowPointers        Offsets of the rows in columns and values (localNumberOfRows+1 entries, starting at 0)
+  @param[in]    columns            Global column indices
+  @param[in]    values             Matrix values
+
+  @return Returns zero on success on all processes, and a non-zero value on all processes if any row
+          has more than 127 nonzeros or no diagonal entry.
+ */
+template<class SparseMatrix_type>
+int BuildRowBlockMatrix(SparseMatrix_type & A, global_int_t numberOfRows, global_int_t firstRow, local_int_t localNumberOfRows,
+                        const std::vector<long long> & rowPointers, const std::vector<long long> & columns,
+                        const std::vector<typename SparseMatrix_type::scalar_type> & values) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+
+  int rank = 0, size = 1;
+#ifndef HPGMP_NO_MPI
+  MPI_Comm_rank(A.comm, &rank);
+  MPI_Comm_size(A.comm, &size);
+#endif
+
+  // Rows are limited by the char nonzero counts, and every row needs a diagonal for the smoothers
+  int ierr = 0;
+  int maxNonzerosPerRow = 0;
+  for (local_int_t i=0; i<localNumberOfRows; ++i) {
+    long long nnz = rowPointers[i+1] - rowPointers[i];
+    if (nnz>127) { ierr = 1; break; }
+    if (nnz>maxNonzerosPerRow) maxNonzerosPerRow = nnz;
+    bool hasDiagonal = false;
+    for (long long k=rowPointers[i]; k<rowPointers[i+1]; ++k)
+      if (columns[k]==firstRow+i) hasDiagonal = true;
+    if (!hasDiagonal) { ierr = 2; break; }
+  }
+#ifndef HPGMP_NO_MPI
+  int localErr = ierr;
+  MPI_Allreduce(&localErr, &ierr, 1, MPI_INT, MPI_MAX, A.comm);
+#endif
+  if (ierr) return ierr;
+
+  char * nonzerosInRow = new char[localNumberOfRows];
+  global_int_t ** mtxIndG = new global_int_t*[localNumberOfRows];
+  local_int_t  ** mtxIndL = new local_int_t*[localNumberOfRows];
+  scalar_type ** matrixValues = new scalar_type*[localNumberOfRows];
+  scalar_type ** matrixDiagonal = new scalar_type*[localNumberOfRows];
+
+#ifndef HPGMP_CONTIGUOUS_ARRAYS
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (local_int_t i=0; i< localNumberOfRows; ++i) {
+    int nnz = rowPointers[i+1] - rowPointers[i];
+    mtxIndL[i] = new local_int_t[nnz];
+    matrixValues[i] = new scalar_type[nnz];
+    mtxIndG[i] = new global_int_t[nnz];
+  }
+#else
+  const size_t numberOfEntries = ((size_t) localNumberOfRows) * maxNonzerosPerRow;
+  mtxIndL[0] = AllocateArray<local_int_t>(numberOfEntries);
+  matrixValues[0] = AllocateArray<scalar_type>(numberOfEntries);
+  mtxIndG[0] = AllocateArray<global_int_t>(numberOfEntries);
+  FirstTouchArray(mtxIndL[0], numberOfEntries);
+  FirstTouchArray(matrixValues[0], numberOfEntries);
+  FirstTouchArray(mtxIndG[0], numberOfEntries);
+  for (local_int_t i=1; i< localNumberOfRows; ++i) {
+    mtxIndL[i] = mtxIndL[0] + i * maxNonzerosPerRow;
+    matrixValues[i] = matrixValues[0] + i * maxNonzerosPerRow;
+    mtxIndG[i] = mtxIndG[0] + i * maxNonzerosPerRow;
+  }
+#endif
+
+  A.localToGlobalMap.resize(localNumberOfRows);
+  A.globalToLocalMap.clear();
+  for (local_int_t i=0; i<localNumberOfRows; ++i) {
+    int nnz = rowPointers[i+1] - rowPointers[i];
+    nonzerosInRow[i] = nnz;
+    for (int j=0; j<nnz; ++j) {
+      mtxIndG[i][j] = columns[rowPointers[i]+j];
+      matrixValues[i][j] = values[rowPointers[i]+j];
+      if (mtxIndG[i][j]==firstRow+i) matrixDiagonal[i] = matrixValues[i]+j;
+    }
+    A.localToGlobalMap[i] = firstRow+i;
+    A.globalToLocalMap[firstRow+i] = i;
+  }
+
+  global_int_t * rowPartition = new global_int_t[size+1];
+#ifndef HPGMP_NO_MPI
+  long long first = firstRow;
+  std::vector<long long> firstRows(size);
+  MPI_Allgather(&first, 1, MPI_LONG_LONG, firstRows.data(), 1, MPI_LONG_LONG, A.comm);
+  for (int p=0; p<size; ++p) rowPartition[p] = firstRows[p];
+#else
+  rowPartition[0] = 0;
+#endif
+  rowPartition[size] = numberOfRows;
+
+  long long localNumberOfNonzeros = rowPointers[localNumberOfRows], totalNumberOfNonzeros = localNumberOfNonzeros;
+#ifndef HPGMP_NO_MPI
+  MPI_Allreduce(&localNumberOfNonzeros, &totalNumberOfNonzeros, 1, MPI_LONG_LONG, MPI_SUM, A.comm);
+#endif
+
+  GenerateRowBlockGeometry(size, rank, numberOfRows, firstRow, localNumberOfRows, A.geom);
+
+  A.title = 0;
+  A.totalNumberOfRows = numberOfRows;
+  A.totalNumberOfNonzeros = totalNumberOfNonzeros;
+  A.localNumberOfRows = localNumberOfRows;
+  A.localNumberOfColumns = localNumberOfRows;
+  A.localNumberOfNonzeros = localNumberOfNonzeros;
+  A.nonzerosInRow = nonzerosInRow;
+  A.mtxIndG = mtxIndG;
+  A.mtxIndL = mtxIndL;
+  A.matrixValues = matrixValues;
+  A.matrixDiagonal = matrixDiagonal;
+  A.rowPartition = rowPartition;
+  return 0;
+}
+
+/*!
+  Orders the entries of a Matrix Market file, stored as (row, column) pairs, by row and then by column.
+ */
+struct EntryOrder {
+  const std::vector<long long> & indices;
+  EntryOrder(const std::vector<long long> & indices_) : indices(indices_) {}
+  bool operator()(long long k1, long long k2) const {
+    return indices[2*k1]<indices[2*k2] || (indices[2*k1]==indices[2*k2] && indices[2*k1+1]<indices[2*k2+1]);
+  }
+};
+
+/*!
+  Reads a square sparse matrix from a Matrix Market coordinate file (real, integer or pattern;
+  general, symmetric or skew-symmetric).
+
+  Process 0 parses the banner and the size line.  The remaining bytes are split evenly among the
+  processes, each of which reads its range with MPI-IO and parses the lines that start in it;
+  the entries (mirrored for symmetric storage) are then sent to the process owning their row,
+  where duplicates are summed.  The right-hand side is set to the row sums, so that the exact
+  solution is the vector of ones, and the initial guess is zero.
+
+  @return Returns zero on success and a non-zero value otherwise, on all processes.
+ */
+template<class SparseMatrix_type, class Vector_type>
+static int ReadMatrixMarketProblem(const char * fname, SparseMatrix_type & A, Vector_type * b, Vector_type * x, Vector_type * xexact, bool init_vect) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+
+  int rank = 0, size = 1;
+#ifndef HPGMP_NO_MPI
+  MPI_Comm_rank(A.comm, &rank);
+  MPI_Comm_size(A.comm, &size);
+#endif
+
+  // status, rows, columns, entries, offset of the first entry, symmetry (0 general, 1 symmetric, 2 skew), pattern
+  long long info[7] = {-1, 0, 0, 0, 0, 0, 0};
+  if (rank==0) {
+    FILE * f = fopen(fname, "r");
+    char line[1024];
+    if (f && fgets(line, sizeof(line), f)) {
+      char banner[64], object[64], format[64], field[64], symmetry[64];
+      if (sscanf(line, "%63s %63s %63s %63s %63s", banner, object, format, field, symmetry)==5 &&
+          strcmp(banner, "%%MatrixMarket")==0 && strcasecmp(object, "matrix")==0 && strcasecmp(format, "coordinate")==0 &&
+          (strcasecmp(field, "real")==0 || strcasecmp(field, "integer")==0 || strcasecmp(field, "pattern")==0)) {
+        info[5] = strcasecmp(symmetry, "general")==0 ? 0 : strcasecmp(symmetry, "symmetric")==0 ? 1 :
+                  strcasecmp(symmetry, "skew-symmetric")==0 ? 2 : -1;
+        info[6] = strcasecmp(field, "pattern")==0;
+        bool continuation = false; // inside a comment line longer than the buffer
+        while (info[5]>=0 && fgets(line, sizeof(line), f)) {
+          bool wholeLine = strchr(line, '\n')!=0;
+          if (continuation || line[0]=='%' || line[strspn(line, " \t\r\n")]=='\0') {
+            continuation = !wholeLine;
+            continue;
+          }
+          if (sscanf(line, "%lld %lld %lld", info+1, info+2, info+3)==3) {
+            info[4] = ftell(f);
+            info[0] = 0;
+          }
+          break;
+        }
+      }
+    }
+    if (f) fclose(f);
+  }
+#ifndef HPGMP_NO_MPI
+  MPI_Bcast(info, 7, MPI_LONG_LONG, 0, A.comm);
+#endif
+  if (info[0] || info[1]<=0 || info[1]!=info[2]) return -1;
+
+  long long numberOfRows = info[1], dataOffset = info[4];
+  int symmetry = info[5];
+  bool pattern = info[6];
+
+  std::vector<long long> firstRows(size+1);
+  for (int p=0; p<=size; ++p) firstRows[p] = (numberOfRows*p)/size;
+
+  ParallelFile_type fh;
+  if (ParallelFileOpen(fname, false, A.comm, fh)) return -1;
+  long long fileSize = ParallelFileSize(fh);
+  long long dataLength = fileSize - dataOffset;
+  long long begin = dataOffset + (dataLength*rank)/size, end = dataOffset + (dataLength*(rank+1))/size;
+
+  // A line belongs to the process whose range holds its first character: one byte before the range is
+  // read to find out whether the range starts a line, and some slack after it to finish the last line
+  const long long slack = 4096;
+  long long readBegin = begin>dataOffset ? begin-1 : begin;
+  long long readEnd = std::min(end+slack, fileSize);
+  std::vector<char> text(readEnd-readBegin+1);
+  int ierr = ParallelFileReadAt(fh, readBegin, text.data(), readEnd-readBegin, A.comm);
+  ierr |= ParallelFileClose(fh);
+  text[readEnd-readBegin] = '\0';
+
+  std::vector<std::vector<long long> > sendIndices(size); // (row, column) pairs, 0-based
+  std::vector<std::vector<double> > sendValues(size);
+  long long localEntries = 0;
+  const char * p = text.data() + (begin-readBegin);
+  const char * stop = text.data() + (end-readBegin);
+  if (begin>dataOffset && p[-1]!='\n') {
+    while (p<stop && *p!='\n') ++p;
+    if (p<stop) ++p;
+  }
+  while (!ierr && p<stop) {
+    const char * next = strchr(p, '\n');
+    if (next==0 && readEnd<fileSize) { ierr = -1; break; } // line longer than the slack
+    next = next ? next+1 : p+strlen(p);
+    const char * q = p + strspn(p, " \t\r");
+    if (*q!='%' && *q!='\n' && *q!='\0') {
+      char * r;
+      long long i = strtoll(q, &r, 10) - 1;
+      long long j = strtoll(r, &r, 10) - 1;
+      double v = pattern ? 1.0 : strtod(r, &r);
+      if (i<0 || i>=numberOfRows || j<0 || j>=numberOfRows) { ierr = -1; break; }
+      int owner = std::upper_bound(firstRows.begin(), firstRows.end(), i) - firstRows.begin() - 1;
+      sendIndices[owner].push_back(i);
+      sendIndices[owner].push_back(j);
+      sendValues[owner].push_back(v);
+      if (symmetry && i!=j) {
+        owner = std::upper_bound(firstRows.begin(), firstRows.end(), j) - firstRows.begin() - 1;
+        sendIndices[owner].push_back(j);
+        sendIndices[owner].push_back(i);
+        sendValues[owner].push_back(symmetry==2 ? -v : v);
+      }
+      ++localEntries;
+    }
+    p = next;
+  }
+
+  long long totalEntries = localEntries;
+#ifndef HPGMP_NO_MPI
+  int localErr = ierr;
+  MPI_Allreduce(&localErr, &ierr, 1, MPI_INT, MPI_MAX, A.comm);
+  MPI_Allreduce(&localEntries, &totalEntries, 1, MPI_LONG_LONG, MPI_SUM, A.comm);
+#endif
+  if (ierr || totalEntries!=info[3]) return -1;
+
+  // Send every entry to the owner of its row
+  std::vector<long long> indices;
+  std::vector<double> entryValues;
+#ifndef HPGMP_NO_MPI
+  std::vector<int> sendCounts(size), recvCounts(size), sendDispls(size), recvDispls(size);
+  std::vector<long long> sendIndexBuffer;
+  std::vector<double> sendValueBuffer;
+  for (int q=0; q<size; ++q) {
+    sendCounts[q] = sendValues[q].size();
+    sendDispls[q] = sendValueBuffer.size();
+    sendIndexBuffer.insert(sendIndexBuffer.end(), sendIndices[q].begin(), sendIndices[q].end());
+    sendValueBuffer.insert(sendValueBuffer.end(), sendValues[q].begin(), sendValues[q].end());
+  }
+  MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, A.comm);
+  int received = 0;
+  for (int q=0; q<size; ++q) {
+    recvDispls[q] = received;
+    received += recvCounts[q];
+  }
+  entryValues.resize(received);
+  MPI_Alltoallv(sendValueBuffer.data(), sendCounts.data(), sendDispls.data(), MPI_DOUBLE,
+                entryValues.data(), recvCounts.data(), recvDispls.data(), MPI_DOUBLE, A.comm);
+  for (int q=0; q<size; ++q) {
+    sendCounts[q] *= 2; sendDispls[q] *= 2;
+    recvCounts[q] *= 2; recvDispls[q] *= 2;
+  }
+  indices.resize(2*received);
+  MPI_Alltoallv(sendIndexBuffer.data(), sendCounts.data(), sendDispls.data(), MPI_LONG_LONG,
+                indices.data(), recvCounts.data(), recvDispls.data(), MPI_LONG_LONG, A.comm);
+#else
+  indices.swap(sendIndices[0]);
+  entryValues.swap(sendValues[0]);
+#endif
+
+  // Sort by (row, column) and sum duplicates
+  long long numberOfEntries = entryValues.size();
+  std::vector<long long> order(numberOfEntries);
+  for (long long k=0; k<numberOfEntries; ++k) order[k] = k;
+  std::sort(order.begin(), order.end(), EntryOrder(indices));
+
+  long long firstRow = firstRows[rank];
+  local_int_t localNumberOfRows = firstRows[rank+1] - firstRow;
+  std::vector<long long> rowPointers(localNumberOfRows+1, 0), columns;
+  std::vector<double> sums;
+  columns.reserve(numberOfEntries);
+  sums.reserve(numberOfEntries);
+  for (long long k=0; k<numberOfEntries; ++k) {
+    long long i = indices[2*order[k]], j = indices[2*order[k]+1];
+    if (k>0 && i==indices[2*order[k-1]] && j==indices[2*order[k-1]+1]) {
+      sums.back() += entryValues[order[k]];
+    } else {
+      columns.push_back(j);
+      sums.push_back(entryValues[order[k]]);
+      ++rowPointers[i-firstRow+1];
+    }
+  }
+  for (local_int_t i=0; i<localNumberOfRows; ++i) rowPointers[i+1] += rowPointers[i];
+  std::vector<scalar_type> values(sums.begin(), sums.end());
+
+  if (init_vect) {
+    InitializeVector(*b, localNumberOfRows, A.comm);
+    InitializeVector(*x, localNumberOfRows, A.comm);
+    InitializeVector(*xexact, localNumberOfRows, A.comm);
+    for (local_int_t i=0; i<localNumberOfRows; ++i) {
+      double sum = 0.0;
+      for (long long k=rowPointers[i]; k<rowPointers[i+1]; ++k) sum += sums[k];
+      b->values[i] = sum;
+      x->values[i] = 0.0;
+      xexact->values[i] = 1.0;
+    }
+  }
+
+  return BuildRowBlockMatrix(A, numberOfRows, firstRow, localNumberOfRows, rowPointers, columns, values);
+}
+
+/*!
+  Reads a linear system written by WriteProblem in the binary CSR format, or a matrix in the
+  Matrix Market coordinate format (recognized by its banner, see ReadMatrixMarketProblem).
+
+  The rows are split into contiguous, evenly sized blocks, and each process collectively reads
+  its block of row pointers, column indices and values with MPI-IO.  The number of processes
+  does not need to match the number that wrote the file.  Values are converted to the precision
+  of A and of the vectors.
+
+  A must have been initialized with InitializeSparseMatrix; its geometry is overwritten with a
+  one-dimensional row-block geometry (any arrays it held are not freed), and its row partition
+  is set so that SetupHalo determines the halo from column ownership.  SetupHalo must be
+  called afterwards, as for GenerateNonsymProblem.
+
+  @param[in]    fname  The name of the file
+  @param[inout] A      The matrix to read
+  @param[out]   b, x, xexact Newly allocated vectors read from the file (if init_vect is true)
+  @param[in]    init_vect True if the vectors should be read
+
+  @return Returns zero on success and a non-zero value otherwise, on all processes.
+
+  @see WriteProblem
+*/
+template<class SparseMatrix_type, class Vector_type>
+int ReadProblem(const char * fname, SparseMatrix_type & A, Vector_type * b, Vector_type * x, Vector_type * xexact, bool init_vect) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+
+  int rank = 0, size = 1;
+#ifndef HPGMP_NO_MPI
+  MPI_Comm_rank(A.comm, &rank);
+  MPI_Comm_size(A.comm, &size);
+#endif
+
+  ParallelFile_type fh;
+  if (ParallelFileOpen(fname, false, A.comm, fh)) return -1;
+
+  ProblemFileHeader header;
+  memset(&header, 0, sizeof(header));
+  int ierr = ParallelFileReadAt(fh, 0, &header, sizeof(header), A.comm);
+  if (memcmp(header.magic, "%%Matrix", 8)==0) {
+    ParallelFileClose(fh);
+    return ReadMatrixMarketProblem(fname, A, b, x, xexact, init_vect);
+  }
+  if (ierr || memcmp(header.magic, "HPGMPCSR", 8) || header.version!=1 || header.numberOfRows<=0 ||
+      (header.valueSize!=4 && header.valueSize!=8) || (header.vectorValueSize!=4 && header.vectorValueSize!=8) ||
+      (init_vect && header.numberOfVectors<3)) {
+    ParallelFileClose(fh);
+    return -1;
+  }
+
+  long long numberOfRows = header.numberOfRows, numberOfNonzeros = header.numberOfNonzeros;
+  long long firstRow = (numberOfRows*rank)/size;
+  local_int_t localNumberOfRows = (numberOfRows*(rank+1))/size - firstRow;
+
+  long long rowPointerBase = sizeof(ProblemFileHeader);
+  long long columnBase = rowPointerBase + (numberOfRows+1)*sizeof(long long);
+  long long valueBase = columnBase + numberOfNonzeros*sizeof(long long);
+  long long rowIdBase = valueBase + numberOfNonzeros*header.valueSize;
+  long long vectorBase = rowIdBase + numberOfRows*sizeof(long long);
+
+  std::vector<long long> rowPointers(localNumberOfRows+1);
+  ierr |= ParallelFileReadAt(fh, rowPointerBase + firstRow*sizeof(long long), rowPointers.data(),
+                             (localNumberOfRows+1)*sizeof(long long), A.comm);
+  long long firstNonzero = rowPointers[0];
+  long long localNumberOfNonzeros = rowPointers[localNumberOfRows] - firstNonzero;
+  for (local_int_t i=0; i<=localNumberOfRows; ++i) rowPointers[i] -= firstNonzero;
+
+  std::vector<long long> columns(localNumberOfNonzeros);
+  ierr |= ParallelFileReadAt(fh, columnBase + firstNonzero*sizeof(long long), columns.data(),
+                             localNumberOfNonzeros*sizeof(long long), A.comm);
+  std::vector<char> raw(localNumberOfNonzeros*header.valueSize);
+  ierr |= ParallelFileReadAt(fh, valueBase + firstNonzero*header.valueSize, raw.data(),
+                             localNumberOfNonzeros*header.valueSize, A.comm);
+  std::vector<scalar_type> values(localNumberOfNonzeros);
+  ConvertValues(raw, header.valueSize, values.data(), localNumberOfNonzeros);
+
+  if (init_vect) {
+    Vector_type * vectors[3] = {b, x, xexact};
+    raw.resize(localNumberOfRows*header.vectorValueSize);
+    for (int k=0; k<3; ++k) {
+      InitializeVector(*vectors[k], localNumberOfRows, A.comm);
+      ierr |= ParallelFileReadAt(fh, vectorBase + (k*numberOfRows + firstRow)*header.vectorValueSize, raw.data(),
+                                 localNumberOfRows*header.vectorValueSize, A.comm);
+      ConvertValues(raw, header.vectorValueSize, vectors[k]->values, localNumberOfRows);
+    }
+  }
+  ierr |= ParallelFileClose(fh);
+#ifndef HPGMP_NO_MPI
+  int localErr = ierr;
+  MPI_Allreduce(&localErr, &ierr, 1, MPI_INT, MPI_MAX, A.comm);
+#endif
+  if (ierr) return ierr;
+
+  return BuildRowBlockMatrix(A, numberOfRows, firstRow, localNumberOfRows, rowPointers, columns, values);
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+// uniform
+template
+int ReadProblem< SparseMatrix<double>, Vector<double> >(const char*, SparseMatrix<double>&, Vector<double>*, Vector<double>*, Vector<double>*, bool);
+
+template
+int ReadProblem< SparseMatrix<float>, Vector<float> >(const char*, SparseMatrix<float>&, Vector<float>*, Vector<float>*, Vector<float>*, bool);
+
+// mixed
+template
+int ReadProblem< SparseMatrix<float>, Vector<double> >(const char*, SparseMatrix<float>&, Vector<double>*, Vector<double>*, Vector<double>*, bool);
+
+template
+int BuildRowBlockMatrix< SparseMatrix<double> >(SparseMatrix<double>&, global_int_t, global_int_t, local_int_t,
+  const std::vector<long long>&, const std::vector<long long>&, const std::vector<double>&);
+
+template
+int BuildRowBlockMatrix< SparseMatrix<float> >(SparseMatrix<float>&, global_int_t, global_int_t, local_int_t,
+  const std::vector<long long>&, const std::vector<long long>&, const std::vector<float>&);
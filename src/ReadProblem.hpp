@@ -0,0 +1,32 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+#ifndef READPROBLEM_HPP
+#define READPROBLEM_HPP
+#include "Geometry.hpp"
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+#include <vector>
+
+template<class SparseMatrix_type, class Vector_type>
+int ReadProblem(const char * fname, SparseMatrix_type & A, Vector_type * b, Vector_type * x, Vector_type * xexact, bool init_vect);
+
+template<class SparseMatrix_type>
+int BuildRowBlockMatrix(SparseMatrix_type & A, global_int_t numberOfRows, global_int_t firstRow, local_int_t localNumberOfRows,
+                        const std::vector<long long> & rowPointers, const std::vector<long long> & columns,
+                        const std::vector<typename SparseMatrix_type::scalar_type> & values);
+
+#endif // READPROBLEM_HPP
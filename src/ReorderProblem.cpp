@@ -0,0 +1,284 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file ReorderProblem.cpp
+
+ HPGMP routine
+ */
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "ReorderProblem.hpp"
+
+/*!
+  Spreads the low 21 bits of v so that two zero bits separate consecutive bits.
+ */
+static inline unsigned long long SpreadBits(unsigned long long v) {
+  v &= 0x1fffffULL;
+  v = (v | v << 32) & 0x1f00000000ffffULL;
+  v = (v | v << 16) & 0x1f0000ff0000ffULL;
+  v = (v | v << 8)  & 0x100f00f00f00f00fULL;
+  v = (v | v << 4)  & 0x10c30c30c30c30c3ULL;
+  v = (v | v << 2)  & 0x1249249249249249ULL;
+  return v;
+}
+
+/*!
+  Computes the new local ID of each row of a generated level (rows numbered lexicographically
+  on the local grid of its geometry) in the given ordering.  Both orderings keep the points
+  injected into the next coarser level in the order of that level: the Morton key of the fine
+  point (2x,2y,2z) is that of the coarse point (x,y,z) shifted by three bits, and the tiles are
+  halved from one level to the next, so that f2cOperator stays increasing.
+ */
+template<class SparseMatrix_type>
+static void ComputeRowPermutation(const SparseMatrix_type & A, int ordering, int level, std::vector<local_int_t> & newRow) {
+
+  const local_int_t nx = A.geom->nx, ny = A.geom->ny;
+  const local_int_t nrow = A.localNumberOfRows;
+  const unsigned long long tile = std::max(1, HPGMP_ROW_ORDER_TILE >> std::min(level, 30));
+  const unsigned long long ntx = (nx + tile - 1)/tile, nty = (ny + tile - 1)/tile;
+
+  std::vector< std::pair<unsigned long long, local_int_t> > keys(nrow);
+  for (local_int_t i=0; i<nrow; ++i) {
+    unsigned long long ix = i%nx, iy = (i/nx)%ny, iz = i/(nx*ny), key;
+    if (ordering==HPGMP_ROW_ORDER_MORTON)
+      key = SpreadBits(ix) | SpreadBits(iy) << 1 | SpreadBits(iz) << 2;
+    else
+      key = ((((iz/tile)*nty + iy/tile)*ntx + ix/tile)*tile*tile*tile) + ((iz%tile)*tile + iy%tile)*tile + ix%tile;
+    keys[i] = std::make_pair(key, i);
+  }
+  std::sort(keys.begin(), keys.end());
+  newRow.resize(nrow);
+  for (local_int_t k=0; k<nrow; ++k) newRow[keys[k].second] = k;
+  return;
+}
+
+/*!
+  Moves the rows of A to their new local IDs, renumbering the local columns, the local-to-global
+  and global-to-local maps, and the elements sent to the neighbors.  The rows are copied in
+  place, so that they are laid out in memory in the new order: this relies on all the rows
+  of a generated level having room for the same number of nonzeros.
+ */
+template<class SparseMatrix_type>
+static void PermuteRows(SparseMatrix_type & A, const std::vector<local_int_t> & newRow) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const local_int_t nrow = A.localNumberOfRows;
+
+  std::vector<local_int_t> start(nrow+1, 0);
+  for (local_int_t i=0; i<nrow; ++i) start[i+1] = start[i] + A.nonzerosInRow[i];
+  std::vector<char> nonzerosInRow(A.nonzerosInRow, A.nonzerosInRow + nrow);
+  std::vector<local_int_t> indL(start[nrow]), diagonal(nrow);
+  std::vector<global_int_t> indG(start[nrow]);
+  std::vector<scalar_type> values(start[nrow]);
+  for (local_int_t i=0; i<nrow; ++i) {
+    diagonal[i] = A.matrixDiagonal[i] - A.matrixValues[i];
+    for (int j=0; j<A.nonzerosInRow[i]; ++j) {
+      local_int_t curCol = A.mtxIndL[i][j];
+      indL[start[i]+j] = curCol<nrow ? newRow[curCol] : curCol; // External columns keep their IDs
+      indG[start[i]+j] = A.mtxIndG[i][j];
+      values[start[i]+j] = A.matrixValues[i][j];
+    }
+  }
+
+  std::vector<global_int_t> localToGlobalMap(A.localToGlobalMap.begin(), A.localToGlobalMap.begin() + nrow);
+  for (local_int_t i=0; i<nrow; ++i) {
+    local_int_t k = newRow[i];
+    A.nonzerosInRow[k] = nonzerosInRow[i];
+    std::copy(indL.begin() + start[i], indL.begin() + start[i+1], A.mtxIndL[k]);
+    std::copy(indG.begin() + start[i], indG.begin() + start[i+1], A.mtxIndG[k]);
+    std::copy(values.begin() + start[i], values.begin() + start[i+1], A.matrixValues[k]);
+    A.matrixDiagonal[k] = A.matrixValues[k] + diagonal[i];
+    A.localToGlobalMap[k] = localToGlobalMap[i];
+    A.globalToLocalMap[localToGlobalMap[i]] = k;
+  }
+#ifndef HPGMP_NO_MPI
+  for (local_int_t i=0; i<A.totalToBeSent; ++i) A.elementsToSend[i] = newRow[A.elementsToSend[i]];
+#endif
+  return;
+}
+
+/*!
+  Models the memory traffic of a SpMV with A per nonzero: the matrix values and column indices, the
+  nonzero counts and the result are streamed once, and x is read through a cache of
+  HPGMP_CACHE_MODEL_BYTES bytes with HPGMP_CACHE_LINE_BYTES-byte lines.  A line of x is considered
+  to be still cached if fewer lines than the cache holds were loaded since it was last used,
+  which approximates a least-recently-used cache.  The model is a proxy for the cache misses
+  caused by the row ordering, since only the traffic of x depends on it.
+
+  @param[in] A the known system matrix
+
+  @return the modeled number of bytes moved per nonzero
+ */
+template<class SparseMatrix_type>
+double ModelBytesPerNonzero(const SparseMatrix_type & A) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const local_int_t nrow = A.localNumberOfRows;
+  const long long valuesPerLine = HPGMP_CACHE_LINE_BYTES/sizeof(scalar_type);
+  const long long capacity = HPGMP_CACHE_MODEL_BYTES/HPGMP_CACHE_LINE_BYTES;
+  if (A.localNumberOfNonzeros==0) return 0.0;
+
+  std::vector<long long> lastUse(A.localNumberOfColumns/valuesPerLine + 1, -capacity-1);
+  long long loads = 0;
+  for (local_int_t i=0; i<nrow; ++i)
+    for (int j=0; j<A.nonzerosInRow[i]; ++j) {
+      long long line = A.mtxIndL[i][j]/valuesPerLine;
+      if (loads - lastUse[line] > capacity) ++loads;
+      lastUse[line] = loads;
+    }
+
+  double nonzeros = A.localNumberOfNonzeros;
+  double bytes = nonzeros*(sizeof(scalar_type) + sizeof(local_int_t)) + nrow*(sizeof(scalar_type) + sizeof(char))
+               + ((double) loads)*HPGMP_CACHE_LINE_BYTES;
+  return bytes/nonzeros;
+}
+
+/*!
+  Reorders the local rows of the generated levels of the hierarchy of A in the ordering requested
+  in A.rowOrdering (see SetupMatrix), so that the neighbors of a row, and the entries of x they
+  reference, are closer in memory.  The rows of each level are permuted in place together with
+  their column indices, and the transfer operators (f2cOperator, the chains of the additive
+  cycle) and the elements sent to the neighbors follow; the vectors are permuted separately (see
+  PermuteProblemVectors).  The global IDs of the rows are unchanged, so the external columns and
+  the messages are too.
+
+  Levels that are not generated on the geometry of their matrix are left in their order: the
+  whole hierarchy when it is imported or agglomerated, and the coarsest level when it is solved
+  directly (its solver is set up for the original order).  A hierarchy mapped from a problem
+  snapshot must have been copied out of the mapping beforehand (see OptimizeProblem).  The
+  ordering actually used is left in the rowOrdering of each level, and the modeled traffic of a
+  SpMV with the finest level before and after the reordering in A.bytesPerNonzero.
+
+  @param[inout] A The known system matrix, with its multigrid hierarchy
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see OptimizeProblem
+ */
+template<class SparseMatrix_type>
+int ReorderProblem(SparseMatrix_type & A) {
+
+  int ordering = A.rowOrdering;
+  for (SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; curLevelMatrix = curLevelMatrix->Ac) {
+    bool generated = curLevelMatrix->agglomeration==0 && curLevelMatrix->rowPartition==0 &&
+                     (curLevelMatrix->mgData==0 || curLevelMatrix->mgData->f2cOperator!=0);
+    if (!generated) ordering = HPGMP_ROW_ORDER_LEXICOGRAPHIC;
+    curLevelMatrix->rowOrdering = HPGMP_ROW_ORDER_LEXICOGRAPHIC;
+  }
+  A.bytesPerNonzero[0] = A.bytesPerNonzero[1] = 0.0;
+  if (ordering!=HPGMP_ROW_ORDER_TILED && ordering!=HPGMP_ROW_ORDER_MORTON) return 0;
+
+  // New local IDs of the rows of each level (identity for the levels left in their order)
+  A.bytesPerNonzero[0] = ModelBytesPerNonzero(A);
+  std::vector<SparseMatrix_type *> levels;
+  std::vector< std::vector<local_int_t> > newRows;
+  for (SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; curLevelMatrix = curLevelMatrix->Ac) {
+    const local_int_t nrow = curLevelMatrix->localNumberOfRows;
+    const Geometry & geom = *curLevelMatrix->geom;
+    newRows.push_back(std::vector<local_int_t>());
+    if (((global_int_t) geom.nx)*geom.ny*geom.nz==nrow && curLevelMatrix->coarseSolver==0) {
+      ComputeRowPermutation(*curLevelMatrix, ordering, levels.size(), newRows.back());
+      PermuteRows(*curLevelMatrix, newRows.back());
+      curLevelMatrix->rowOrdering = ordering;
+    } else {
+      newRows.back().resize(nrow);
+      for (local_int_t i=0; i<nrow; ++i) newRows.back()[i] = i;
+    }
+    levels.push_back(curLevelMatrix);
+  }
+  A.bytesPerNonzero[1] = ModelBytesPerNonzero(A);
+
+  // Injection operators between consecutive levels
+  for (size_t level=0; level+1<levels.size(); ++level) {
+    local_int_t * f2c = levels[level]->mgData->f2cOperator;
+    const local_int_t nc = levels[level+1]->localNumberOfRows;
+    std::vector<local_int_t> f2cOld(f2c, f2c + nc);
+    for (local_int_t i=0; i<nc; ++i) f2c[newRows[level+1][i]] = newRows[level][f2cOld[i]];
+  }
+
+  // Restriction and prolongation chains of the additive cycle, from the finest level to each coarse level
+  if (A.mgData!=0) {
+    for (int level=1; level<A.mgData->numberOfAdditiveLevels; ++level) {
+      local_int_t * rows = A.mgData->additiveRows[level-1];
+      const local_int_t nc = levels[level]->localNumberOfRows;
+      std::vector<local_int_t> rowsOld(rows, rows + nc);
+      for (local_int_t i=0; i<nc; ++i) rows[newRows[level][i]] = newRows[0][rowsOld[i]];
+    }
+  }
+  return 0;
+}
+
+/*!
+  Moves the local entries of b, x and xexact from the order in which the rows of A were generated to
+  their order after ReorderProblem.  The vectors are shared by the matrices of both precisions, so
+  they are permuted once, by the caller of OptimizeProblem, rather than by ReorderProblem.
+
+  @param[in]    A             The known system matrix, after OptimizeProblem
+  @param[in]    generatedRows The global ID of each local row of A before OptimizeProblem
+  @param[inout] b             The known right hand side vector
+  @param[inout] x             The solution vector
+  @param[inout] xexact        The exact solution vector
+ */
+template<class SparseMatrix_type, class Vector_type>
+void PermuteProblemVectors(const SparseMatrix_type & A, const std::vector<global_int_t> & generatedRows,
+                           Vector_type & b, Vector_type & x, Vector_type & xexact) {
+
+  typedef typename Vector_type::scalar_type scalar_type;
+  if (A.rowOrdering==HPGMP_ROW_ORDER_LEXICOGRAPHIC) return;
+  const local_int_t nrow = A.localNumberOfRows;
+  std::vector<local_int_t> newRow(nrow);
+  for (local_int_t i=0; i<nrow; ++i) newRow[i] = A.globalToLocalMap.find(generatedRows[i])->second;
+
+  Vector_type * vectors[3] = {&b, &x, &xexact};
+  std::vector<scalar_type> values(nrow);
+  for (int k=0; k<3; ++k) {
+    scalar_type * const v = vectors[k]->values;
+    std::copy(v, v + nrow, values.begin());
+    for (local_int_t i=0; i<nrow; ++i) v[newRow[i]] = values[i];
+  }
+  return;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+double ModelBytesPerNonzero< SparseMatrix<double> >(SparseMatrix<double> const&);
+
+template
+double ModelBytesPerNonzero< SparseMatrix<float> >(SparseMatrix<float> const&);
+
+template
+int ReorderProblem< SparseMatrix<double> >(SparseMatrix<double>&);
+
+template
+int ReorderProblem< SparseMatrix<float> >(SparseMatrix<float>&);
+
+// uniform
+template
+void PermuteProblemVectors< SparseMatrix<double>, Vector<double> >(SparseMatrix<double> const&, std::vector<global_int_t> const&, Vector<double>&, Vector<double>&, Vector<double>&);
+
+template
+void PermuteProblemVectors< SparseMatrix<float>, Vector<float> >(SparseMatrix<float> const&, std::vector<global_int_t> const&, Vector<float>&, Vector<float>&, Vector<float>&);
+
+// mixed
+template
+void PermuteProblemVectors< SparseMatrix<float>, Vector<double> >(SparseMatrix<float> const&, std::vector<global_int_t> const&, Vector<double>&, Vector<double>&, Vector<double>&);
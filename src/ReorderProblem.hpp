@@ -0,0 +1,41 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+#ifndef REORDERPROBLEM_HPP
+#define REORDERPROBLEM_HPP
+#include <vector>
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+
+const int HPGMP_ROW_ORDER_LEXICOGRAPHIC = 0; //!< Rows numbered x fastest, then y, then z (as generated)
+const int HPGMP_ROW_ORDER_TILED = 1; //!< Lexicographic order of cubic tiles, lexicographic within each tile
+const int HPGMP_ROW_ORDER_MORTON = 2; //!< Morton (Z-order) curve, interleaving the bits of the coordinates
+
+const int HPGMP_ROW_ORDER_TILE = 8; //!< Tile edge on the finest level; it is halved on each coarser level
+const int HPGMP_CACHE_MODEL_BYTES = 1 << 20; //!< Cache capacity of the traffic model (a typical L2 cache)
+const int HPGMP_CACHE_LINE_BYTES = 64; //!< Cache line size of the traffic model
+
+template<class SparseMatrix_type>
+double ModelBytesPerNonzero(const SparseMatrix_type & A);
+
+template<class SparseMatrix_type>
+int ReorderProblem(SparseMatrix_type & A);
+
+template<class SparseMatrix_type, class Vector_type>
+void PermuteProblemVectors(const SparseMatrix_type & A, const std::vector<global_int_t> & generatedRows,
+                           Vector_type & b, Vector_type & x, Vector_type & xexact);
+
+#endif // REORDERPROBLEM_HPP
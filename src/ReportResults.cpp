@@ -28,6 +28,11 @@
 #include "ReportResults.hpp"
 #include "OutputFile.hpp"
 #include "OptimizeProblem.hpp"
+#include "ReorderProblem.hpp"
+#include "SimdBackend.hpp"
+#include "Profiler.hpp"
+#include "PerfCounters.hpp"
+#include "TrafficModel.hpp"
 
 #ifdef HPGMP_DEBUG
 #include <fstream>
@@ -36,6 +41,38 @@ using std::endl;
 #include "hpgmp.hpp"
 #endif
 
+/*!
+ Returns the name of the format of the optimized kernels of the level of A.
+ */
+template<class SparseMatrix_type>
+static const char * MatrixFormatName(const SparseMatrix_type & A) {
+  if (A.stencilData!=0) return "DIA";
+  if (A.compressedIndices!=0) return A.compressedIndices->indexWidth==1 ? "CSR with 8-bit stencil codes" : "CSR with 16-bit deltas";
+  return "CSR";
+}
+
+/*!
+ Returns the fraction of the rows of the level of A whose consecutive forward Gauss-Seidel sweeps are
+ temporally blocked (see ComputeTemporalGS): all rows on a single process, the rows without external
+ columns otherwise, and none if the level is not blocked.
+ */
+template<class SparseMatrix_type>
+static double TemporalBlockingFraction(const SparseMatrix_type & A) {
+  if (A.mgData->temporalTileRows==0 || A.localNumberOfRows==0) return 0.0;
+  return ((double) (A.localNumberOfRows - A.mgData->numberOfTemporalBoundaryRows))/A.localNumberOfRows;
+}
+
+/*!
+ Returns why the consecutive forward Gauss-Seidel sweeps of the level of A are not temporally blocked.
+ */
+template<class SparseMatrix_type>
+static const char * TemporalBlockingDeclined(const SparseMatrix_type & A) {
+  if (GetSmootherData(A)!=0) return "smoother";
+  if (A.stencilData!=0 || A.compressedIndices!=0) return "matrix format";
+  if (A.mgData->numberOfPresmootherSteps<2 && A.mgData->numberOfPostsmootherSteps<2) return "single smoothing steps";
+  return "no interior rows";
+}
+
 /*!
  Creates a YAML file and writes the information about the HPGMP run, its results, and validity.
 
@@ -75,25 +112,10 @@ void ReportResults(const SparseMatrix_type & A, int numberOfMgLevels,
 
     // ======================== Memory bandwidth model =======================================
 
-    // Read/Write counts come from implementation of CG in CG.cpp (include 1 extra for the CG preamble ops)
-    //double fnreads_ddot = 0.0;
-    //double fnwrites_ddot = 0.0;
-    //double fnreads_waxpby = 0.0;
-    //double fnwrites_waxpby = 0.0;
-    //double fnreads_sparsemv = 0.0;
-    // plus nrow reads of x
-    //double fnwrites_sparsemv = 0.0;
-    // Op counts from the multigrid preconditioners
-    //double fnreads_precond = 0.0;
-    //double fnwrites_precond = 0.0;
+    // Bytes moved by the kernels of each level in the formats of the optimized kernels (see TrafficModel.hpp),
+    // reported with the achieved bandwidth of the profiled kernels (see ReportRoofline)
 
     const SparseMatrix_type * Af = &A;
-    //double fnnz_Af = Af->totalNumberOfNonzeros;
-    //double fnrow_Af = Af->totalNumberOfRows;
-    //double fnreads = fnreads_ddot+fnreads_waxpby+fnreads_sparsemv+fnreads_precond;
-    //double fnwrites = fnwrites_ddot+fnwrites_waxpby+fnwrites_sparsemv+fnwrites_precond;
-    //double frefnreads = 0.0;
-    //double frefnwrites = 0.0;
 
 
     // ======================== Memory usage model =======================================
@@ -131,7 +153,7 @@ void ReportResults(const SparseMatrix_type & A, int numberOfMgLevels,
     double fnbytes_OptimizedProblem = OptimizeProblemMemoryUse(A);
     fnbytes += fnbytes_OptimizedProblem;
 
-    Af = A.Ac;
+    Af = ActiveLevelMatrix(&A)->Ac;
     for (int i=1; i<numberOfMgLevels; ++i) {
       double fnrow_Af = Af->totalNumberOfRows;
       double fncol_Af = ((global_int_t) Af->localNumberOfColumns) * size; // Estimate of the global number of columns using the value from rank 0
@@ -161,7 +183,7 @@ void ReportResults(const SparseMatrix_type & A, int numberOfMgLevels,
 #endif
       fnbytesPerLevel[i] = fnbytes_Af;
       fnbytes += fnbytes_Af; // Running sum
-      Af = Af->Ac; // Go to next coarse level
+      Af = ActiveLevelMatrix(Af)->Ac; // Go to next coarse level
     }
 
     assert(Af==0); // Make sure we got to the lowest grid level
@@ -176,6 +198,10 @@ void ReportResults(const SparseMatrix_type & A, int numberOfMgLevels,
     doc.add("Machine Summary","");
     doc.get("Machine Summary")->add("Distributed Processes",A.geom->size);
     doc.get("Machine Summary")->add("Threads per processes",A.geom->numThreads);
+    doc.get("Machine Summary")->add("SIMD Backend",GetSimdLevelName());
+    doc.get("Machine Summary")->add("Hardware Counters",PerfCountersStatus());
+    if (StreamTriadBandwidth()>0.0)
+      doc.get("Machine Summary")->add("STREAM Triad GB/s",StreamTriadBandwidth());
 
     doc.add("Global Problem Dimensions","");
     doc.get("Global Problem Dimensions")->add("Global nx",A.geom->gnx);
@@ -204,24 +230,81 @@ void ReportResults(const SparseMatrix_type & A, int numberOfMgLevels,
 
     doc.add("Setup Information","");
     doc.get("Setup Information")->add("Setup Time",test_data.SetupTime);
+    doc.get("Setup Information")->add("Teardown Time",test_data.TeardownTime);
+    // Maxima over the processes, in MB
+    doc.get("Setup Information")->add("Resident Set Size after Setup",test_data.SetupRSS/1.0e6);
+    doc.get("Setup Information")->add("Mapped Arena Size",test_data.SetupArenaSize/1.0e6);
 
     doc.add("Linear System Information","");
     doc.get("Linear System Information")->add("Number of Equations",A.totalNumberOfRows);
     doc.get("Linear System Information")->add("Number of Nonzero Terms",A.totalNumberOfNonzeros);
+    const char * rowOrderingNames[] = {"Lexicographic", "Tiled", "Morton"};
+    doc.get("Linear System Information")->add("Row Ordering", rowOrderingNames[A.rowOrdering]);
+    if (A.rowOrdering!=HPGMP_ROW_ORDER_LEXICOGRAPHIC) {
+      // Modeled traffic of a SpMV with the local rows of the finest level, an L2 cache miss proxy (see ModelBytesPerNonzero)
+      doc.get("Linear System Information")->add("SpMV Bytes per Nonzero (lexicographic)", A.bytesPerNonzero[0]);
+      doc.get("Linear System Information")->add("SpMV Bytes per Nonzero (reordered)", A.bytesPerNonzero[1]);
+    }
+    doc.get("Linear System Information")->add("Matrix Format", MatrixFormatName(A));
+    if (A.stencilData!=0)
+      doc.get("Linear System Information")->add("DIA Fallback Rows of Process 0", A.stencilData->numberOfFallbackRows);
+    if (A.compressedIndices!=0)
+      doc.get("Linear System Information")->add("Compressed Index Escape Rows of Process 0", A.compressedIndices->numberOfEscapeRows);
+    if (A.rowRuns!=0)
+      doc.get("Linear System Information")->add("Fixed-Width Rows of Process 0", A.rowRuns->numberOfFullRows);
 
     doc.add("Multigrid Information","");
     doc.get("Multigrid Information")->add("Number of coarse grid levels", numberOfMgLevels-1);
+    const char * cycleNames[] = {"V-cycle", "W-cycle", "F-cycle", "K-cycle", "Additive"};
+    doc.get("Multigrid Information")->add("Cycle", cycleNames[A.mgData!=0 ? A.mgData->cycleType : HPGMP_MG_V_CYCLE]);
+    if (A.mgData!=0 && A.mgData->cycleType==HPGMP_MG_ADDITIVE_CYCLE)
+      doc.get("Multigrid Information")->add("Concurrent Levels", A.mgData->isAdditiveConcurrent ? "yes" : "no");
+    const SmootherData<scalar_type> * smoother = GetSmootherData(A);
+    const char * smootherNames[] = {"Gauss-Seidel", "Chebyshev", "Jacobi-Chebyshev", "l1-Jacobi", "Hybrid Gauss-Seidel"};
+    int smootherType = smoother!=0 ? smoother->type : HPGMP_SMOOTHER_GAUSS_SEIDEL;
+    doc.get("Multigrid Information")->add("Smoother", smootherNames[smootherType]);
+    if (smootherType==HPGMP_SMOOTHER_HYBRID_GAUSS_SEIDEL)
+      doc.get("Multigrid Information")->add("Smoother Blocks", smoother->numberOfBlocks);
+    if (smootherType==HPGMP_SMOOTHER_CHEBYSHEV || smootherType==HPGMP_SMOOTHER_JACOBI_CHEBYSHEV) {
+      doc.get("Multigrid Information")->add("Chebyshev Degree", smoother->degree);
+      doc.get("Multigrid Information")->add("Estimated Largest Eigenvalue", smoother->lambdaMax);
+    }
+    doc.get("Multigrid Information")->add("Flops per Cycle", A.totalNumberOfMGFlops);
     Af = &A;
     doc.get("Multigrid Information")->add("Coarse Grids","");
     for (int i=1; i<numberOfMgLevels; ++i) {
+      Af = ActiveLevelMatrix(Af);
       doc.get("Multigrid Information")->get("Coarse Grids")->add("Grid Level",i);
       doc.get("Multigrid Information")->get("Coarse Grids")->add("Number of Equations",Af->Ac->totalNumberOfRows);
       doc.get("Multigrid Information")->get("Coarse Grids")->add("Number of Nonzero Terms",Af->Ac->totalNumberOfNonzeros);
       doc.get("Multigrid Information")->get("Coarse Grids")->add("Number of Presmoother Steps",Af->mgData->numberOfPresmootherSteps);
       doc.get("Multigrid Information")->get("Coarse Grids")->add("Number of Postsmoother Steps",Af->mgData->numberOfPostsmootherSteps);
+      if (Af->Ac->agglomeration!=0)
+        doc.get("Multigrid Information")->get("Coarse Grids")->add("Agglomerated Processes",Af->Ac->agglomeration->A->geom->size);
+      if (A.matrixFormat!=HPGMP_MATRIX_FORMAT_CSR)
+        doc.get("Multigrid Information")->get("Coarse Grids")->add("Matrix Format", MatrixFormatName(*ActiveLevelMatrix(Af->Ac)));
       Af = Af->Ac;
     }
 
+    const SparseMatrix_type * coarsest = CoarsestLevelMatrix(&A);
+    if (coarsest->coarseSolver!=0) {
+      const CoarseSolverData & coarseSolver = *coarsest->coarseSolver;
+      double fnops_cycle = A.totalNumberOfMGFlops;
+      doc.get("Multigrid Information")->add("Coarse Solver","");
+      doc.get("Multigrid Information")->get("Coarse Solver")->add("Factorization", coarseSolver.isDense ? "dense LU" : "banded LU");
+      doc.get("Multigrid Information")->get("Coarse Solver")->add("Number of Equations", coarseSolver.n);
+      doc.get("Multigrid Information")->get("Coarse Solver")->add("Lower Bandwidth", coarseSolver.lowerBandwidth);
+      doc.get("Multigrid Information")->get("Coarse Solver")->add("Upper Bandwidth", coarseSolver.upperBandwidth);
+      doc.get("Multigrid Information")->get("Coarse Solver")->add("Processes Sharing the Factorization", coarsest->geom->size);
+      doc.get("Multigrid Information")->get("Coarse Solver")->add("Setup Time", coarseSolver.setupTime);
+      doc.get("Multigrid Information")->get("Coarse Solver")->add("Solve Flops per Process", coarseSolver.solveFlops);
+      doc.get("Multigrid Information")->get("Coarse Solver")->add("Solve Flops / Cycle Flops", coarseSolver.solveFlops*coarsest->geom->size/fnops_cycle);
+      if (test_data.optNumItersCoarseSweep>=0) {
+        doc.get("Multigrid Information")->get("Coarse Solver")->add("Optimized iterations with the direct solve (validation)", test_data.optNumIters);
+        doc.get("Multigrid Information")->get("Coarse Solver")->add("Optimized iterations with a coarsest-level sweep (validation)", test_data.optNumItersCoarseSweep);
+      }
+    }
+
     doc.add("########## Memory Use Summary  ##########","");
 
     doc.add("Memory Use Information","");
@@ -237,6 +320,39 @@ void ReportResults(const SparseMatrix_type & A, int numberOfMgLevels,
       doc.get("Memory Use Information")->get("Coarse Grids")->add("Memory used",fnbytesPerLevel[i]/1000000000.0);
     }
 
+    // Modeled bytes of the kernels on the local rows of process 0, in the formats of the optimized kernels and
+    // in both precisions of the benchmark (see TrafficModel.hpp), without the halo exchanges but for their own entry
+    const int cycleType = A.mgData!=0 ? A.mgData->cycleType : HPGMP_MG_V_CYCLE;
+    doc.add("Memory Traffic Model of Process 0","");
+    doc.get("Memory Traffic Model of Process 0")->add("MG Cycle Bytes (double)", ModelMGCycleBytes(A, cycleType, sizeof(double)));
+    doc.get("Memory Traffic Model of Process 0")->add("MG Cycle Bytes (float)", ModelMGCycleBytes(A, cycleType, sizeof(float)));
+    doc.get("Memory Traffic Model of Process 0")->add("Grid Levels","");
+    Af = &A;
+    for (int i=0; i<numberOfMgLevels && Af!=0; ++i) {
+      const SparseMatrix_type & level = *ActiveLevelMatrix(Af);
+      const double nnz = level.localNumberOfNonzeros;
+      const double spmvBytes = ModelSpMVBytes(level, sizeof(float));
+      OutputFile * levelModel = doc.get("Memory Traffic Model of Process 0")->get("Grid Levels");
+      levelModel->add("Grid Level",i);
+      levelModel->add("Matrix Format", MatrixFormatName(level));
+      if (nnz>0.0) {
+        levelModel->add("Matrix Bytes per Nonzero (double)", ModelMatrixBytes(level, sizeof(double))/nnz);
+        levelModel->add("Matrix Bytes per Nonzero (float)", ModelMatrixBytes(level, sizeof(float))/nnz);
+      }
+      levelModel->add("SpMV Bytes (double)", ModelSpMVBytes(level, sizeof(double)));
+      levelModel->add("SpMV Bytes (float)", spmvBytes);
+      if (spmvBytes>0.0) levelModel->add("SpMV Flops/Byte (float)", 2.0*nnz/spmvBytes);
+      levelModel->add("Smoother Step Bytes (float)", ModelSmootherBytes(level, 1, sizeof(float)));
+      if (level.mgData!=0) {
+        levelModel->add("Restriction Bytes (float)", ModelRestrictionBytes(level, sizeof(float)));
+        levelModel->add("Prolongation Bytes (float)", ModelProlongationBytes(level, sizeof(float)));
+        levelModel->add("Temporally Blocked Row Fraction", TemporalBlockingFraction(level));
+        if (level.mgData->temporalTileRows==0) levelModel->add("Temporal Blocking Not Applied", TemporalBlockingDeclined(level));
+      }
+      if (level.geom->size>1) levelModel->add("Halo Exchange Bytes (float)", ModelHaloBytes(level, sizeof(float)));
+      Af = level.Ac;
+    }
+
     /*const char DepartureFromSymmetry[] = "Departure from Symmetry |x'Ay-y'Ax|/(2*||x||*||A||*||y||)/epsilon";
     doc.add(DepartureFromSymmetry,"");
     if (testsymmetry_data.count_fail==0)
@@ -251,6 +367,9 @@ void ReportResults(const SparseMatrix_type & A, int numberOfMgLevels,
     doc.get("Iteration Count Information")->add("Number of processes (validation)", test_data.validation_nprocs);
     doc.get("Iteration Count Information")->add("Restart length (validation)", test_data.restart_length);
     doc.get("Iteration Count Information")->add("Convergence tolerance (validation)", test_data.tolerance);
+    doc.get("Iteration Count Information")->add("Reference preconditioner (validation)", "V-cycle, one Gauss-Seidel sweep per smoothing step");
+    // The reference iterations solve the system in the ordering of the optimized ones (see ReorderProblem)
+    doc.get("Iteration Count Information")->add("Row ordering of reference iterations (validation)", rowOrderingNames[A.rowOrdering]);
     doc.get("Iteration Count Information")->add("Number of reference iterations (validation)", test_data.refNumIters);
     doc.get("Iteration Count Information")->add("Initial residual norm of reference iterations (validation)", test_data.refResNorm0);
     doc.get("Iteration Count Information")->add("Final residual norm of reference iterations (validation)", test_data.refResNorm);
@@ -281,6 +400,16 @@ void ReportResults(const SparseMatrix_type & A, int numberOfMgLevels,
     doc.get("Benchmark Time Summary")->add(" SpTRSV",   test_data.opt_times[8]);
     doc.get("Benchmark Time Summary")->add(" Restic",   test_data.opt_times[9]);
     doc.get("Benchmark Time Summary")->add(" Prlong",   test_data.opt_times[10]);
+    if (!test_data.opt_mgLevelTimes.empty()) {
+      doc.get("Benchmark Time Summary")->add(" MG Levels","");
+      for (size_t i=0; i<test_data.opt_mgLevelTimes.size(); ++i) {
+        doc.get("Benchmark Time Summary")->get(" MG Levels")->add("Grid Level",(int) i);
+        doc.get("Benchmark Time Summary")->get(" MG Levels")->add("Time",test_data.opt_mgLevelTimes[i]);
+        // Time of the level over the multigrid time; concurrent levels overlap, so the fractions may add up to more than 1
+        if (test_data.opt_times[6]>0.0)
+          doc.get("Benchmark Time Summary")->get(" MG Levels")->add("Time Fraction",test_data.opt_mgLevelTimes[i]/test_data.opt_times[6]);
+      }
+    }
     doc.get("Benchmark Time Summary")->add("VecUpdate", test_data.opt_times[11]);
     doc.get("Benchmark Time Summary")->add("Total",     test_data.opt_times[0]);
     if (test_data.refTotalTime > 0.0) {
@@ -300,6 +429,10 @@ void ReportResults(const SparseMatrix_type & A, int numberOfMgLevels,
       doc.get("Benchmark Time Summary")->add(" - Total   (reference)",test_data.refTotalTime);
     }
 
+    // Regions of the optimized benchmark calls, per multigrid level (see ProfileScope)
+    doc.add("Benchmark Profile","");
+    ReportProfile(doc.get("Benchmark Profile"));
+
     doc.add("Floating Point Operations Summary","");
     doc.get("Floating Point Operations Summary")->add("Raw Ortho",test_data.opt_flops[3]);
     doc.get("Floating Point Operations Summary")->add("Raw SpMV", test_data.opt_flops[2]);
@@ -312,13 +445,9 @@ void ReportResults(const SparseMatrix_type & A, int numberOfMgLevels,
       doc.get("Floating Point Operations Summary")->add(" - Raw Total (reference)",test_data.refTotalFlops);
     }
 
-#if 0
+    // Achieved bandwidth of the kernels of the optimized benchmark calls against the STREAM triad
     doc.add("GB/s Summary","");
-    doc.get("GB/s Summary")->add("Raw Read B/W",fnreads/times[0]/1.0E9);
-    doc.get("GB/s Summary")->add("Raw Write B/W",fnwrites/times[0]/1.0E9);
-    doc.get("GB/s Summary")->add("Raw Total B/W",(fnreads+fnwrites)/(times[0])/1.0E9);
-    doc.get("GB/s Summary")->add("Total with convergence and optimization phase overhead",(frefnreads+frefnwrites)/(times[0]+(times[7]/10.0+times[9]/10.0))/1.0E9);
-#endif
+    ReportRoofline(doc.get("GB/s Summary"));
 
     doc.add("GFLOP/s Summary","");
     doc.get("GFLOP/s Summary")->add("Raw Orho", test_data.opt_flops[3]/test_data.opt_times[3]/1.0E9);
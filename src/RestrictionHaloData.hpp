@@ -0,0 +1,63 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file RestrictionHaloData.hpp
+
+ HPGMP data structure
+ */
+
+#ifndef RESTRICTIONHALODATA_HPP
+#define RESTRICTIONHALODATA_HPP
+
+#include "DataTypes.hpp"
+
+/*!
+  Part of the halo of a fine level needed by the rows injected into the coarse level, so that
+  ComputeResidualRestriction only communicates the external values these rows reference.
+  Messages are exchanged with the neighbors of the fine matrix, in the same order.
+ */
+template<class SC>
+class RestrictionHaloData {
+public:
+  local_int_t totalToBeSent; //!< total number of entries to be sent
+  local_int_t * sendLength; //!< number of entries sent to each neighbor
+  local_int_t * elementsToSend; //!< local rows to send, grouped by neighbor
+  local_int_t totalToBeReceived; //!< total number of entries to be received
+  local_int_t * receiveLength; //!< number of entries received from each neighbor
+  local_int_t * externalColumns; //!< local columns (at least localNumberOfRows) receiving the entries, grouped by neighbor
+  SC * sendBuffer; //!< send buffer
+  SC * receiveBuffer; //!< receive buffer
+};
+
+/*!
+ Destructor for the restriction halo data.
+
+ @param[inout] data the restriction halo data structure whose storage is deallocated
+ */
+template<class SC>
+inline void DeleteRestrictionHaloData(RestrictionHaloData<SC> & data) {
+
+  delete [] data.sendLength;
+  delete [] data.elementsToSend;
+  delete [] data.receiveLength;
+  delete [] data.externalColumns;
+  delete [] data.sendBuffer;
+  delete [] data.receiveBuffer;
+  return;
+}
+
+#endif // RESTRICTIONHALODATA_HPP
@@ -0,0 +1,90 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file RowRunData.hpp
+
+ HPGMP data structure
+ */
+
+#ifndef ROWRUNDATA_HPP
+#define ROWRUNDATA_HPP
+
+#include "DataTypes.hpp"
+
+const int HPGMP_FULL_ROW_LENGTH = 27; //!< number of nonzeros of the interior rows of the generated problems
+const int HPGMP_FULL_ROW_DIAGONAL = 13; //!< position of the diagonal in these rows
+
+/*!
+  Partition of the rows of one multigrid level by number of nonzeros, in the rowRuns of its matrix:
+  the rows runStart[r] to runStart[r+1]-1 form run r, and the runs alternate between generic rows
+  (even runs, possibly empty) and full rows (odd runs).  The full rows of a run have
+  HPGMP_FULL_ROW_LENGTH nonzeros stored HPGMP_FULL_ROW_LENGTH entries apart in mtxIndL and
+  matrixValues, with the lower triangular terms before the diagonal at position
+  HPGMP_FULL_ROW_DIAGONAL and the upper triangular terms after it, so the kernels step through them
+  with a compile-time stride and the fully unrolled Row<HPGMP_FULL_ROW_LENGTH>.
+ */
+class RowRunData {
+public:
+  local_int_t numberOfRuns; //!< number of runs, odd (the last run is generic)
+  local_int_t * runStart; //!< first row of each run, followed by the number of rows
+  local_int_t numberOfFullRows; //!< number of rows in the odd runs
+};
+
+/*!
+  Products of a row of width nonzeros, a compile-time trip count: the loops are fully unrolled, and
+  the terms are summed in the order of the row like the reference kernels.
+ */
+template<int width>
+struct Row {
+  //! Returns sum plus the products of the values of the row with the entries of x at its columns
+  template<class SC>
+  static inline SC Add(const SC * values, const local_int_t * columns, const SC * xv, SC sum) {
+    for (int j=0; j<width; ++j) sum += values[j]*xv[columns[j]];
+    return sum;
+  }
+  //! Returns sum minus the products of the values of the row with the entries of x at its columns
+  template<class SC>
+  static inline SC Subtract(const SC * values, const local_int_t * columns, const SC * xv, SC sum) {
+    for (int j=0; j<width; ++j) sum -= values[j]*xv[columns[j]];
+    return sum;
+  }
+};
+
+/*!
+ Constructor for the row runs.
+
+ @param[out] data the row runs, set up by OptimizeProblem
+ */
+inline void InitializeRowRunData(RowRunData & data) {
+  data.numberOfRuns = 0;
+  data.runStart = 0;
+  data.numberOfFullRows = 0;
+  return;
+}
+
+/*!
+ Destructor for the row runs.
+
+ @param[inout] data the row run structure whose storage is deallocated
+ */
+inline void DeleteRowRunData(RowRunData & data) {
+
+  delete [] data.runStart;
+  return;
+}
+
+#endif // ROWRUNDATA_HPP
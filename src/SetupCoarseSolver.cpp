@@ -0,0 +1,226 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file SetupCoarseSolver.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+
+#include <cmath>
+#include <vector>
+#include "SetupCoarseSolver.hpp"
+#include "mytimer.hpp"
+
+// Factors larger than this are not set up, and the coarsest level keeps its smoother sweep
+const double coarseSolverMaxBytes = 512.0*1024.0*1024.0;
+
+/*!
+  Banded LU factorization with partial pivoting (as LAPACK dgbtf2) of the matrix stored in ab,
+  in band storage with kl subdiagonals, ku superdiagonals and kl rows for the fill-in.
+
+  @return Returns zero on success and a non-zero value if the matrix is singular.
+ */
+static int FactorBanded(global_int_t n, global_int_t kl, global_int_t ku, double * ab, global_int_t ldab, global_int_t * ipiv) {
+
+  global_int_t kv = kl + ku;
+  global_int_t ju = 0; // last column touched by the row interchanges so far
+  for (global_int_t j=0; j<n; ++j) {
+    global_int_t km = std::min(kl, n-1-j);
+    double * colj = ab + j*ldab + kv; // colj[r] is row j+r of column j
+    global_int_t jp = 0;
+    for (global_int_t r=1; r<=km; ++r)
+      if (std::fabs(colj[r])>std::fabs(colj[jp])) jp = r;
+    ipiv[j] = j + jp;
+    if (colj[jp]==0.0) return 1;
+
+    ju = std::max(ju, std::min(j+ku+jp, n-1));
+    if (jp!=0)
+      for (global_int_t c=j; c<=ju; ++c) std::swap(ab[kv+j-c + c*ldab], ab[kv+j+jp-c + c*ldab]);
+    double pivot = colj[0];
+    for (global_int_t r=1; r<=km; ++r) colj[r] /= pivot;
+    for (global_int_t c=j+1; c<=ju; ++c) {
+      double ujc = ab[kv+j-c + c*ldab];
+      if (ujc==0.0) continue;
+      for (global_int_t r=1; r<=km; ++r) ab[kv+j+r-c + c*ldab] -= colj[r]*ujc;
+    }
+  }
+  return 0;
+}
+
+/*!
+  Dense LU factorization with partial pivoting of the column-major matrix a.
+
+  @return Returns zero on success and a non-zero value if the matrix is singular.
+ */
+static int FactorDense(global_int_t n, double * a, global_int_t * ipiv) {
+
+  for (global_int_t j=0; j<n; ++j) {
+    double * colj = a + j*n;
+    global_int_t jp = j;
+    for (global_int_t i=j+1; i<n; ++i)
+      if (std::fabs(colj[i])>std::fabs(colj[jp])) jp = i;
+    ipiv[j] = jp;
+    if (colj[jp]==0.0) return 1;
+    if (jp!=j)
+      for (global_int_t c=0; c<n; ++c) std::swap(a[j + c*n], a[jp + c*n]);
+    for (global_int_t i=j+1; i<n; ++i) colj[i] /= colj[j];
+    for (global_int_t c=j+1; c<n; ++c) {
+      double ajc = a[j + c*n];
+      if (ajc==0.0) continue;
+      for (global_int_t i=j+1; i<n; ++i) a[i + c*n] -= colj[i]*ajc;
+    }
+  }
+  return 0;
+}
+
+/*!
+  Routine to set up a direct solver for the coarsest multigrid level.
+
+  Every process of the level gathers the whole matrix and factors it redundantly, so that the
+  solve only needs to gather the right-hand side.  The factorization is banded in global row order,
+  or dense when the band is about as wide as the matrix.
+
+  @param[inout] A The coarsest level matrix, on output its coarse solver data is defined on success.
+
+  @return Returns zero on success, and a non-zero value on all processes if the factor would be too
+          large or the matrix is singular; the level is then left without a direct solver.
+
+  Note that the matrix A is considered const because the attributes we are modifying are declared as mutable.
+*/
+template<class SparseMatrix_type>
+int SetupCoarseSolver(const SparseMatrix_type & A) {
+
+#if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
+  return -1;
+#else
+  double t0 = mytimer();
+  int size = 1;
+#ifndef HPGMP_NO_MPI
+  MPI_Comm_size(A.comm, &size);
+#endif
+
+  // Local entries in global numbering
+  local_int_t nrow = A.localNumberOfRows;
+  std::vector<long long> localRows(nrow), localIndices;
+  std::vector<double> localValues;
+  for (local_int_t i=0; i<nrow; ++i) {
+    localRows[i] = A.localToGlobalMap[i];
+    for (int j=0; j<A.nonzerosInRow[i]; ++j) {
+      localIndices.push_back(localRows[i]);
+      localIndices.push_back(A.mtxIndG[i][j]);
+      localValues.push_back(A.matrixValues[i][j]);
+    }
+  }
+
+  std::vector<int> counts(size), displs(size), entryCounts(size), entryDispls(size);
+  std::vector<long long> rows, indices;
+  std::vector<double> values;
+#ifndef HPGMP_NO_MPI
+  int localCounts[2] = {(int) nrow, (int) localValues.size()};
+  std::vector<int> allCounts(2*size);
+  MPI_Allgather(localCounts, 2, MPI_INT, allCounts.data(), 2, MPI_INT, A.comm);
+  int totalRows = 0, totalEntries = 0;
+  for (int p=0; p<size; ++p) {
+    counts[p] = allCounts[2*p];
+    displs[p] = totalRows;
+    totalRows += counts[p];
+    entryCounts[p] = allCounts[2*p+1];
+    entryDispls[p] = totalEntries;
+    totalEntries += entryCounts[p];
+  }
+  rows.resize(totalRows);
+  indices.resize(2*totalEntries);
+  values.resize(totalEntries);
+  MPI_Allgatherv(localRows.data(), nrow, MPI_LONG_LONG, rows.data(), counts.data(), displs.data(), MPI_LONG_LONG, A.comm);
+  MPI_Allgatherv(localValues.data(), localValues.size(), MPI_DOUBLE, values.data(), entryCounts.data(), entryDispls.data(), MPI_DOUBLE, A.comm);
+  for (int p=0; p<size; ++p) {
+    entryCounts[p] *= 2;
+    entryDispls[p] *= 2;
+  }
+  MPI_Allgatherv(localIndices.data(), localIndices.size(), MPI_LONG_LONG, indices.data(), entryCounts.data(), entryDispls.data(), MPI_LONG_LONG, A.comm);
+#else
+  counts[0] = nrow;
+  displs[0] = 0;
+  rows.swap(localRows);
+  indices.swap(localIndices);
+  values.swap(localValues);
+#endif
+
+  global_int_t n = A.totalNumberOfRows;
+  global_int_t kl = 0, ku = 0;
+  for (size_t k=0; k<values.size(); ++k) {
+    kl = std::max(kl, (global_int_t) (indices[2*k]-indices[2*k+1]));
+    ku = std::max(ku, (global_int_t) (indices[2*k+1]-indices[2*k]));
+  }
+  bool isDense = n <= 2*kl+ku+1;
+  global_int_t ldab = isDense ? n : 2*kl+ku+1;
+  if (((double) n)*((double) ldab)*sizeof(double) > coarseSolverMaxBytes) return 1;
+
+  double * factor = new double[n*ldab];
+  for (global_int_t k=0; k<n*ldab; ++k) factor[k] = 0.0;
+  for (size_t k=0; k<values.size(); ++k) {
+    global_int_t i = indices[2*k], j = indices[2*k+1];
+    if (isDense) factor[i + j*n] += values[k];
+    else factor[kl+ku+i-j + j*ldab] += values[k];
+  }
+  global_int_t * pivots = new global_int_t[n];
+  int ierr = isDense ? FactorDense(n, factor, pivots) : FactorBanded(n, kl, ku, factor, ldab, pivots);
+  if (ierr) {
+    delete [] factor;
+    delete [] pivots;
+    return 2;
+  }
+
+  CoarseSolverData * data = new CoarseSolverData;
+  data->isDense = isDense;
+  data->n = n;
+  data->lowerBandwidth = kl;
+  data->upperBandwidth = ku;
+  data->ldab = ldab;
+  data->factor = factor;
+  data->pivots = pivots;
+  data->gatheredRows = new global_int_t[n];
+  for (global_int_t k=0; k<n; ++k) data->gatheredRows[k] = rows[k];
+  data->counts = new int[size];
+  data->displs = new int[size];
+  for (int p=0; p<size; ++p) {
+    data->counts[p] = counts[p];
+    data->displs[p] = displs[p];
+  }
+  data->gathered = new double[n];
+  data->solution = new double[n];
+  data->solveFlops = isDense ? 2.0*n*n : 2.0*n*(2*kl+ku) + n;
+  data->setupTime = mytimer() - t0;
+  A.coarseSolver = data;
+  return 0;
+#endif
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int SetupCoarseSolver< SparseMatrix<double> >(SparseMatrix<double> const&);
+
+template
+int SetupCoarseSolver< SparseMatrix<float> >(SparseMatrix<float> const&);
@@ -0,0 +1,24 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+#ifndef SETUPCOARSESOLVER_HPP
+#define SETUPCOARSESOLVER_HPP
+#include "SparseMatrix.hpp"
+
+template<class SparseMatrix_type>
+int SetupCoarseSolver(const SparseMatrix_type & A);
+
+#endif // SETUPCOARSESOLVER_HPP
@@ -0,0 +1,131 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file SetupCompressedIndices.cpp
+
+ HPGMP routine
+ */
+
+#include <vector>
+#include "SetupCompressedIndices.hpp"
+
+/*!
+  Sets up the compressed column indices of the level of A (see CompressedIndexData) when they are
+  requested.  Each row is encoded with 8-bit stencil codes when its columns are at the offsets of the
+  27-point stencil of the local grid, which is the case for the lexicographic rows of generated
+  levels, and with 16-bit deltas when its columns span at most 65536 consecutive indices, which also
+  holds for reordered rows on moderate local grids.  The width with the fewer escape rows is kept,
+  the stencil codes on ties.  Rows referencing external columns are always escape rows.  The level
+  keeps plain CSR if one of its rows is longer than HPGMP_COMPRESSED_ROW_LENGTH; mtxIndL is kept for
+  the escape rows and the reference kernels.
+
+  @param[in] A            The matrix of a multigrid level, on exit with the compressed indices if set up
+  @param[in] matrixFormat The format requested for the hierarchy (HPGMP_MATRIX_FORMAT_COMPRESSED to set them up)
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSPMV
+  @see ComputeGS_Forward
+  @see ComputeResidualRestriction
+*/
+template<class SparseMatrix_type>
+int SetupCompressedIndices(const SparseMatrix_type & A, int matrixFormat) {
+
+  if (matrixFormat!=HPGMP_MATRIX_FORMAT_COMPRESSED || A.compressedIndices!=0 || A.stencilData!=0) return 0;
+
+  const local_int_t nrow = A.localNumberOfRows;
+  int rowLength = 0;
+  for (local_int_t i=0; i<nrow; ++i)
+    if (A.nonzerosInRow[i]>rowLength) rowLength = A.nonzerosInRow[i];
+  if (nrow==0 || rowLength>HPGMP_COMPRESSED_ROW_LENGTH) return 0;
+
+  CompressedIndexData * data = new CompressedIndexData;
+  InitializeCompressedIndexData(*A.geom, *data);
+  data->rowLength = rowLength;
+
+  // Encodability of each row with both widths
+  std::vector<char> hasCodes(nrow, 1), hasDeltas(nrow, 1);
+  std::vector<local_int_t> firstColumn(nrow, 0);
+  local_int_t codeEscapes = 0, deltaEscapes = 0;
+  for (local_int_t i=0; i<nrow; ++i) {
+    const local_int_t * const cur_inds = A.mtxIndL[i];
+    local_int_t minColumn = nrow, maxColumn = -1;
+    for (int j=0; j<A.nonzerosInRow[i]; ++j) {
+      const local_int_t col = cur_inds[j];
+      if (col>=nrow) {
+        hasCodes[i] = hasDeltas[i] = 0;
+        break;
+      }
+      int k = 0;
+      while (k<HPGMP_COMPRESSED_ROW_LENGTH && data->codeOffsets[k]!=col-i) ++k;
+      if (k==HPGMP_COMPRESSED_ROW_LENGTH) hasCodes[i] = 0;
+      if (col<minColumn) minColumn = col;
+      if (col>maxColumn) maxColumn = col;
+    }
+    if (hasDeltas[i] && maxColumn-minColumn>65535) hasDeltas[i] = 0;
+    firstColumn[i] = minColumn<nrow ? minColumn : 0;
+    if (!hasCodes[i]) ++codeEscapes;
+    if (!hasDeltas[i]) ++deltaEscapes;
+  }
+  data->indexWidth = codeEscapes<=deltaEscapes ? 1 : 2;
+  const std::vector<char> & isEncoded = data->indexWidth==1 ? hasCodes : hasDeltas;
+  data->numberOfEscapeRows = data->indexWidth==1 ? codeEscapes : deltaEscapes;
+
+  // Codes, zero for the escape rows and the padding of short rows
+  const size_t numberOfCodes = ((size_t) nrow)*rowLength;
+  data->rowBase = new local_int_t[nrow];
+  if (data->indexWidth==1) {
+    data->codes = new unsigned char[numberOfCodes];
+    for (size_t k=0; k<numberOfCodes; ++k) data->codes[k] = 0;
+  } else {
+    data->deltas = new unsigned short[numberOfCodes];
+    for (size_t k=0; k<numberOfCodes; ++k) data->deltas[k] = 0;
+  }
+  for (local_int_t i=0; i<nrow; ++i) {
+    if (!isEncoded[i]) {
+      data->rowBase[i] = -1;
+      continue;
+    }
+    const local_int_t * const cur_inds = A.mtxIndL[i];
+    if (data->indexWidth==1) {
+      data->rowBase[i] = i;
+      for (int j=0; j<A.nonzerosInRow[i]; ++j) {
+        int k = 0;
+        while (data->codeOffsets[k]!=cur_inds[j]-i) ++k;
+        data->codes[((size_t) i)*rowLength + j] = k;
+      }
+    } else {
+      data->rowBase[i] = firstColumn[i];
+      for (int j=0; j<A.nonzerosInRow[i]; ++j)
+        data->deltas[((size_t) i)*rowLength + j] = cur_inds[j] - firstColumn[i];
+    }
+  }
+
+  A.compressedIndices = data;
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int SetupCompressedIndices< SparseMatrix<double> >(SparseMatrix<double> const&, int);
+
+template
+int SetupCompressedIndices< SparseMatrix<float> >(SparseMatrix<float> const&, int);
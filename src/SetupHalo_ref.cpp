@@ -24,6 +24,7 @@
 #include <mpi.h>
 #include <map>
 #include <set>
+#include <vector>
 #endif
 
 #ifndef HPGMP_NO_OPENMP
@@ -86,18 +87,52 @@ void SetupHalo_ref(SparseMatrix_type & A) {
     global_int_t currentGlobalRow = A.localToGlobalMap[i];
     for (int j=0; j<nonzerosInRow[i]; j++) {
       global_int_t curIndex = mtxIndG[i][j];
-      int rankIdOfColumnEntry = ComputeRankOfMatrixRow(*(A.geom), curIndex);
+      int rankIdOfColumnEntry = ComputeRankOfMatrixColumn(A, curIndex);
 #ifdef HPGMP_DETAILED_DEBUG
       HPGMP_fout << "rank, row , col, globalToLocalMap[col] = " << A.geom->rank << " " << currentGlobalRow << " "
           << curIndex << " " << A.globalToLocalMap[curIndex] << endl;
 #endif
       if (A.geom->rank!=rankIdOfColumnEntry) {// If column index is not a row index, then it comes from another processor
         receiveList[rankIdOfColumnEntry].insert(curIndex);
-        sendList[rankIdOfColumnEntry].insert(currentGlobalRow); // Matrix symmetry means we know the neighbor process wants my value
+        if (A.rowPartition==0)
+          sendList[rankIdOfColumnEntry].insert(currentGlobalRow); // Matrix symmetry means we know the neighbor process wants my value
       }
     }
   }
 
+  if (A.rowPartition!=0) {
+    // Matrices with an explicit row partition (e.g., read from a file) need not be structurally symmetric,
+    // so every process tells the owners which of their rows it needs.
+    int size = A.geom->size;
+#ifdef HPGMP_NO_LONG_LONG
+    MPI_Datatype MPI_GLOBAL_INT = MPI_INT;
+#else
+    MPI_Datatype MPI_GLOBAL_INT = MPI_LONG_LONG;
+#endif
+    std::vector<int> requestCounts(size, 0), requestDispls(size+1, 0), incomingCounts(size, 0), incomingDispls(size+1, 0);
+    for (map_iter curNeighbor = receiveList.begin(); curNeighbor != receiveList.end(); ++curNeighbor)
+      requestCounts[curNeighbor->first] = (curNeighbor->second).size();
+    MPI_Alltoall(requestCounts.data(), 1, MPI_INT, incomingCounts.data(), 1, MPI_INT, A.comm);
+    for (int p=0; p<size; ++p) {
+      requestDispls[p+1] = requestDispls[p] + requestCounts[p];
+      incomingDispls[p+1] = incomingDispls[p] + incomingCounts[p];
+    }
+    std::vector<global_int_t> requests(requestDispls[size]+1), incoming(incomingDispls[size]+1);
+    for (map_iter curNeighbor = receiveList.begin(); curNeighbor != receiveList.end(); ++curNeighbor)
+      std::copy((curNeighbor->second).begin(), (curNeighbor->second).end(), requests.begin() + requestDispls[curNeighbor->first]);
+    MPI_Alltoallv(requests.data(), requestCounts.data(), requestDispls.data(), MPI_GLOBAL_INT,
+                  incoming.data(), incomingCounts.data(), incomingDispls.data(), MPI_GLOBAL_INT, A.comm);
+    for (int p=0; p<size; ++p) {
+      if (incomingCounts[p]==0) continue;
+      sendList[p].insert(incoming.begin() + incomingDispls[p], incoming.begin() + incomingDispls[p+1]);
+    }
+    // Messages are exchanged with the same set of neighbors in both directions, possibly with zero length
+    for (map_iter curNeighbor = sendList.begin(); curNeighbor != sendList.end(); ++curNeighbor)
+      receiveList[curNeighbor->first];
+    for (map_iter curNeighbor = receiveList.begin(); curNeighbor != receiveList.end(); ++curNeighbor)
+      sendList[curNeighbor->first];
+  }
+
   // Count number of matrix entries to send and receive
   local_int_t totalToBeSent = 0;
   for (map_iter curNeighbor = sendList.begin(); curNeighbor != sendList.end(); ++curNeighbor) {
@@ -120,12 +155,12 @@ void SetupHalo_ref(SparseMatrix_type & A) {
   }
 #endif
 
-  // Build the arrays and lists needed by the ExchangeHalo function.
-  scalar_type * sendBuffer = new scalar_type[totalToBeSent];
-  local_int_t * elementsToSend = new local_int_t[totalToBeSent];
-  int * neighbors = new int[sendList.size()];
-  local_int_t * receiveLength = new local_int_t[receiveList.size()];
-  local_int_t * sendLength = new local_int_t[sendList.size()];
+  // Build the arrays and lists needed by the ExchangeHalo function, in the arena of the level if it has one.
+  scalar_type * sendBuffer = NewArray<scalar_type>(A.arena, totalToBeSent);
+  local_int_t * elementsToSend = NewArray<local_int_t>(A.arena, totalToBeSent);
+  int * neighbors = NewArray<int>(A.arena, sendList.size());
+  local_int_t * receiveLength = NewArray<local_int_t>(A.arena, receiveList.size());
+  local_int_t * sendLength = NewArray<local_int_t>(A.arena, sendList.size());
   int neighborCount = 0;
   local_int_t receiveEntryCount = 0;
   local_int_t sendEntryCount = 0;
@@ -150,7 +185,7 @@ void SetupHalo_ref(SparseMatrix_type & A) {
   for (local_int_t i=0; i< localNumberOfRows; i++) {
     for (int j=0; j<nonzerosInRow[i]; j++) {
       global_int_t curIndex = mtxIndG[i][j];
-      int rankIdOfColumnEntry = ComputeRankOfMatrixRow(*(A.geom), curIndex);
+      int rankIdOfColumnEntry = ComputeRankOfMatrixColumn(A, curIndex);
       if (A.geom->rank==rankIdOfColumnEntry) { // My column index, so convert to local index
         mtxIndL[i][j] = A.globalToLocalMap[curIndex];
       } else { // If column index is not a row index, then it comes from another processor
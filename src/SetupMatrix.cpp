@@ -20,8 +20,138 @@
  HPGMP routine
  */
 
+#include <cstdlib>
+#include <vector>
 #include "SetupMatrix.hpp"
 
+/*!
+  Stops the run when an imported matrix cannot be set up; called on all processes.
+ */
+static void AbortImport(const char * fname, const char * what, int ierr, comm_type comm) {
+  int rank = 0;
+#ifndef HPGMP_NO_MPI
+  MPI_Comm_rank(comm, &rank);
+#else
+  (void) comm;
+#endif
+  if (rank==0) HPGMP_fout << "Error " << ierr << " " << what << " matrix file " << fname << std::endl;
+#ifndef HPGMP_NO_MPI
+  MPI_Abort(MPI_COMM_WORLD, 127);
+#else
+  std::exit(127);
+#endif
+}
+
+/*!
+  Returns the number of multigrid levels that can be generated for the geometry, at most numberOfMgLevels:
+  every coarsening halves the local grid, so it stops once a local dimension is odd.
+ */
+static int CapNumberOfMgLevels(const Geometry * geom, int numberOfMgLevels) {
+  local_int_t nx = geom->nx, ny = geom->ny;
+  std::vector<local_int_t> nz(geom->partz_nz, geom->partz_nz + geom->npartz);
+  int levels = 1;
+  while (levels<numberOfMgLevels && nx%2==0 && ny%2==0) {
+    bool even = true;
+    for (size_t i=0; i<nz.size(); ++i) even = even && nz[i]%2==0;
+    if (!even) break;
+    nx /= 2; ny /= 2;
+    for (size_t i=0; i<nz.size(); ++i) nz[i] /= 2;
+    ++levels;
+  }
+  return levels;
+}
+
+/*!
+  Allocates the coarse vectors used by the cycles other than the V-cycle on the level of A.
+ */
+template<class SparseMatrix_type>
+static void SetupMGCycle(const SparseMatrix_type & A, int cycleType) {
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  typedef Vector<scalar_type> Vector_type;
+
+  MGData<scalar_type> & mgData = *A.mgData;
+  mgData.cycleType = cycleType;
+  if (cycleType==HPGMP_MG_V_CYCLE || cycleType==HPGMP_MG_ADDITIVE_CYCLE || mgData.rc2!=0) return;
+  const local_int_t nrow = A.Ac->localNumberOfRows, ncol = A.Ac->localNumberOfColumns;
+  mgData.rc2 = new Vector_type; InitializeVector(*mgData.rc2, nrow, A.Ac->comm, A.Ac->arena);
+  mgData.xc2 = new Vector_type; InitializeVector(*mgData.xc2, ncol, A.Ac->comm, A.Ac->arena);
+  mgData.Axc = new Vector_type; InitializeVector(*mgData.Axc, nrow, A.Ac->comm, A.Ac->arena);
+  if (cycleType==HPGMP_MG_K_CYCLE) {
+    mgData.Axc2 = new Vector_type; InitializeVector(*mgData.Axc2, nrow, A.Ac->comm, A.Ac->arena);
+  }
+  return;
+}
+
+/*!
+  Precomputes the restriction and prolongation chains of the additive cycle on the hierarchy of A:
+  for each coarse level, the fine row injected into each of its rows, so that all levels are reached
+  from the fine grid in one step.  Returns false, without setting anything up, if a level is coarsened
+  by aggregation or agglomerated, which the additive cycle does not support.
+ */
+template<class SparseMatrix_type>
+static bool SetupAdditiveCycle(const SparseMatrix_type & A, bool concurrent) {
+  int numberOfLevels = 1;
+  for (const SparseMatrix_type * curLevelMatrix = &A; ; curLevelMatrix = curLevelMatrix->Ac) {
+    if (curLevelMatrix->agglomeration!=0) return false;
+    if (curLevelMatrix->mgData==0) break;
+    if (curLevelMatrix->mgData->f2cOperator==0) return false;
+    ++numberOfLevels;
+  }
+
+  local_int_t ** additiveRows = new local_int_t * [numberOfLevels-1];
+  const SparseMatrix_type * curLevelMatrix = &A;
+  for (int level=1; level<numberOfLevels; ++level) {
+    const local_int_t * f2c = curLevelMatrix->mgData->f2cOperator;
+    const local_int_t nc = curLevelMatrix->Ac->localNumberOfRows;
+    additiveRows[level-1] = new local_int_t[nc];
+    for (local_int_t i=0; i<nc; ++i)
+      additiveRows[level-1][i] = level==1 ? f2c[i] : additiveRows[level-2][f2c[i]];
+    curLevelMatrix = curLevelMatrix->Ac;
+  }
+  A.mgData->numberOfAdditiveLevels = numberOfLevels;
+  A.mgData->additiveRows = additiveRows;
+  A.mgData->isAdditiveConcurrent = concurrent;
+  return true;
+}
+
+/*!
+  Selects the smoother of the level of A; its data (polynomial, inverse diagonal, blocks) is set up by OptimizeProblem.
+ */
+template<class SparseMatrix_type>
+static void SetupSmoother(const SparseMatrix_type & A, int smoother) {
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+
+  // Processes left out by agglomeration do not smooth the level
+  if (smoother==HPGMP_SMOOTHER_GAUSS_SEIDEL || A.agglomeration!=0 || A.optimizationData!=0) return;
+  SmootherData<scalar_type> * data = new SmootherData<scalar_type>;
+  InitializeSmootherData(smoother, *data);
+  A.optimizationData = data;
+  return;
+}
+
+/*!
+  Returns the floating point operations of one multigrid cycle of the given type on the level of A.
+  As for the V-cycle, each visit of a level counts numSpMVs matrix-vector products with its matrix;
+  W- and F-cycles add the coarse residual and update of their second coarse cycle, and K-cycles the
+  coarse products and vector operations of their two GCR iterations.
+ */
+template<class SparseMatrix_type>
+static double MGCycleFlops(const SparseMatrix_type & A, int cycleType, double numSpMVs) {
+  double flops = 2.0*numSpMVs*((double) A.totalNumberOfNonzeros);
+  const SparseMatrix_type * Af = ActiveLevelMatrix(&A);
+  if (Af->mgData==0) return flops;
+  const SparseMatrix_type & Ac = *Af->Ac;
+  double spmv = 2.0*((double) Ac.totalNumberOfNonzeros), n = Ac.totalNumberOfRows;
+  if (cycleType==HPGMP_MG_W_CYCLE)
+    flops += 2.0*MGCycleFlops(Ac, cycleType, numSpMVs) + spmv + 4.0*n;
+  else if (cycleType==HPGMP_MG_F_CYCLE)
+    flops += MGCycleFlops(Ac, cycleType, numSpMVs) + MGCycleFlops(Ac, HPGMP_MG_V_CYCLE, numSpMVs) + spmv + 4.0*n;
+  else if (cycleType==HPGMP_MG_K_CYCLE)
+    flops += 2.0*MGCycleFlops(Ac, cycleType, numSpMVs) + 2.0*spmv + 17.0*n;
+  else
+    flops += MGCycleFlops(Ac, cycleType, numSpMVs);
+  return flops;
+}
 
 /*!
   Routine to generate a sparse matrix, right hand side, initial guess, and exact solution.
@@ -30,44 +160,179 @@
   @param[inout] b      The newly allocated and generated right hand side vector (if b!=0 on entry)
   @param[inout] x      The newly allocated solution vector with entries set to 0.0 (if x!=0 on entry)
   @param[inout] xexact The newly allocated solution vector with entries set to the exact solution (if the xexact!=0 non-zero on entry)
+  @param[in]  numberOfMgLevels Number of multigrid levels, unless params.numberOfMgLevels is set
+  @param[in]  params   The run parameters; if params.matrixFile is set, the matrix is read from it and coarsened by aggregation,
+                       and if params.snapshot is set, the hierarchy is mapped from (or saved to) a problem snapshot.
+                       Coarse levels with fewer than params.agglomerationThreshold local rows are agglomerated,
+                       and the coarsest level is solved directly if params.coarseSolver is set.
 
   @see GenerateGeometry
+  @see ReadProblemSnapshot
+  @see ReadProblem
+  @see GenerateAggregationCoarseProblem
+  @see AgglomerateProblem
+  @see SetupCoarseSolver
 */
 
 template<class SparseMatrix_type, class GMRESData_type, class Vector_type>
 void SetupMatrix(int numberOfMgLevels, SparseMatrix_type & A, Geometry * geom, GMRESData_type & data,
-                 Vector_type * b, Vector_type * x, Vector_type * xexact, bool init_vect, comm_type comm) {
+                 Vector_type * b, Vector_type * x, Vector_type * xexact, bool init_vect, comm_type comm,
+                 const HPGMP_Params & params) {
 
   InitializeSparseMatrix(A, geom, comm);
+  if (params.numberOfMgLevels>0) numberOfMgLevels = params.numberOfMgLevels;
 
-  GenerateNonsymProblem(A, b, x, xexact, init_vect);
-  SetupHalo(A); //TODO: This is currently called in main... Should it really be called in both places?  Which one? 
+  if (params.matrixFile[0]!='\0') {
+    // Imported matrices are not snapshotted: the snapshot is keyed on the generated geometry
+#if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
+    AbortImport(params.matrixFile, "(not supported in GPU builds) reading", -1, comm);
+#endif
+    int ierr = ReadProblem(params.matrixFile, A, b, x, xexact, init_vect);
+    if (ierr) AbortImport(params.matrixFile, "reading", ierr, comm);
+    SetupHalo(A);
 
-  A.localNumberOfMGNonzeros = A.localNumberOfNonzeros;
-  A.totalNumberOfMGNonzeros = A.totalNumberOfNonzeros;
+    SparseMatrix_type * curLevelMatrix = &A;
+    for (int level = 1; level< numberOfMgLevels; ++level) {
+      ierr = GenerateAggregationCoarseProblem(*curLevelMatrix);
+      if (ierr) AbortImport(params.matrixFile, "coarsening", ierr, comm);
+      curLevelMatrix = curLevelMatrix->Ac;
+    }
+  } else {
+    numberOfMgLevels = CapNumberOfMgLevels(geom, numberOfMgLevels);
 
-  SparseMatrix_type * curLevelMatrix = &A;
-  for (int level = 1; level< numberOfMgLevels; ++level) {
-    GenerateNonsymCoarseProblem(*curLevelMatrix);
-    A.localNumberOfMGNonzeros += curLevelMatrix->Ac->localNumberOfNonzeros;
-    A.totalNumberOfMGNonzeros += curLevelMatrix->Ac->totalNumberOfNonzeros;
-    curLevelMatrix = curLevelMatrix->Ac; // Make the just-constructed coarse grid the next level
-  }
+    // Snapshots hold the levels of one process, which agglomeration moves to other processes
+    bool useSnapshot = params.snapshot && params.agglomerationThreshold<=0;
+    bool fromSnapshot = useSnapshot && ReadProblemSnapshot(numberOfMgLevels, A, geom, b, x, xexact, init_vect, comm)==0;
+    if (!fromSnapshot) {
+      GenerateNonsymProblem(A, b, x, xexact, init_vect);
+      SetupHalo(A); //TODO: This is currently called in main... Should it really be called in both places?  Which one? 
+
+      SparseMatrix_type * curLevelMatrix = &A;
+      for (int level = 1; level< numberOfMgLevels; ++level) {
+        GenerateNonsymCoarseProblem(*curLevelMatrix);
+        curLevelMatrix = curLevelMatrix->Ac; // Make the just-constructed coarse grid the next level
+        if (AgglomerateProblem(*curLevelMatrix, params.agglomerationThreshold)) {
+          curLevelMatrix = curLevelMatrix->agglomeration->A; // Continue on the active processes
+          if (curLevelMatrix==0) break;
+        }
+      }
 
 //TODO: Reinstate "CheckProblem" for nonsymm version. 
 /*  #ifndef NONSYMM_PROBLEM
-  curLevelMatrix = &A;
-  Vector_type * curb = b;
-  Vector_type * curx = x;
-  Vector_type * curxexact = xexact;
-  for (int level = 0; level< numberOfMgLevels; ++level) {
-     CheckProblem(*curLevelMatrix, curb, curx, curxexact);
-     curLevelMatrix = curLevelMatrix->Ac; // Make the nextcoarse grid the next level
-     curb = 0; // No vectors after the top level
-     curx = 0;
-     curxexact = 0;
+      curLevelMatrix = &A;
+      Vector_type * curb = b;
+      Vector_type * curx = x;
+      Vector_type * curxexact = xexact;
+      for (int level = 0; level< numberOfMgLevels; ++level) {
+         CheckProblem(*curLevelMatrix, curb, curx, curxexact);
+         curLevelMatrix = curLevelMatrix->Ac; // Make the nextcoarse grid the next level
+         curb = 0; // No vectors after the top level
+         curx = 0;
+         curxexact = 0;
+      }
+      #endif */
+
+      if (useSnapshot) WriteProblemSnapshot(numberOfMgLevels, A, b, x, xexact, init_vect);
+    }
+  }
+
+  // Multigrid cycle (ComputeMG_ref, used on GPUs, only implements the V-cycle)
+  int cycleType = params.mgCycle;
+#if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
+  if (cycleType!=HPGMP_MG_V_CYCLE && A.geom->rank==0)
+    HPGMP_fout << "Multigrid cycle " << cycleType << " is not available on GPUs, using the V-cycle" << std::endl;
+  cycleType = HPGMP_MG_V_CYCLE;
+#endif
+  if (cycleType<HPGMP_MG_V_CYCLE || cycleType>HPGMP_MG_ADDITIVE_CYCLE) cycleType = HPGMP_MG_V_CYCLE;
+
+  // Smoother (ComputeMG_ref, used on GPUs, only implements Gauss-Seidel)
+  int smoother = params.smoother;
+#if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
+  if (smoother!=HPGMP_SMOOTHER_GAUSS_SEIDEL && A.geom->rank==0)
+    HPGMP_fout << "Multigrid smoother " << smoother << " is not available on GPUs, using Gauss-Seidel" << std::endl;
+  smoother = HPGMP_SMOOTHER_GAUSS_SEIDEL;
+#endif
+  if (smoother<HPGMP_SMOOTHER_GAUSS_SEIDEL || smoother>HPGMP_SMOOTHER_HYBRID_GAUSS_SEIDEL) smoother = HPGMP_SMOOTHER_GAUSS_SEIDEL;
+
+  // Ordering of the local rows, applied by OptimizeProblem (see ReorderProblem)
+  int rowOrdering = params.rowOrdering;
+#if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
+  if (rowOrdering!=HPGMP_ROW_ORDER_LEXICOGRAPHIC && A.geom->rank==0)
+    HPGMP_fout << "Row ordering " << rowOrdering << " is not available on GPUs, using the lexicographic ordering" << std::endl;
+  rowOrdering = HPGMP_ROW_ORDER_LEXICOGRAPHIC;
+#endif
+  if (rowOrdering<HPGMP_ROW_ORDER_LEXICOGRAPHIC || rowOrdering>HPGMP_ROW_ORDER_MORTON) rowOrdering = HPGMP_ROW_ORDER_LEXICOGRAPHIC;
+  A.rowOrdering = rowOrdering;
+
+  // Format of the matrix in the optimized SpMV and Gauss-Seidel kernels, set up by OptimizeProblem (see SetupStencilMatrix
+  // and SetupCompressedIndices)
+  int matrixFormat = params.matrixFormat;
+#if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
+  if (matrixFormat!=HPGMP_MATRIX_FORMAT_CSR && A.geom->rank==0)
+    HPGMP_fout << "Matrix format " << matrixFormat << " is not available on GPUs, using CSR" << std::endl;
+  matrixFormat = HPGMP_MATRIX_FORMAT_CSR;
+#endif
+  if (matrixFormat<HPGMP_MATRIX_FORMAT_CSR || matrixFormat>HPGMP_MATRIX_FORMAT_COMPRESSED) matrixFormat = HPGMP_MATRIX_FORMAT_CSR;
+  A.matrixFormat = matrixFormat;
+
+  // The levels of the additive cycle are smoothed concurrently when their smoothing needs neither
+  // communication nor threads of its own: a single Gauss-Seidel sweep from a zero initial guess
+  if (cycleType==HPGMP_MG_ADDITIVE_CYCLE && A.mgData!=0) {
+    bool concurrent = smoother==HPGMP_SMOOTHER_GAUSS_SEIDEL && params.numberOfPresmootherSteps<=1 && !params.coarseSolver;
+    if (!SetupAdditiveCycle(A, concurrent)) {
+      if (A.geom->rank==0)
+        HPGMP_fout << "The additive multigrid cycle needs injection on all levels and no agglomeration, using the V-cycle" << std::endl;
+      cycleType = HPGMP_MG_V_CYCLE;
+    }
+  }
+
+  // Smoothing steps, smoother, cycle and nonzero counts over the whole hierarchy (agglomerated levels are counted once)
+  A.localNumberOfMGNonzeros = 0;
+  A.totalNumberOfMGNonzeros = 0;
+  for (const SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; ) {
+    A.localNumberOfMGNonzeros += curLevelMatrix->localNumberOfNonzeros;
+    A.totalNumberOfMGNonzeros += curLevelMatrix->totalNumberOfNonzeros;
+    curLevelMatrix = ActiveLevelMatrix(curLevelMatrix);
+    SetupSmoother(*curLevelMatrix, smoother);
+    if (curLevelMatrix->mgData!=0) {
+      if (params.numberOfPresmootherSteps>0) curLevelMatrix->mgData->numberOfPresmootherSteps = params.numberOfPresmootherSteps;
+      if (params.numberOfPostsmootherSteps>0) curLevelMatrix->mgData->numberOfPostsmootherSteps = params.numberOfPostsmootherSteps;
+      SetupMGCycle(*curLevelMatrix, cycleType);
+    }
+    curLevelMatrix = curLevelMatrix->Ac;
+  }
+  // A Chebyshev smoothing step costs one matrix-vector product per degree of its polynomial, the other smoothers one;
+  // each level of the additive cycle only applies its pre-smoothing steps, without computing a residual
+  A.totalNumberOfMGFlops = 0.0;
+  if (A.mgData!=0) {
+    bool isChebyshev = smoother==HPGMP_SMOOTHER_CHEBYSHEV || smoother==HPGMP_SMOOTHER_JACOBI_CHEBYSHEV;
+    double smootherSpMVs = isChebyshev ? (double) HPGMP_CHEBYSHEV_DEGREE : 1.0;
+    double numSpMVs = 1.0 + smootherSpMVs*(A.mgData->numberOfPresmootherSteps+A.mgData->numberOfPostsmootherSteps);
+    if (cycleType==HPGMP_MG_ADDITIVE_CYCLE) numSpMVs = smootherSpMVs*A.mgData->numberOfPresmootherSteps;
+    // The coarser levels held by this process count the cycles started from them (see main_kernels.cpp)
+    for (SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; curLevelMatrix = curLevelMatrix->Ac) {
+      if (curLevelMatrix->agglomeration!=0 && curLevelMatrix->agglomeration->A!=0) curLevelMatrix = curLevelMatrix->agglomeration->A;
+      if (curLevelMatrix->mgData==0) break;
+      curLevelMatrix->totalNumberOfMGFlops = MGCycleFlops(*curLevelMatrix, cycleType, numSpMVs);
+    }
+  }
+#ifndef HPGMP_NO_MPI
+  // Processes left out by agglomeration do not see the lowest levels
+  if (params.agglomerationThreshold>0) {
+    long long totalNumberOfMGNonzeros = A.totalNumberOfMGNonzeros;
+    MPI_Bcast(&totalNumberOfMGNonzeros, 1, MPI_LONG_LONG, 0, comm);
+    A.totalNumberOfMGNonzeros = totalNumberOfMGNonzeros;
+    MPI_Bcast(&A.totalNumberOfMGFlops, 1, MPI_DOUBLE, 0, comm);
+  }
+#endif
+
+  // Direct solver on the coarsest level, set up by the processes holding it
+  const SparseMatrix_type * coarsest = CoarsestLevelMatrix(&A);
+  if (params.coarseSolver && coarsest!=&A && coarsest->agglomeration==0) {
+    int ierr = SetupCoarseSolver(*coarsest);
+    if (ierr && A.geom->rank==0)
+      HPGMP_fout << "Coarsest level kept its smoother sweep: direct solver setup failed with error " << ierr << std::endl;
   }
-  #endif */
 
   InitializeSparseGMRESData(A, data);
 }
@@ -80,17 +345,17 @@ void SetupMatrix(int numberOfMgLevels, SparseMatrix_type & A, Geometry * geom, G
 template
 void SetupMatrix< SparseMatrix<double>, GMRESData<double>, class Vector<double> >
  (int numberOfMgLevels, SparseMatrix<double> & A, Geometry * geom, GMRESData<double> & data, Vector<double> * b, Vector<double> * x, Vector<double> * xexact,
-  bool init_vect, comm_type comm);
+  bool init_vect, comm_type comm, const HPGMP_Params & params);
 
 template
 void SetupMatrix< SparseMatrix<float>, GMRESData<float>, class Vector<float> >
  (int numberOfMgLevels, SparseMatrix<float> & A, Geometry * geom, GMRESData<float> & data, Vector<float> * b, Vector<float> * x, Vector<float> * xexact,
-  bool init_vect, comm_type comm);
+  bool init_vect, comm_type comm, const HPGMP_Params & params);
 
 
 // mixed
 template
 void SetupMatrix< SparseMatrix<float>, GMRESData<float>, class Vector<double> >
  (int numberOfMgLevels, SparseMatrix<float> & A, Geometry * geom, GMRESData<float> & data, Vector<double> * b, Vector<double> * x, Vector<double> * xexact,
-  bool init_vect, comm_type comm);
+  bool init_vect, comm_type comm, const HPGMP_Params & params);
 
@@ -37,7 +37,14 @@
 #include "Vector.hpp"
 #include "GenerateNonsymProblem.hpp"
 #include "GenerateNonsymCoarseProblem.hpp"
+#include "GenerateAggregationCoarseProblem.hpp"
+#include "ReadProblem.hpp"
+#include "AgglomerateProblem.hpp"
+#include "SetupCoarseSolver.hpp"
 #include "SetupHalo.hpp"
+#include "ProblemSnapshot.hpp"
+#include "ReorderProblem.hpp"
+#include "hpgmp.hpp"
 
 
 
@@ -48,11 +55,16 @@
   @param[inout] b      The newly allocated and generated right hand side vector (if b!=0 on entry)
   @param[inout] x      The newly allocated solution vector with entries set to 0.0 (if x!=0 on entry)
   @param[inout] xexact The newly allocated solution vector with entries set to the exact solution (if the xexact!=0 non-zero on entry)
+  @param[in]  numberOfMgLevels Number of multigrid levels, unless params.numberOfMgLevels is set
+  @param[in]  params   The run parameters; if params.matrixFile is set, the matrix is read from it and coarsened by aggregation,
+                       and if params.snapshot is set, the hierarchy is mapped from (or saved to) a problem snapshot.
+                       Coarse levels with fewer than params.agglomerationThreshold local rows are agglomerated,
+                       and the coarsest level is solved directly if params.coarseSolver is set.
 
   @see GenerateGeometry
 */
 
 template<class SparseMatrix_type, class GMRESData_type, class Vector_type>
 void SetupMatrix(int numberOfMgLevels, SparseMatrix_type & A, Geometry * geom, GMRESData_type & data, Vector_type * b, Vector_type * x, Vector_type * xexact,
-                 bool init_vect, comm_type comm);
+                 bool init_vect, comm_type comm, const HPGMP_Params & params);
 #endif
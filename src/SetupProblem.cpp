@@ -20,6 +20,16 @@
  HPGMP routine
  */
 
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+#include <cstdio>
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
 #include "hpgmp.hpp"
 #include "GenerateGeometry.hpp"
 #include "Geometry.hpp"
@@ -30,10 +40,37 @@
 #include "SetupProblem.hpp"
 #include "CheckAspectRatio.hpp"
 #include "OptimizeProblem.hpp"
+#include "ReorderProblem.hpp"
 
 #include "mytimer.hpp"
 using std::endl;
 
+/*!
+  Returns the resident set size of the process in bytes: the current one on Linux, the peak one on
+  other POSIX systems, and 0 where neither is available.
+ */
+static double ResidentSetSize() {
+#if defined(__linux__)
+  long pages = 0, residentPages = 0;
+  FILE * statm = fopen("/proc/self/statm", "r");
+  if (statm!=0) {
+    if (fscanf(statm, "%ld %ld", &pages, &residentPages)!=2) residentPages = 0;
+    fclose(statm);
+  }
+  return ((double) residentPages)*sysconf(_SC_PAGESIZE);
+#elif !defined(_WIN32)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage)!=0) return 0.0;
+#if defined(__APPLE__)
+  return (double) usage.ru_maxrss; // in bytes
+#else
+  return ((double) usage.ru_maxrss)*1024.0; // in kilobytes
+#endif
+#else
+  return 0.0;
+#endif
+}
+
 /*!
   Routine to generate a sparse matrix, right hand side, initial guess, and exact solution.
 
@@ -71,22 +108,34 @@ void SetupProblem(const char *title, int argc, char ** argv, comm_type comm, int
   bool init_vect = true;
   Vector_type xexact;
   double setup_time = mytimer();
-  SetupMatrix(numberOfMgLevels, A, geom, data, &b, &x, &xexact, init_vect, comm);
+  SetupMatrix(numberOfMgLevels, A, geom, data, &b, &x, &xexact, init_vect, comm, params);
 
   // Setup single-precision A 
   init_vect = false;
-  SetupMatrix(numberOfMgLevels, A2, geom, data2, &b, &x, &xexact, init_vect, comm);
+  SetupMatrix(numberOfMgLevels, A2, geom, data2, &b, &x, &xexact, init_vect, comm, params);
   setup_time = mytimer() - setup_time; // Capture total time of setup
   //times[9] = setup_time; // Save it for reporting
   test_data.SetupTime = setup_time;
 
+  // Memory footprint of the two hierarchies
+  double setup_memory[2] = {ResidentSetSize(), (double) (HierarchyArenaSize(A) + HierarchyArenaSize(A2))};
+#ifndef HPGMP_NO_MPI
+  MPI_Allreduce(MPI_IN_PLACE, setup_memory, 2, MPI_DOUBLE, MPI_MAX, comm);
+#endif
+  test_data.SetupRSS = setup_memory[0];
+  test_data.SetupArenaSize = setup_memory[1];
+
   //////////////////////////////////////////////////////////
   // Call user-tunable set up function for A
   double opt_time = mytimer();
+  std::vector<global_int_t> generatedRows(A.localToGlobalMap.begin(), A.localToGlobalMap.begin() + A.localNumberOfRows);
   OptimizeProblem(A, data, b, x, xexact);
 
   // Call user-tunable set up function for A2
   OptimizeProblem(A2, data, b, x, xexact);
+
+  // Both hierarchies are reordered alike (see ReorderProblem), and the vectors follow them once
+  PermuteProblemVectors(A, generatedRows, b, x, xexact);
   opt_time = mytimer() - opt_time; // Capture total time of setup
   //times[7] = opt_time;
   test_data.OptimizeTime = opt_time;
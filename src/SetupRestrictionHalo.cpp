@@ -0,0 +1,134 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file SetupRestrictionHalo.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#include <vector>
+#endif
+
+#include "SetupRestrictionHalo.hpp"
+
+/*!
+  Prepares the halo exchange of ComputeResidualRestriction: only the external columns referenced by
+  the rows in f2cOperator are communicated.  Each process tells every neighbor which entries of
+  the message it regularly receives from it are needed, and the neighbor keeps the corresponding
+  subset of its send list.
+
+  Nothing is done for levels without injection (aggregation) and on a single process.
+
+  @param[in] A The fine level matrix, whose mgData receives the halo
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see ComputeResidualRestriction
+*/
+template<class SparseMatrix_type>
+int SetupRestrictionHalo(const SparseMatrix_type & A) {
+
+#ifndef HPGMP_NO_MPI
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+
+  if (A.mgData==0 || A.mgData->f2cOperator==0 || A.mgData->restrictionHalo!=0) return 0;
+  if (A.geom->size==1) return 0;
+
+  const local_int_t nrow = A.localNumberOfRows;
+  const local_int_t nc = A.mgData->rc->localLength;
+  const local_int_t * f2c = A.mgData->f2cOperator;
+  const int numberOfNeighbors = A.numberOfSendNeighbors;
+
+  // Mark the external columns of the injected rows
+  std::vector<char> needed(A.localNumberOfColumns-nrow, 0);
+  for (local_int_t i=0; i<nc; ++i) {
+    const local_int_t * const cur_inds = A.mtxIndL[f2c[i]];
+    const int cur_nnz = A.nonzerosInRow[f2c[i]];
+    for (int j=0; j<cur_nnz; ++j)
+      if (cur_inds[j]>=nrow) needed[cur_inds[j]-nrow] = 1;
+  }
+
+  // Positions of the needed entries within the message from each neighbor
+  RestrictionHaloData<scalar_type> * halo = new RestrictionHaloData<scalar_type>;
+  halo->receiveLength = new local_int_t[numberOfNeighbors];
+  halo->sendLength = new local_int_t[numberOfNeighbors];
+  std::vector<local_int_t> positions, receiveOffsets(numberOfNeighbors+1, 0);
+  local_int_t offset = 0;
+  for (int k=0; k<numberOfNeighbors; ++k) {
+    for (local_int_t p=0; p<A.receiveLength[k]; ++p)
+      if (needed[offset+p]) positions.push_back(p);
+    offset += A.receiveLength[k];
+    receiveOffsets[k+1] = positions.size();
+    halo->receiveLength[k] = receiveOffsets[k+1] - receiveOffsets[k];
+  }
+  halo->totalToBeReceived = positions.size();
+  halo->externalColumns = new local_int_t[halo->totalToBeReceived];
+  offset = nrow;
+  for (int k=0; k<numberOfNeighbors; ++k) {
+    for (local_int_t j=receiveOffsets[k]; j<receiveOffsets[k+1]; ++j) halo->externalColumns[j] = offset + positions[j];
+    offset += A.receiveLength[k];
+  }
+
+  // Exchange the counts, then the positions
+  int MPI_MY_TAG = 97;
+  std::vector<MPI_Request> requests(2*numberOfNeighbors);
+  for (int k=0; k<numberOfNeighbors; ++k) {
+    MPI_Irecv(halo->sendLength+k, 1, MPI_INT, A.neighbors[k], MPI_MY_TAG, A.comm, &requests[k]);
+    MPI_Isend(halo->receiveLength+k, 1, MPI_INT, A.neighbors[k], MPI_MY_TAG, A.comm, &requests[numberOfNeighbors+k]);
+  }
+  MPI_Waitall(2*numberOfNeighbors, requests.data(), MPI_STATUSES_IGNORE);
+
+  std::vector<local_int_t> sendOffsets(numberOfNeighbors+1, 0);
+  for (int k=0; k<numberOfNeighbors; ++k) sendOffsets[k+1] = sendOffsets[k] + halo->sendLength[k];
+  halo->totalToBeSent = sendOffsets[numberOfNeighbors];
+  halo->elementsToSend = new local_int_t[halo->totalToBeSent];
+  for (int k=0; k<numberOfNeighbors; ++k) {
+    MPI_Irecv(halo->elementsToSend+sendOffsets[k], halo->sendLength[k], MPI_INT, A.neighbors[k], MPI_MY_TAG, A.comm, &requests[k]);
+    MPI_Isend(positions.data()+receiveOffsets[k], halo->receiveLength[k], MPI_INT, A.neighbors[k], MPI_MY_TAG, A.comm, &requests[numberOfNeighbors+k]);
+  }
+  MPI_Waitall(2*numberOfNeighbors, requests.data(), MPI_STATUSES_IGNORE);
+
+  // Translate the positions into local rows using the regular send lists
+  offset = 0;
+  for (int k=0; k<numberOfNeighbors; ++k) {
+    for (local_int_t j=sendOffsets[k]; j<sendOffsets[k+1]; ++j)
+      halo->elementsToSend[j] = A.elementsToSend[offset + halo->elementsToSend[j]];
+    offset += A.sendLength[k];
+  }
+
+  halo->sendBuffer = new scalar_type[halo->totalToBeSent];
+  halo->receiveBuffer = new scalar_type[halo->totalToBeReceived];
+  A.mgData->restrictionHalo = halo;
+#else
+  (void) A;
+#endif
+
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int SetupRestrictionHalo< SparseMatrix<double> >(SparseMatrix<double> const&);
+
+template
+int SetupRestrictionHalo< SparseMatrix<float> >(SparseMatrix<float> const&);
@@ -0,0 +1,213 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file SetupStencilMatrix.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#include "Utils_MPI.hpp"
+#endif
+
+#include <algorithm>
+#include <vector>
+#include "SetupStencilMatrix.hpp"
+
+/*!
+  Computes the grid point (ix,iy,iz) of the local grid of A at the global row index, possibly in
+  the ghost layer, and returns false if it is outside of the padded local grid.
+ */
+template<class SparseMatrix_type>
+static bool LocalGridPoint(const SparseMatrix_type & A, global_int_t index, local_int_t & ix, local_int_t & iy, local_int_t & iz) {
+  const Geometry & geom = *A.geom;
+  global_int_t gix = index%geom.gnx - geom.gix0;
+  global_int_t giy = (index/geom.gnx)%geom.gny - geom.giy0;
+  global_int_t giz = index/(geom.gnx*geom.gny) - geom.giz0;
+  if (gix<-1 || gix>geom.nx || giy<-1 || giy>geom.ny || giz<-1 || giz>geom.nz) return false;
+  ix = gix; iy = giy; iz = giz;
+  return true;
+}
+
+#ifndef HPGMP_NO_MPI
+/*!
+  Creates the datatype of a message made of the given cells of the padded vector, in this order:
+  a subarray of the padded box when the cells fill a box in lexicographic order, as the faces,
+  edges and corners exchanged by generated problems do, and the contiguous runs of cells otherwise.
+ */
+template<class StencilData_type>
+static void CreatePaddedType(const StencilData_type & stencil, const local_int_t * cells, local_int_t numberOfCells,
+                             MPI_Datatype scalarType, MPI_Datatype & type) {
+
+  const int px = stencil.nx+2, py = stencil.ny+2, pz = stencil.nz+2;
+  int lower[3] = {pz, py, px}, upper[3] = {-1, -1, -1};
+  bool isIncreasing = true;
+  for (local_int_t i=0; i<numberOfCells; ++i) {
+    int point[3] = {cells[i]/(px*py), (cells[i]/px)%py, cells[i]%px};
+    for (int d=0; d<3; ++d) {
+      lower[d] = std::min(lower[d], point[d]);
+      upper[d] = std::max(upper[d], point[d]);
+    }
+    if (i>0 && cells[i]<=cells[i-1]) isIncreasing = false;
+  }
+
+  if (numberOfCells==0) {
+    MPI_Type_contiguous(0, scalarType, &type);
+  } else if (isIncreasing && ((local_int_t) (upper[0]-lower[0]+1))*(upper[1]-lower[1]+1)*(upper[2]-lower[2]+1)==numberOfCells) {
+    int sizes[3] = {pz, py, px};
+    int subsizes[3] = {upper[0]-lower[0]+1, upper[1]-lower[1]+1, upper[2]-lower[2]+1};
+    MPI_Type_create_subarray(3, sizes, subsizes, lower, MPI_ORDER_C, scalarType, &type);
+  } else {
+    std::vector<int> blockLengths, displacements;
+    for (local_int_t i=0; i<numberOfCells; ++i) {
+      if (i>0 && cells[i]==cells[i-1]+1) {
+        ++blockLengths.back();
+      } else {
+        blockLengths.push_back(1);
+        displacements.push_back(cells[i]);
+      }
+    }
+    MPI_Type_indexed(blockLengths.size(), blockLengths.data(), displacements.data(), scalarType, &type);
+  }
+  MPI_Type_commit(&type);
+  return;
+}
+#endif
+
+/*!
+  Sets up the DIA format of the level of A (see StencilData) when the DIA format is requested and
+  the local rows are the points of the local grid in lexicographic order, which is the case for
+  the generated levels unless the rows are reordered (see ReorderProblem), imported or agglomerated.
+  Other levels keep the CSR format.
+
+  Each column is located on the padded local grid from its global index (mtxIndG), so that the coefficients
+  of a row go to the planes of their stencil points and the external columns to their ghost cells;
+  the level keeps the CSR format if an external column is not in the ghost layer.  A row referencing
+  a column that is not one of its stencil neighbors, or without a diagonal, is a fallback row.  The
+  CSR arrays are kept for the reference kernels.
+
+  The halo of the padded vector is exchanged with datatypes describing the cells sent to and
+  received from each neighbor, in the order of the messages of ExchangeHalo (increasing global
+  index, which is the lexicographic order of the cells on both sides).
+
+  @param[in] A            The matrix of a multigrid level, on exit with the stencil data if set up
+  @param[in] matrixFormat The format requested for the hierarchy (HPGMP_MATRIX_FORMAT_CSR or HPGMP_MATRIX_FORMAT_DIA)
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSPMV_stencil
+  @see ComputeGS_Forward_stencil
+*/
+template<class SparseMatrix_type>
+int SetupStencilMatrix(const SparseMatrix_type & A, int matrixFormat) {
+
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  if (matrixFormat!=HPGMP_MATRIX_FORMAT_DIA || A.stencilData!=0) return 0;
+
+  const Geometry & geom = *A.geom;
+  const local_int_t nrow = A.localNumberOfRows;
+  const local_int_t ncol = A.localNumberOfColumns;
+  if (A.rowPartition!=0 || A.agglomeration!=0 || nrow==0 || ((global_int_t) geom.nx)*geom.ny*geom.nz!=nrow) return 0;
+  if (A.localToGlobalMap.size()<(size_t) nrow) return 0;
+  for (local_int_t i=0; i<nrow; ++i) {
+    local_int_t ix, iy, iz;
+    if (!LocalGridPoint(A, A.localToGlobalMap[i], ix, iy, iz) || ix!=i%geom.nx || iy!=(i/geom.nx)%geom.ny || iz!=i/(geom.nx*geom.ny)) return 0;
+  }
+
+  StencilData<scalar_type> * stencil = new StencilData<scalar_type>;
+  InitializeStencilData(geom, *stencil);
+  const local_int_t paddedLength = (geom.nx+2)*(geom.ny+2)*(geom.nz+2);
+
+  // Padded index of each local column, -1 for the external columns outside of the ghost layer
+  std::vector<local_int_t> columnCells(ncol, -1);
+  for (local_int_t i=0; i<nrow; ++i) columnCells[i] = PaddedIndex(*stencil, i);
+  for (local_int_t i=0; i<nrow && ncol>nrow && A.mtxIndG!=0; ++i)
+    for (int j=0; j<A.nonzerosInRow[i]; ++j) {
+      local_int_t ix, iy, iz, col = A.mtxIndL[i][j];
+      if (col>=nrow && columnCells[col]<0 && LocalGridPoint(A, A.mtxIndG[i][j], ix, iy, iz))
+        columnCells[col] = PaddedIndex(*stencil, ix, iy, iz);
+    }
+  for (local_int_t col=nrow; col<ncol; ++col)
+    if (columnCells[col]<0) {
+      delete stencil;
+      return 0;
+    }
+
+  // Coefficient planes, stencil point of each nonzero found from the offset of its cell
+  stencil->values = AllocateArray<scalar_type>(((size_t) HPGMP_STENCIL_POINTS)*nrow);
+  FirstTouchArray(stencil->values, nrow, HPGMP_STENCIL_POINTS);
+  std::vector<local_int_t> fallbackRows;
+  for (local_int_t i=0; i<nrow; ++i) {
+    const local_int_t cell = columnCells[i];
+    bool isStencilRow = A.matrixDiagonal[i]!=0;
+    int pointsUsed[HPGMP_STENCIL_POINTS] = {0};
+    for (int j=0; j<A.nonzerosInRow[i] && isStencilRow; ++j) {
+      const local_int_t col = A.mtxIndL[i][j];
+      int k = 0;
+      while (k<HPGMP_STENCIL_POINTS && (columnCells[col]<0 || cell+stencil->offsets[k]!=columnCells[col])) ++k;
+      isStencilRow = k<HPGMP_STENCIL_POINTS && !pointsUsed[k]
+                     && (k!=HPGMP_STENCIL_CENTER || &A.matrixValues[i][j]==A.matrixDiagonal[i]);
+      if (!isStencilRow) break;
+      pointsUsed[k] = 1;
+      stencil->values[((size_t) k)*nrow + i] = A.matrixValues[i][j];
+    }
+    if (!isStencilRow || !pointsUsed[HPGMP_STENCIL_CENTER]) {
+      for (int k=0; k<HPGMP_STENCIL_POINTS; ++k) stencil->values[((size_t) k)*nrow + i] = 0.0;
+      fallbackRows.push_back(i);
+    }
+  }
+  fallbackRows.push_back(nrow);
+
+  stencil->paddedVector = AllocateArray<scalar_type>(paddedLength);
+  FirstTouchArray(stencil->paddedVector, paddedLength); // The ghost cells beyond the global boundary stay zero
+  stencil->numberOfExternalCells = ncol-nrow;
+  stencil->externalCells = new local_int_t[ncol-nrow];
+  std::copy(columnCells.begin()+nrow, columnCells.end(), stencil->externalCells);
+  stencil->numberOfFallbackRows = fallbackRows.size()-1;
+  stencil->fallbackRows = new local_int_t[fallbackRows.size()];
+  std::copy(fallbackRows.begin(), fallbackRows.end(), stencil->fallbackRows);
+
+#ifndef HPGMP_NO_MPI
+  MPI_Datatype MPI_SCALAR_TYPE = MpiTypeTraits<scalar_type>::getType ();
+  stencil->numberOfNeighbors = A.numberOfSendNeighbors;
+  stencil->sendTypes = new MPI_Datatype[A.numberOfSendNeighbors];
+  stencil->receiveTypes = new MPI_Datatype[A.numberOfSendNeighbors];
+  std::vector<local_int_t> sendCells(A.totalToBeSent);
+  for (local_int_t i=0; i<A.totalToBeSent; ++i) sendCells[i] = columnCells[A.elementsToSend[i]];
+  for (int i=0, sendOffset=0, receiveOffset=nrow; i<A.numberOfSendNeighbors; ++i) {
+    CreatePaddedType(*stencil, sendCells.data()+sendOffset, A.sendLength[i], MPI_SCALAR_TYPE, stencil->sendTypes[i]);
+    CreatePaddedType(*stencil, columnCells.data()+receiveOffset, A.receiveLength[i], MPI_SCALAR_TYPE, stencil->receiveTypes[i]);
+    sendOffset += A.sendLength[i];
+    receiveOffset += A.receiveLength[i];
+  }
+#endif
+
+  A.stencilData = stencil;
+  return 0;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+int SetupStencilMatrix< SparseMatrix<double> >(SparseMatrix<double> const&, int);
+
+template
+int SetupStencilMatrix< SparseMatrix<float> >(SparseMatrix<float> const&, int);
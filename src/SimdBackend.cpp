@@ -0,0 +1,482 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file SimdBackend.cpp
+
+ HPGMP routine
+ */
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include "SimdBackend.hpp"
+#include "RowRunData.hpp"
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(HPGMP_NO_SIMD)
+#define HPGMP_SIMD_X86
+#include <immintrin.h>
+#if !defined(__clang__)
+// The products and sums of SpMV and WAXPBY are rounded separately, like in the C++ loops
+#pragma GCC optimize ("fp-contract=off")
+#endif
+#define HPGMP_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define HPGMP_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+static int simdLevel = HPGMP_SIMD_SCALAR; //!< kernels selected by SetupSimdBackend
+
+/*!
+  Selects the widest SIMD kernels supported by the CPU running the benchmark (queried with cpuid through
+  the compiler builtins), so that one binary runs on hosts with and without AVX2 or AVX-512.
+
+  @param[in] maximumLevel the widest kernels allowed (HPGMP_SIMD_SCALAR, HPGMP_SIMD_AVX2 or HPGMP_SIMD_AVX512), or -1 for no limit
+
+  @return returns the selected level
+*/
+int SetupSimdBackend(int maximumLevel) {
+  int level = HPGMP_SIMD_SCALAR;
+#ifdef HPGMP_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    level = HPGMP_SIMD_AVX2;
+    if (__builtin_cpu_supports("avx512f")) level = HPGMP_SIMD_AVX512;
+  }
+#endif
+  if (maximumLevel>=0 && maximumLevel<level) level = maximumLevel;
+  simdLevel = level;
+  return level;
+}
+
+int GetSimdLevel() {
+  return simdLevel;
+}
+
+const char * GetSimdLevelName() {
+  if (simdLevel==HPGMP_SIMD_AVX512) return "AVX-512";
+  if (simdLevel==HPGMP_SIMD_AVX2) return "AVX2";
+  return "Scalar";
+}
+
+#ifdef HPGMP_SIMD_X86
+
+/* ------------------------------------------------------------------------------ *
+ * SpMV of full rows: one row per lane, gathering the nonzeros of a column of the *
+ * rows at a time, so that each row sums its products in the order of Row::Add   *
+ * ------------------------------------------------------------------------------ */
+
+HPGMP_TARGET_AVX2
+static local_int_t SPMVFullRows_avx2(const double * values, const local_int_t * columns, const double * xv, double * yv, local_int_t numberOfRows) {
+  const __m128i rows = _mm_setr_epi32(0, 1, 2, 3);
+  const __m128i stride = _mm_mullo_epi32(rows, _mm_set1_epi32(HPGMP_FULL_ROW_LENGTH));
+  const __m128i allColumns = _mm_set1_epi32(-1);
+  const __m256d allValues = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+  local_int_t i = 0;
+  for (; i+4<=numberOfRows; i+=4) {
+    const double * const v = values + ((size_t) i)*HPGMP_FULL_ROW_LENGTH;
+    const int * const c = columns + ((size_t) i)*HPGMP_FULL_ROW_LENGTH;
+    __m256d sum = _mm256_setzero_pd();
+    for (int j=0; j<HPGMP_FULL_ROW_LENGTH; ++j) {
+      const __m128i index = _mm_add_epi32(stride, _mm_set1_epi32(j));
+      const __m128i col = _mm_mask_i32gather_epi32(_mm_setzero_si128(), c, index, allColumns, 4);
+      sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_mask_i32gather_pd(_mm256_setzero_pd(), v, index, allValues, 8),
+                                             _mm256_mask_i32gather_pd(_mm256_setzero_pd(), xv, col, allValues, 8)));
+    }
+    _mm256_storeu_pd(yv+i, sum);
+  }
+  return i;
+}
+
+HPGMP_TARGET_AVX2
+static local_int_t SPMVFullRows_avx2(const float * values, const local_int_t * columns, const float * xv, float * yv, local_int_t numberOfRows) {
+  const __m256i stride = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(HPGMP_FULL_ROW_LENGTH));
+  const __m256i allColumns = _mm256_set1_epi32(-1);
+  const __m256 allValues = _mm256_castsi256_ps(allColumns);
+  local_int_t i = 0;
+  for (; i+8<=numberOfRows; i+=8) {
+    const float * const v = values + ((size_t) i)*HPGMP_FULL_ROW_LENGTH;
+    const int * const c = columns + ((size_t) i)*HPGMP_FULL_ROW_LENGTH;
+    __m256 sum = _mm256_setzero_ps();
+    for (int j=0; j<HPGMP_FULL_ROW_LENGTH; ++j) {
+      const __m256i index = _mm256_add_epi32(stride, _mm256_set1_epi32(j));
+      const __m256i col = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), c, index, allColumns, 4);
+      sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_mask_i32gather_ps(_mm256_setzero_ps(), v, index, allValues, 4),
+                                             _mm256_mask_i32gather_ps(_mm256_setzero_ps(), xv, col, allValues, 4)));
+    }
+    _mm256_storeu_ps(yv+i, sum);
+  }
+  return i;
+}
+
+HPGMP_TARGET_AVX512
+static local_int_t SPMVFullRows_avx512(const double * values, const local_int_t * columns, const double * xv, double * yv, local_int_t numberOfRows) {
+  const __m256i stride = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(HPGMP_FULL_ROW_LENGTH));
+  const __m256i allColumns = _mm256_set1_epi32(-1);
+  local_int_t i = 0;
+  for (; i+8<=numberOfRows; i+=8) {
+    const double * const v = values + ((size_t) i)*HPGMP_FULL_ROW_LENGTH;
+    const int * const c = columns + ((size_t) i)*HPGMP_FULL_ROW_LENGTH;
+    __m512d sum = _mm512_setzero_pd();
+    for (int j=0; j<HPGMP_FULL_ROW_LENGTH; ++j) {
+      const __m256i index = _mm256_add_epi32(stride, _mm256_set1_epi32(j));
+      const __m256i col = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), c, index, allColumns, 4);
+      sum = _mm512_add_pd(sum, _mm512_mul_pd(_mm512_mask_i32gather_pd(_mm512_setzero_pd(), (__mmask8) 0xFF, index, v, 8),
+                                             _mm512_mask_i32gather_pd(_mm512_setzero_pd(), (__mmask8) 0xFF, col, xv, 8)));
+    }
+    _mm512_storeu_pd(yv+i, sum);
+  }
+  return i;
+}
+
+HPGMP_TARGET_AVX512
+static local_int_t SPMVFullRows_avx512(const float * values, const local_int_t * columns, const float * xv, float * yv, local_int_t numberOfRows) {
+  const __m512i stride = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                                            _mm512_set1_epi32(HPGMP_FULL_ROW_LENGTH));
+  local_int_t i = 0;
+  for (; i+16<=numberOfRows; i+=16) {
+    const float * const v = values + ((size_t) i)*HPGMP_FULL_ROW_LENGTH;
+    const int * const c = columns + ((size_t) i)*HPGMP_FULL_ROW_LENGTH;
+    __m512 sum = _mm512_setzero_ps();
+    for (int j=0; j<HPGMP_FULL_ROW_LENGTH; ++j) {
+      const __m512i index = _mm512_add_epi32(stride, _mm512_set1_epi32(j));
+      const __m512i col = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), (__mmask16) 0xFFFF, index, c, 4);
+      sum = _mm512_add_ps(sum, _mm512_mul_ps(_mm512_mask_i32gather_ps(_mm512_setzero_ps(), (__mmask16) 0xFFFF, index, v, 4),
+                                             _mm512_mask_i32gather_ps(_mm512_setzero_ps(), (__mmask16) 0xFFFF, col, xv, 4)));
+    }
+    _mm512_storeu_ps(yv+i, sum);
+  }
+  return i;
+}
+
+/* ----------------------------------------------------------------- *
+ * float<->double conversions, one register of the narrower type each *
+ * ----------------------------------------------------------------- */
+
+HPGMP_TARGET_AVX2
+static local_int_t ConvertVector_avx2(const double * v, float * w, local_int_t n) {
+  const local_int_t nv = n - n%4;
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nv; i+=4) _mm_storeu_ps(w+i, _mm256_cvtpd_ps(_mm256_loadu_pd(v+i)));
+  return nv;
+}
+
+HPGMP_TARGET_AVX2
+static local_int_t ConvertVector_avx2(const float * v, double * w, local_int_t n) {
+  const local_int_t nv = n - n%4;
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nv; i+=4) _mm256_storeu_pd(w+i, _mm256_cvtps_pd(_mm_loadu_ps(v+i)));
+  return nv;
+}
+
+HPGMP_TARGET_AVX512
+static local_int_t ConvertVector_avx512(const double * v, float * w, local_int_t n) {
+  const local_int_t nv = n - n%8;
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nv; i+=8) _mm256_storeu_ps(w+i, _mm512_maskz_cvtpd_ps((__mmask8) 0xFF, _mm512_loadu_pd(v+i)));
+  return nv;
+}
+
+HPGMP_TARGET_AVX512
+static local_int_t ConvertVector_avx512(const float * v, double * w, local_int_t n) {
+  const local_int_t nv = n - n%8;
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nv; i+=8) _mm512_storeu_pd(w+i, _mm512_maskz_cvtps_pd((__mmask8) 0xFF, _mm256_loadu_ps(v+i)));
+  return nv;
+}
+
+/* ---------------------------------------------------------------------------- *
+ * WAXPBY: w = alpha*x + beta*y, a scaling by one being exact, in all branches  *
+ * of the reference; the mixed kernel scales y in float and converts the result *
+ * ---------------------------------------------------------------------------- */
+
+HPGMP_TARGET_AVX2
+static local_int_t WAXPBY_avx2(local_int_t n, double alpha, const double * xv, double beta, const double * yv, double * wv) {
+  const local_int_t nv = n - n%4;
+  const __m256d a = _mm256_set1_pd(alpha), b = _mm256_set1_pd(beta);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nv; i+=4)
+    _mm256_storeu_pd(wv+i, _mm256_add_pd(_mm256_mul_pd(a, _mm256_loadu_pd(xv+i)), _mm256_mul_pd(b, _mm256_loadu_pd(yv+i))));
+  return nv;
+}
+
+HPGMP_TARGET_AVX2
+static local_int_t WAXPBY_avx2(local_int_t n, float alpha, const float * xv, float beta, const float * yv, float * wv) {
+  const local_int_t nv = n - n%8;
+  const __m256 a = _mm256_set1_ps(alpha), b = _mm256_set1_ps(beta);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nv; i+=8)
+    _mm256_storeu_ps(wv+i, _mm256_add_ps(_mm256_mul_ps(a, _mm256_loadu_ps(xv+i)), _mm256_mul_ps(b, _mm256_loadu_ps(yv+i))));
+  return nv;
+}
+
+HPGMP_TARGET_AVX2
+static local_int_t WAXPBY_avx2(local_int_t n, double alpha, const double * xv, float beta, const float * yv, double * wv) {
+  const local_int_t nv = n - n%4;
+  const __m256d a = _mm256_set1_pd(alpha);
+  const __m128 b = _mm_set1_ps(beta);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nv; i+=4)
+    _mm256_storeu_pd(wv+i, _mm256_add_pd(_mm256_mul_pd(a, _mm256_loadu_pd(xv+i)), _mm256_cvtps_pd(_mm_mul_ps(b, _mm_loadu_ps(yv+i)))));
+  return nv;
+}
+
+HPGMP_TARGET_AVX512
+static local_int_t WAXPBY_avx512(local_int_t n, double alpha, const double * xv, double beta, const double * yv, double * wv) {
+  const local_int_t nv = n - n%8;
+  const __m512d a = _mm512_set1_pd(alpha), b = _mm512_set1_pd(beta);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nv; i+=8)
+    _mm512_storeu_pd(wv+i, _mm512_add_pd(_mm512_mul_pd(a, _mm512_loadu_pd(xv+i)), _mm512_mul_pd(b, _mm512_loadu_pd(yv+i))));
+  return nv;
+}
+
+HPGMP_TARGET_AVX512
+static local_int_t WAXPBY_avx512(local_int_t n, float alpha, const float * xv, float beta, const float * yv, float * wv) {
+  const local_int_t nv = n - n%16;
+  const __m512 a = _mm512_set1_ps(alpha), b = _mm512_set1_ps(beta);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nv; i+=16)
+    _mm512_storeu_ps(wv+i, _mm512_add_ps(_mm512_mul_ps(a, _mm512_loadu_ps(xv+i)), _mm512_mul_ps(b, _mm512_loadu_ps(yv+i))));
+  return nv;
+}
+
+HPGMP_TARGET_AVX512
+static local_int_t WAXPBY_avx512(local_int_t n, double alpha, const double * xv, float beta, const float * yv, double * wv) {
+  const local_int_t nv = n - n%8;
+  const __m512d a = _mm512_set1_pd(alpha);
+  const __m256 b = _mm256_set1_ps(beta);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nv; i+=8)
+    _mm512_storeu_pd(wv+i, _mm512_add_pd(_mm512_mul_pd(a, _mm512_loadu_pd(xv+i)), _mm512_maskz_cvtps_pd((__mmask8) 0xFF, _mm256_mul_ps(b, _mm256_loadu_ps(yv+i)))));
+  return nv;
+}
+
+/* --------------------------------------------------------------------------- *
+ * GEMVT: one column of A per lane, gathering the entries of a row of the      *
+ * columns at a time and sharing the load of x, so that each dot product sums  *
+ * alpha*A(i,j)*x(i) in the order of the reference, a scaling by one being exact *
+ * --------------------------------------------------------------------------- */
+
+HPGMP_TARGET_AVX2
+static local_int_t GEMVT_avx2(local_int_t m, local_int_t n, double alpha, const double * Av, const double * xv, double * yv) {
+  const local_int_t nv = n - n%4;
+  const long long lm = m;
+  const __m256i stride = _mm256_setr_epi64x(0, lm, 2*lm, 3*lm);
+  const __m256d allValues = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+  const __m256d a = _mm256_set1_pd(alpha);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t j=0; j<nv; j+=4) {
+    const double * const column = Av + ((size_t) j)*m;
+    __m256d y = _mm256_loadu_pd(yv+j);
+    for (local_int_t i=0; i<m; i++)
+      y = _mm256_add_pd(y, _mm256_mul_pd(_mm256_mul_pd(a, _mm256_mask_i64gather_pd(_mm256_setzero_pd(), column+i, stride, allValues, 8)), _mm256_set1_pd(xv[i])));
+    _mm256_storeu_pd(yv+j, y);
+  }
+  return nv;
+}
+
+HPGMP_TARGET_AVX2
+static local_int_t GEMVT_avx2(local_int_t m, local_int_t n, float alpha, const float * Av, const float * xv, float * yv) {
+  const local_int_t nv = n - n%4;
+  const long long lm = m;
+  const __m256i stride = _mm256_setr_epi64x(0, lm, 2*lm, 3*lm);
+  const __m128 allValues = _mm_castsi128_ps(_mm_set1_epi32(-1));
+  const __m128 a = _mm_set1_ps(alpha);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t j=0; j<nv; j+=4) {
+    const float * const column = Av + ((size_t) j)*m;
+    __m128 y = _mm_loadu_ps(yv+j);
+    for (local_int_t i=0; i<m; i++)
+      y = _mm_add_ps(y, _mm_mul_ps(_mm_mul_ps(a, _mm256_mask_i64gather_ps(_mm_setzero_ps(), column+i, stride, allValues, 4)), _mm_set1_ps(xv[i])));
+    _mm_storeu_ps(yv+j, y);
+  }
+  return nv;
+}
+
+HPGMP_TARGET_AVX512
+static local_int_t GEMVT_avx512(local_int_t m, local_int_t n, double alpha, const double * Av, const double * xv, double * yv) {
+  const local_int_t nv = n - n%8;
+  const long long lm = m;
+  const __m512i stride = _mm512_setr_epi64(0, lm, 2*lm, 3*lm, 4*lm, 5*lm, 6*lm, 7*lm);
+  const __m512d a = _mm512_set1_pd(alpha);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t j=0; j<nv; j+=8) {
+    const double * const column = Av + ((size_t) j)*m;
+    __m512d y = _mm512_loadu_pd(yv+j);
+    for (local_int_t i=0; i<m; i++)
+      y = _mm512_add_pd(y, _mm512_mul_pd(_mm512_mul_pd(a, _mm512_mask_i64gather_pd(_mm512_setzero_pd(), (__mmask8) 0xFF, stride, column+i, 8)), _mm512_set1_pd(xv[i])));
+    _mm512_storeu_pd(yv+j, y);
+  }
+  return nv;
+}
+
+HPGMP_TARGET_AVX512
+static local_int_t GEMVT_avx512(local_int_t m, local_int_t n, float alpha, const float * Av, const float * xv, float * yv) {
+  const local_int_t nv = n - n%8;
+  const long long lm = m;
+  const __m512i stride = _mm512_setr_epi64(0, lm, 2*lm, 3*lm, 4*lm, 5*lm, 6*lm, 7*lm);
+  const __m256 a = _mm256_set1_ps(alpha);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t j=0; j<nv; j+=8) {
+    const float * const column = Av + ((size_t) j)*m;
+    __m256 y = _mm256_loadu_ps(yv+j);
+    for (local_int_t i=0; i<m; i++)
+      y = _mm256_add_ps(y, _mm256_mul_ps(_mm256_mul_ps(a, _mm512_mask_i64gather_ps(_mm256_setzero_ps(), (__mmask8) 0xFF, stride, column+i, 4)), _mm256_set1_ps(xv[i])));
+    _mm256_storeu_ps(yv+j, y);
+  }
+  return nv;
+}
+
+#endif // HPGMP_SIMD_X86
+
+/*!
+  Computes the rows of y = Ax of numberOfRows consecutive full rows, stored with the stride
+  HPGMP_FULL_ROW_LENGTH from values and columns (see RowRunData).  Each row sums its products in
+  the order of Row<HPGMP_FULL_ROW_LENGTH>::Add, so that the result does not depend on the backend.
+
+  @return returns true if the rows were computed with the SIMD backend, false if the caller computes them
+*/
+template<class SC>
+static bool SimdSPMVFullRows_impl(const SC * values, const local_int_t * columns, const SC * xv, SC * yv, local_int_t numberOfRows) {
+  if (simdLevel==HPGMP_SIMD_SCALAR) return false;
+  local_int_t i = 0;
+#ifdef HPGMP_SIMD_X86
+  if (simdLevel==HPGMP_SIMD_AVX512) i = SPMVFullRows_avx512(values, columns, xv, yv, numberOfRows);
+  else i = SPMVFullRows_avx2(values, columns, xv, yv, numberOfRows);
+#endif
+  for (; i<numberOfRows; ++i)
+    yv[i] = Row<HPGMP_FULL_ROW_LENGTH>::Add(values + ((size_t) i)*HPGMP_FULL_ROW_LENGTH,
+                                            columns + ((size_t) i)*HPGMP_FULL_ROW_LENGTH, xv, (SC) 0.0);
+  return true;
+}
+
+bool SimdSPMVFullRows(const double * values, const local_int_t * columns, const double * xv, double * yv, local_int_t numberOfRows) {
+  return SimdSPMVFullRows_impl(values, columns, xv, yv, numberOfRows);
+}
+
+bool SimdSPMVFullRows(const float * values, const local_int_t * columns, const float * xv, float * yv, local_int_t numberOfRows) {
+  return SimdSPMVFullRows_impl(values, columns, xv, yv, numberOfRows);
+}
+
+/*!
+  Converts the n entries of v into w, with the rounding of the C++ conversions.
+
+  @return returns true if the vector was converted with the SIMD backend, false if the caller converts it
+*/
+template<class scalar_src, class scalar_dst>
+static bool SimdConvertVector_impl(const scalar_src * v, scalar_dst * w, local_int_t n) {
+  if (simdLevel==HPGMP_SIMD_SCALAR) return false;
+  local_int_t i = 0;
+#ifdef HPGMP_SIMD_X86
+  if (simdLevel==HPGMP_SIMD_AVX512) i = ConvertVector_avx512(v, w, n);
+  else i = ConvertVector_avx2(v, w, n);
+#endif
+  for (; i<n; ++i) w[i] = v[i];
+  return true;
+}
+
+bool SimdConvertVector(const double * v, float * w, local_int_t n) {
+  return SimdConvertVector_impl(v, w, n);
+}
+
+bool SimdConvertVector(const float * v, double * w, local_int_t n) {
+  return SimdConvertVector_impl(v, w, n);
+}
+
+/*!
+  Computes w = alpha*x + beta*y with the same roundings as ComputeWAXPBY_ref.
+
+  @return returns true if w was computed with the SIMD backend, false if the caller computes it
+*/
+template<class scalarX_type, class scalarY_type, class scalarW_type>
+static bool SimdWAXPBY_impl(local_int_t n, scalarX_type alpha, const scalarX_type * xv, scalarY_type beta, const scalarY_type * yv, scalarW_type * wv) {
+  if (simdLevel==HPGMP_SIMD_SCALAR) return false;
+  local_int_t i = 0;
+#ifdef HPGMP_SIMD_X86
+  if (simdLevel==HPGMP_SIMD_AVX512) i = WAXPBY_avx512(n, alpha, xv, beta, yv, wv);
+  else i = WAXPBY_avx2(n, alpha, xv, beta, yv, wv);
+#endif
+  for (; i<n; ++i) wv[i] = alpha * xv[i] + beta * yv[i];
+  return true;
+}
+
+bool SimdWAXPBY(local_int_t n, double alpha, const double * xv, double beta, const double * yv, double * wv) {
+  return SimdWAXPBY_impl(n, alpha, xv, beta, yv, wv);
+}
+
+bool SimdWAXPBY(local_int_t n, float alpha, const float * xv, float beta, const float * yv, float * wv) {
+  return SimdWAXPBY_impl(n, alpha, xv, beta, yv, wv);
+}
+
+bool SimdWAXPBY(local_int_t n, double alpha, const double * xv, float beta, const float * yv, double * wv) {
+  return SimdWAXPBY_impl(n, alpha, xv, beta, yv, wv);
+}
+
+/*!
+  Adds alpha times the product of the transpose of the m-by-n column-major matrix A with x to y,
+  with the same roundings as ComputeGEMVT_ref.
+
+  @return returns true if y was updated with the SIMD backend, false if the caller updates it
+*/
+template<class SC>
+static bool SimdGEMVT_impl(local_int_t m, local_int_t n, SC alpha, const SC * Av, const SC * xv, SC * yv) {
+  if (simdLevel==HPGMP_SIMD_SCALAR) return false;
+  local_int_t j = 0;
+#ifdef HPGMP_SIMD_X86
+  if (simdLevel==HPGMP_SIMD_AVX512) j = GEMVT_avx512(m, n, alpha, Av, xv, yv);
+  else j = GEMVT_avx2(m, n, alpha, Av, xv, yv);
+#endif
+  for (; j<n; j++)
+    for (local_int_t i=0; i<m; i++) yv[j] += alpha * Av[i + ((size_t) j)*m] * xv[i];
+  return true;
+}
+
+bool SimdGEMVT(local_int_t m, local_int_t n, double alpha, const double * Av, const double * xv, double * yv) {
+  return SimdGEMVT_impl(m, n, alpha, Av, xv, yv);
+}
+
+bool SimdGEMVT(local_int_t m, local_int_t n, float alpha, const float * Av, const float * xv, float * yv) {
+  return SimdGEMVT_impl(m, n, alpha, Av, xv, yv);
+}
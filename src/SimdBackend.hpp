@@ -0,0 +1,56 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file SimdBackend.hpp
+
+ HPGMP data structure and routines of the explicitly vectorized CPU kernels
+ */
+
+#ifndef SIMDBACKEND_HPP
+#define SIMDBACKEND_HPP
+
+#include "Geometry.hpp"
+
+const int HPGMP_SIMD_SCALAR = 0; //!< no explicit vectorization, the kernels keep their C++ loops
+const int HPGMP_SIMD_AVX2 = 1; //!< 256-bit AVX2 kernels
+const int HPGMP_SIMD_AVX512 = 2; //!< 512-bit AVX-512F kernels
+
+int SetupSimdBackend(int maximumLevel);
+int GetSimdLevel();
+const char * GetSimdLevelName();
+
+bool SimdSPMVFullRows(const double * values, const local_int_t * columns, const double * xv, double * yv, local_int_t numberOfRows);
+bool SimdSPMVFullRows(const float * values, const local_int_t * columns, const float * xv, float * yv, local_int_t numberOfRows);
+
+bool SimdConvertVector(const double * v, float * w, local_int_t n);
+bool SimdConvertVector(const float * v, double * w, local_int_t n);
+/*!
+  Vectors of the same precision are copied by the caller.
+ */
+template<class scalar_src, class scalar_dst>
+inline bool SimdConvertVector(const scalar_src *, scalar_dst *, local_int_t) {
+  return false;
+}
+
+bool SimdWAXPBY(local_int_t n, double alpha, const double * xv, double beta, const double * yv, double * wv);
+bool SimdWAXPBY(local_int_t n, float alpha, const float * xv, float beta, const float * yv, float * wv);
+bool SimdWAXPBY(local_int_t n, double alpha, const double * xv, float beta, const float * yv, double * wv);
+
+bool SimdGEMVT(local_int_t m, local_int_t n, double alpha, const double * Av, const double * xv, double * yv);
+bool SimdGEMVT(local_int_t m, local_int_t n, float alpha, const float * Av, const float * xv, float * yv);
+
+#endif // SIMDBACKEND_HPP
@@ -0,0 +1,96 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file SmootherData.hpp
+
+ HPGMP data structure
+ */
+
+#ifndef SMOOTHERDATA_HPP
+#define SMOOTHERDATA_HPP
+
+#include "DataTypes.hpp"
+
+const int HPGMP_SMOOTHER_GAUSS_SEIDEL = 0; //!< Gauss-Seidel sweeps (ComputeGS_Forward or ComputeSYMGS)
+const int HPGMP_SMOOTHER_CHEBYSHEV = 1; //!< Chebyshev polynomial in the matrix
+const int HPGMP_SMOOTHER_JACOBI_CHEBYSHEV = 2; //!< Chebyshev polynomial in the Jacobi-preconditioned matrix
+const int HPGMP_SMOOTHER_L1_JACOBI = 3; //!< Jacobi with l1 diagonal correction
+const int HPGMP_SMOOTHER_HYBRID_GAUSS_SEIDEL = 4; //!< Gauss-Seidel within thread blocks, Jacobi across them, with l1 diagonal correction
+
+const int HPGMP_CHEBYSHEV_DEGREE = 2; //!< degree of the Chebyshev polynomial applied by one smoothing step
+const double HPGMP_CHEBYSHEV_EIG_RATIO = 30.0; //!< ratio of the largest to the smallest eigenvalue damped by the polynomial
+const int HPGMP_CHEBYSHEV_ARNOLDI_STEPS = 10; //!< Arnoldi steps estimating the largest eigenvalue
+const int HPGMP_CHEBYSHEV_RITZ_ITERATIONS = 200; //!< power iterations computing the largest Ritz value of the Arnoldi steps
+
+/*!
+  Smoother of one multigrid level, stored in the optimizationData of its matrix (see ComputeSmoother).
+ */
+template<class SC>
+class SmootherData {
+public:
+  int type; //!< one of the HPGMP_SMOOTHER_ constants
+  int degree; //!< degree of the Chebyshev polynomial
+  double lambdaMax; //!< upper bound of the eigenvalues damped by the polynomial, estimated by OptimizeProblem
+  double lambdaMin; //!< lower bound of the eigenvalues damped by the polynomial
+  SC * inverseDiagonal; //!< inverse of the matrix diagonal, with the l1 correction for the l1 smoothers (0 if not used)
+  SC * work; //!< last update of the Chebyshev or Jacobi iteration, or x before a hybrid Gauss-Seidel sweep (number of local rows)
+  int numberOfBlocks; //!< number of row blocks of the hybrid Gauss-Seidel smoother, one per thread
+  local_int_t * blockStart; //!< first row of each block (numberOfBlocks + 1 entries), blocks are made of whole z-planes of the local grid
+};
+
+/*!
+  Returns the smoother data of the level of A, 0 if its smoother is not set up.
+ */
+template<class SparseMatrix_type>
+inline SmootherData<typename SparseMatrix_type::scalar_type> * GetSmootherData(const SparseMatrix_type & A) {
+  return (SmootherData<typename SparseMatrix_type::scalar_type> *) A.optimizationData;
+}
+
+/*!
+ Constructor for the smoother data.
+
+ @param[in] type the smoother
+ @param[out] data the smoother data, whose polynomial is set up by OptimizeProblem
+ */
+template<class SmootherData_type>
+inline void InitializeSmootherData(int type, SmootherData_type & data) {
+  data.type = type;
+  data.degree = HPGMP_CHEBYSHEV_DEGREE;
+  data.lambdaMax = 0.0;
+  data.lambdaMin = 0.0;
+  data.inverseDiagonal = 0;
+  data.work = 0;
+  data.numberOfBlocks = 0;
+  data.blockStart = 0;
+  return;
+}
+
+/*!
+ Destructor for the smoother data.
+
+ @param[inout] data the smoother data structure whose storage is deallocated
+ */
+template<class SmootherData_type>
+inline void DeleteSmootherData(SmootherData_type & data) {
+
+  delete [] data.inverseDiagonal;
+  delete [] data.work;
+  delete [] data.blockStart;
+  return;
+}
+
+#endif // SMOOTHERDATA_HPP
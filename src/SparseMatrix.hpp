@@ -25,10 +25,19 @@
 
 #include <vector>
 #include <cassert>
+#include <algorithm>
 #include "DataTypes.hpp"
 #include "Geometry.hpp"
 #include "Vector.hpp"
+#include "MemoryAllocation.hpp"
+#include "MemoryArena.hpp"
 #include "MGData.hpp"
+#include "AgglomerationData.hpp"
+#include "CoarseSolverData.hpp"
+#include "SmootherData.hpp"
+#include "StencilData.hpp"
+#include "CompressedIndexData.hpp"
+#include "RowRunData.hpp"
 #if __cplusplus < 201103L
 // for C++03
 #include <map>
@@ -43,6 +52,8 @@ using GlobalToLocalMap = std::unordered_map< global_int_t, local_int_t >;
  #include <mpi.h>
 #endif
 
+#include <sys/mman.h>
+
 
 template <class SC = double>
 class SparseMatrix {
@@ -57,6 +68,11 @@ public:
   local_int_t localNumberOfColumns;  //!< number of columns local to this process
   local_int_t localNumberOfNonzeros;  //!< number of nonzeros local to this process
   local_int_t localNumberOfMGNonzeros;  //!< number of nonzeros local to this process, for MG
+  double totalNumberOfMGFlops; //!< floating point operations of one multigrid cycle from this level across all processes
+  mutable double mgLevelTime; //!< time spent by ComputeMG on this level, coarser levels excluded
+  int rowOrdering; //!< ordering of the local rows, set up by SetupMatrix and applied by OptimizeProblem (see ReorderProblem)
+  double bytesPerNonzero[2]; //!< modeled SpMV memory traffic per nonzero before and after the reordering of the rows (finest level)
+  int matrixFormat; //!< format of the optimized kernels requested by SetupMatrix (see StencilData.hpp), applied by OptimizeProblem
   char  * nonzerosInRow;  //!< The number of nonzeros in a row will always be 27 or fewer
   global_int_t ** mtxIndG; //!< matrix indices as global values
   local_int_t ** mtxIndL; //!< matrix indices as local values
@@ -64,6 +80,7 @@ public:
   SC ** matrixDiagonal; //!< values of matrix diagonal entries
   GlobalToLocalMap globalToLocalMap; //!< global-to-local mapping
   std::vector< global_int_t > localToGlobalMap; //!< local-to-global mapping
+  global_int_t * rowPartition; //!< if not 0, process p owns the global rows rowPartition[p] to rowPartition[p+1]-1 (instead of the rows given by geom)
   mutable bool isDotProductOptimized;
   mutable bool isSpmvOptimized;
   mutable bool isMgOptimized;
@@ -75,7 +92,15 @@ public:
    */
   mutable SparseMatrix<SC> * Ac;   // Coarse grid matrix
   mutable MGData<SC> * mgData; // Pointer to the coarse level data for this fine matrix
-  void * optimizationData;  // pointer that can be used to store implementation-specific data
+  mutable AgglomerationData<SC> * agglomeration; //!< if not 0, this level is solved on a subset of the processes
+  mutable CoarseSolverData * coarseSolver; //!< if not 0, this coarsest level is solved directly with this factorization
+  mutable StencilData<SC> * stencilData; //!< if not 0, the optimized SpMV and Gauss-Seidel kernels use this DIA copy of the matrix
+  mutable CompressedIndexData * compressedIndices; //!< if not 0, the optimized SpMV, Gauss-Seidel and residual kernels read these column indices instead of mtxIndL
+  mutable RowRunData * rowRuns; //!< if not 0, the optimized SpMV and Gauss-Seidel kernels use fixed-width kernels for the full rows of these runs
+  mutable void * optimizationData;  // pointer that can be used to store implementation-specific data (the SmootherData of the level)
+  void * snapshotData; //!< start of the memory-mapped problem snapshot the row arrays point into (0 if heap allocated)
+  size_t snapshotLength; //!< length of the mapping, nonzero only on the level that owns it
+  MemoryArena * arena; //!< if not 0, the arena holding the row arrays, halo lists and multigrid vectors of this level (see MemoryArena)
 
   // communicator
   comm_type comm;
@@ -169,6 +194,12 @@ inline void InitializeSparseMatrix(SparseMatrix_type & A, Geometry * geom, comm_
   A.mtxIndL = 0;
   A.matrixValues = 0;
   A.matrixDiagonal = 0;
+  A.rowPartition = 0;
+  A.totalNumberOfMGFlops = 0.0;
+  A.mgLevelTime = 0.0;
+  A.rowOrdering = 0; // Lexicographic
+  A.bytesPerNonzero[0] = A.bytesPerNonzero[1] = 0.0;
+  A.matrixFormat = 0; // CSR
 
   // Optimization is ON by default. The code that switches it OFF is in the
   // functions that are meant to be optimized.
@@ -191,9 +222,78 @@ inline void InitializeSparseMatrix(SparseMatrix_type & A, Geometry * geom, comm_
 #endif
   A.mgData = 0; // Fine-to-coarse grid transfer initially not defined.
   A.Ac =0;
+  A.agglomeration = 0;
+  A.coarseSolver = 0;
+  A.stencilData = 0;
+  A.compressedIndices = 0;
+  A.rowRuns = 0;
+  A.optimizationData = 0;
+  A.snapshotData = 0;
+  A.snapshotLength = 0;
+  A.arena = 0;
   return;
 }
 
+/*!
+  Returns the rank of the MPI process that owns the given global column (row) index,
+  from the row partition of the matrix if it has one and from its geometry otherwise.
+
+  @param[in] A     The known system matrix
+  @param[in] index The global column index
+
+  @return Returns the MPI rank of the process assigned the row
+ */
+template<class SparseMatrix_type>
+inline int ComputeRankOfMatrixColumn(const SparseMatrix_type & A, global_int_t index) {
+  if (A.rowPartition==0) return ComputeRankOfMatrixRow(*(A.geom), index);
+  return (int) (std::upper_bound(A.rowPartition, A.rowPartition + A.geom->size + 1, index) - A.rowPartition) - 1;
+}
+
+/*!
+  Returns the matrix holding the multigrid data (Ac and mgData) of the level of A: its copy on the
+  active processes if the level is agglomerated onto a subset of the processes, A otherwise.
+  On processes left out by the agglomeration, A is returned and has no coarser levels.
+
+  @param[in] A The matrix of a multigrid level
+ */
+template<class SparseMatrix_type>
+inline const SparseMatrix_type * ActiveLevelMatrix(const SparseMatrix_type * A) {
+  if (A->agglomeration!=0 && A->agglomeration->A!=0) return A->agglomeration->A;
+  return A;
+}
+
+/*!
+  Returns the coarsest level of the multigrid hierarchy of A that this process holds: the coarsest
+  level itself on the processes solving it, and the last level they took part in on processes left
+  out by agglomeration.
+
+  @param[in] A The finest level matrix
+ */
+template<class SparseMatrix_type>
+inline const SparseMatrix_type * CoarsestLevelMatrix(const SparseMatrix_type * A) {
+  A = ActiveLevelMatrix(A);
+  while (A->Ac!=0) A = ActiveLevelMatrix(A->Ac);
+  return A;
+}
+
+/*!
+  Returns the size in bytes of the regions mapped by the arenas of the levels of the multigrid
+  hierarchy of A held by this process.
+
+  @param[in] A The finest level matrix
+ */
+template<class SparseMatrix_type>
+inline size_t HierarchyArenaSize(const SparseMatrix_type & A) {
+  size_t size = 0;
+  for (const SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; ) {
+    const SparseMatrix_type * active = ActiveLevelMatrix(curLevelMatrix);
+    if (curLevelMatrix->arena!=0) size += MemoryArenaSize(*curLevelMatrix->arena);
+    if (active!=curLevelMatrix && active->arena!=0) size += MemoryArenaSize(*active->arena);
+    curLevelMatrix = active->Ac;
+  }
+  return size;
+}
+
 /*!
   Copy values from matrix diagonal into user-provided vector.
 
@@ -232,30 +332,37 @@ inline void ReplaceMatrixDiagonal(SparseMatrix_type & A, Vector_type & diagonal)
 template <class SparseMatrix_type>
 inline void DeleteMatrix(SparseMatrix_type & A) {
 
+  // Rows read from a problem snapshot live in the mapping, and rows generated in an arena in its
+  // regions, and are released with them
+  if (A.snapshotData==0 && A.arena==0) {
 #ifndef HPGMP_CONTIGUOUS_ARRAYS
-  for (local_int_t i = 0; i< A.localNumberOfRows; ++i) {
-    delete [] A.matrixValues[i];
-    delete [] A.mtxIndG[i];
-    delete [] A.mtxIndL[i];
-  }
+    for (local_int_t i = 0; i< A.localNumberOfRows; ++i) {
+      delete [] A.matrixValues[i];
+      delete [] A.mtxIndG[i];
+      delete [] A.mtxIndL[i];
+    }
 #else
-  delete [] A.matrixValues[0];
-  delete [] A.mtxIndG[0];
-  delete [] A.mtxIndL[0];
+    FreeArray(A.matrixValues[0]);
+    FreeArray(A.mtxIndG[0]);
+    FreeArray(A.mtxIndL[0]);
 #endif
+  }
+  if (A.snapshotData==0 && A.nonzerosInRow) delete [] A.nonzerosInRow;
   if (A.title)                 delete [] A.title;
-  if (A.nonzerosInRow)         delete [] A.nonzerosInRow;
   if (A.mtxIndG)               delete [] A.mtxIndG;
   if (A.mtxIndL)               delete [] A.mtxIndL;
   if (A.matrixValues)          delete [] A.matrixValues;
   if (A.matrixDiagonal)        delete [] A.matrixDiagonal;
+  if (A.rowPartition)          delete [] A.rowPartition;
 
 #ifndef HPGMP_NO_MPI
-  if (A.elementsToSend)        delete [] A.elementsToSend;
-  if (A.neighbors)             delete [] A.neighbors;
-  if (A.receiveLength)         delete [] A.receiveLength;
-  if (A.sendLength)            delete [] A.sendLength;
-  if (A.sendBuffer)            delete [] A.sendBuffer;
+  if (A.arena==0) {
+    if (A.elementsToSend)        delete [] A.elementsToSend;
+    if (A.neighbors)             delete [] A.neighbors;
+    if (A.receiveLength)         delete [] A.receiveLength;
+    if (A.sendLength)            delete [] A.sendLength;
+    if (A.sendBuffer)            delete [] A.sendBuffer;
+  }
 #endif
 
   /*if (A.geom!=0) {
@@ -275,9 +382,58 @@ inline void DeleteMatrix(SparseMatrix_type & A) {
     delete A.mgData;
     A.mgData = 0;
   }
+  if (A.agglomeration!=0) {
+    // Delete the copy of this level on the active processes
+    SparseMatrix_type * Aa = A.agglomeration->A;
+    if (Aa!=0) {
+      DeleteMatrix(*Aa);
+      DeleteGeometry(*Aa->geom);
+      delete Aa->geom;
+      delete Aa;
+    }
+    DeleteAgglomerationData(*A.agglomeration);
+    delete A.agglomeration;
+    A.agglomeration = 0;
+  }
+  if (A.coarseSolver!=0) {
+    DeleteCoarseSolverData(*A.coarseSolver);
+    delete A.coarseSolver;
+    A.coarseSolver = 0;
+  }
+  if (A.stencilData!=0) {
+    DeleteStencilData(*A.stencilData);
+    delete A.stencilData;
+    A.stencilData = 0;
+  }
+  if (A.compressedIndices!=0) {
+    DeleteCompressedIndexData(*A.compressedIndices);
+    delete A.compressedIndices;
+    A.compressedIndices = 0;
+  }
+  if (A.rowRuns!=0) {
+    DeleteRowRunData(*A.rowRuns);
+    delete A.rowRuns;
+    A.rowRuns = 0;
+  }
+  if (A.optimizationData!=0) {
+    SmootherData<typename SparseMatrix_type::scalar_type> * smoother = GetSmootherData(A);
+    DeleteSmootherData(*smoother);
+    delete smoother;
+    A.optimizationData = 0;
+  }
+  if (A.snapshotLength>0) munmap(A.snapshotData, A.snapshotLength);
+  A.snapshotData = 0;
+  A.snapshotLength = 0;
+  if (A.arena!=0) {
+    DeleteMemoryArena(*A.arena);
+    delete A.arena;
+    A.arena = 0;
+  }
 
+#if defined(HPGMP_WITH_CUDA) | defined(HPGMP_WITH_HIP)
   DeleteVector (A.x);
   DeleteVector (A.y);
+#endif
 
 #ifdef HPGMP_WITH_CUDA
   cudaFree (A.d_row_ptr);
@@ -0,0 +1,183 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file StencilData.hpp
+
+ HPGMP data structure
+ */
+
+#ifndef STENCILDATA_HPP
+#define STENCILDATA_HPP
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+#include "DataTypes.hpp"
+#include "Geometry.hpp"
+#include "MemoryAllocation.hpp"
+
+const int HPGMP_MATRIX_FORMAT_CSR = 0; //!< rows of column indices and values (mtxIndL and matrixValues)
+const int HPGMP_MATRIX_FORMAT_DIA = 1; //!< one plane of values per stencil point, columns implied by the geometry (see SetupStencilMatrix)
+const int HPGMP_MATRIX_FORMAT_COMPRESSED = 2; //!< CSR with 8-bit or 16-bit column codes (see SetupCompressedIndices)
+
+const int HPGMP_STENCIL_POINTS = 27; //!< points of the stencil of the generated problems
+const int HPGMP_STENCIL_CENTER = 13; //!< index of the diagonal among the stencil points
+
+/*!
+  Matrix of one multigrid level in the DIA format, in the stencilData of its matrix: the
+  coefficient of stencil point k of row i is values[k*localNumberOfRows+i], and multiplies the
+  entry of x at the padded index of the row plus offsets[k].  The stencil points are ordered
+  like the nonzeros of the generated rows (z, then y, then x offset from -1 to 1).
+
+  The kernels work on x in a padded layout, the (nx+2)x(ny+2)x(nz+2) box of the local grid with a
+  one-cell ghost layer: the external entries of x are received straight into their ghost cells (see
+  ExchangePaddedHalo), and the other ghost cells, beyond the global boundary, stay zero with zero
+  coefficients.  Rows whose columns do not all fit in the stencil are computed from their CSR form
+  (fallback rows), reading x in the padded layout as well.
+ */
+template<class SC>
+class StencilData {
+public:
+  local_int_t nx; //!< number of x-direction grid points of the local grid
+  local_int_t ny; //!< number of y-direction grid points of the local grid
+  local_int_t nz; //!< number of z-direction grid points of the local grid
+  local_int_t offsets[HPGMP_STENCIL_POINTS]; //!< offset in the padded layout of each stencil point
+  SC * values; //!< HPGMP_STENCIL_POINTS planes of localNumberOfRows coefficients, zero for absent points and fallback rows
+  SC * paddedVector; //!< work vector in the padded layout ((nx+2)*(ny+2)*(nz+2) entries)
+  local_int_t numberOfExternalCells; //!< number of external columns of the matrix
+  local_int_t * externalCells; //!< padded index of the ghost cell of each external column
+  local_int_t numberOfFallbackRows; //!< number of rows computed from their CSR form
+  local_int_t * fallbackRows; //!< these rows in increasing order, followed by localNumberOfRows
+#ifndef HPGMP_NO_MPI
+  int numberOfNeighbors; //!< number of neighbors of the matrix, in the order of its neighbors array
+  MPI_Datatype * sendTypes; //!< cells of the padded vector sent to each neighbor, a subarray when they form a box
+  MPI_Datatype * receiveTypes; //!< ghost cells receiving the entries of each neighbor, a subarray when they form a box
+#endif
+};
+
+/*!
+  Returns the index in the padded layout of the grid point (ix,iy,iz) of the local grid.
+ */
+template<class StencilData_type>
+inline local_int_t PaddedIndex(const StencilData_type & stencil, local_int_t ix, local_int_t iy, local_int_t iz) {
+  return ((iz+1)*(stencil.ny+2) + iy+1)*(stencil.nx+2) + ix+1;
+}
+
+/*!
+  Returns the index in the padded layout of the local row (or column) i, in lexicographic order.
+ */
+template<class StencilData_type>
+inline local_int_t PaddedIndex(const StencilData_type & stencil, local_int_t i) {
+  return PaddedIndex(stencil, i%stencil.nx, (i/stencil.nx)%stencil.ny, i/(stencil.nx*stencil.ny));
+}
+
+/*!
+  Returns the index in the padded layout of the entry of x at the local column col of a matrix
+  with nrow local rows.
+ */
+template<class StencilData_type>
+inline local_int_t PaddedColumnIndex(const StencilData_type & stencil, local_int_t nrow, local_int_t col) {
+  return col<nrow ? PaddedIndex(stencil, col) : stencil.externalCells[col-nrow];
+}
+
+/*!
+  Copies the local entries of x into the padded vector; its ghost cells are filled by ExchangePaddedHalo.
+ */
+template<class SC>
+inline void LoadPaddedVector(const StencilData<SC> & stencil, const SC * xv) {
+  const local_int_t nx = stencil.nx, numberOfLines = stencil.ny*stencil.nz;
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t line=0; line<numberOfLines; ++line) {
+    SC * const paddedLine = stencil.paddedVector + PaddedIndex(stencil, 0, line%stencil.ny, line/stencil.ny);
+    const SC * const xline = xv + line*nx;
+    for (local_int_t ix=0; ix<nx; ++ix) paddedLine[ix] = xline[ix];
+  }
+  return;
+}
+
+/*!
+  Copies the local entries of the padded vector back into x.
+ */
+template<class SC>
+inline void StorePaddedVector(const StencilData<SC> & stencil, SC * xv) {
+  const local_int_t nx = stencil.nx, numberOfLines = stencil.ny*stencil.nz;
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t line=0; line<numberOfLines; ++line) {
+    const SC * const paddedLine = stencil.paddedVector + PaddedIndex(stencil, 0, line%stencil.ny, line/stencil.ny);
+    SC * const xline = xv + line*nx;
+    for (local_int_t ix=0; ix<nx; ++ix) xline[ix] = paddedLine[ix];
+  }
+  return;
+}
+
+/*!
+ Constructor for the stencil data.
+
+ @param[in] geom the geometry of the level
+ @param[out] data the stencil data, whose planes are filled by SetupStencilMatrix
+ */
+template<class StencilData_type>
+inline void InitializeStencilData(const Geometry & geom, StencilData_type & data) {
+  data.nx = geom.nx;
+  data.ny = geom.ny;
+  data.nz = geom.nz;
+  for (int k=0; k<HPGMP_STENCIL_POINTS; ++k) {
+    local_int_t sx = k%3-1, sy = (k/3)%3-1, sz = k/9-1;
+    data.offsets[k] = (sz*(data.ny+2) + sy)*(data.nx+2) + sx;
+  }
+  data.values = 0;
+  data.paddedVector = 0;
+  data.numberOfExternalCells = 0;
+  data.externalCells = 0;
+  data.numberOfFallbackRows = 0;
+  data.fallbackRows = 0;
+#ifndef HPGMP_NO_MPI
+  data.numberOfNeighbors = 0;
+  data.sendTypes = 0;
+  data.receiveTypes = 0;
+#endif
+  return;
+}
+
+/*!
+ Destructor for the stencil data.
+
+ @param[inout] data the stencil data structure whose storage is deallocated
+ */
+template<class StencilData_type>
+inline void DeleteStencilData(StencilData_type & data) {
+
+  FreeArray(data.values);
+  FreeArray(data.paddedVector);
+  delete [] data.externalCells;
+  delete [] data.fallbackRows;
+#ifndef HPGMP_NO_MPI
+  for (int i=0; i<data.numberOfNeighbors; ++i) {
+    MPI_Type_free(&data.sendTypes[i]);
+    MPI_Type_free(&data.receiveTypes[i]);
+  }
+  delete [] data.sendTypes;
+  delete [] data.receiveTypes;
+#endif
+  return;
+}
+
+#endif // STENCILDATA_HPP
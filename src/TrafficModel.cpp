@@ -0,0 +1,369 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file TrafficModel.cpp
+
+ HPGMP routines of the memory traffic model of the kernels
+ */
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+
+#include <vector>
+
+#include "TrafficModel.hpp"
+#include "SparseMatrix.hpp"
+#include "SmootherData.hpp"
+#include "MemoryAllocation.hpp"
+#include "mytimer.hpp"
+
+// The model counts the bytes a kernel moves between the memory and the cores on the local rows of
+// one process, as the STREAM benchmark does: each array the kernel reads or writes is counted once
+// per pass, without the write-allocate traffic of the stores, and the entries of x referenced by
+// several rows are counted once (ModelBytesPerNonzero models how well a cache actually reuses them).
+// The matrix is counted in the format read by the optimized kernel, with valueBytes per value, so
+// that both precisions of the benchmark are modeled from either matrix.
+
+static bool streamMeasured = false; //!< whether SetupStreamTriad already ran
+static double streamBandwidth = 0.0; //!< bandwidth of the STREAM triad of all processes in GB/s, 0 if not measured
+static double streamArraySize = 0.0; //!< size in MB of each array of the triad
+
+/*!
+  Returns the number of entries of the padded vector of the DIA copy of a level.
+ */
+template<class StencilData_type>
+static double PaddedLength(const StencilData_type & stencil) {
+  return ((double) stencil.nx+2)*(stencil.ny+2)*(stencil.nz+2);
+}
+
+/*!
+  Returns the bytes of one read of the matrix of A in the given format (HPGMP_MATRIX_FORMAT_CSR, ...),
+  if A holds it: the values and column indices of the nonzeros, the nonzero counts of the rows,
+  and the data of the rows of the DIA and compressed formats that are read in CSR.
+ */
+template<class SparseMatrix_type>
+static double MatrixBytes(const SparseMatrix_type & A, size_t valueBytes, int format) {
+  const double nrow = A.localNumberOfRows, nnz = A.localNumberOfNonzeros;
+  const double nonzerosPerRow = nrow>0.0 ? nnz/nrow : 0.0;
+  const double csrBytes = valueBytes + sizeof(local_int_t); // per nonzero
+  if (format==HPGMP_MATRIX_FORMAT_DIA && A.stencilData!=0) {
+    // One plane of values per stencil point, and the fallback rows with their list
+    const double fallbackRows = A.stencilData->numberOfFallbackRows;
+    return nrow*HPGMP_STENCIL_POINTS*valueBytes + fallbackRows*(nonzerosPerRow*csrBytes + sizeof(char) + sizeof(local_int_t));
+  }
+  if (format!=HPGMP_MATRIX_FORMAT_CSR && A.compressedIndices!=0) {
+    // Codes of indexWidth bytes and the base column of each row, and mtxIndL for the escape rows
+    const CompressedIndexData & indices = *A.compressedIndices;
+    const double escapeNonzeros = indices.numberOfEscapeRows*nonzerosPerRow;
+    return nnz*valueBytes + (nnz - escapeNonzeros)*indices.indexWidth + escapeNonzeros*sizeof(local_int_t)
+           + nrow*(sizeof(char) + sizeof(local_int_t));
+  }
+  return nnz*csrBytes + nrow*sizeof(char);
+}
+
+/*!
+  Returns the modeled bytes of one read of the matrix of A by its optimized SpMV and Gauss-Seidel
+  kernels: in the DIA format if it is set up (see SetupStencilMatrix), with the compressed column
+  indices if they are (see SetupCompressedIndices), and in CSR otherwise.
+
+  @param[in] A          the matrix of a level
+  @param[in] valueBytes the bytes of a value of the matrix and of the vectors
+
+  @return the modeled number of bytes
+ */
+template<class SparseMatrix_type>
+double ModelMatrixBytes(const SparseMatrix_type & A, size_t valueBytes) {
+  if (A.stencilData!=0) return MatrixBytes(A, valueBytes, HPGMP_MATRIX_FORMAT_DIA);
+  if (A.compressedIndices!=0) return MatrixBytes(A, valueBytes, HPGMP_MATRIX_FORMAT_COMPRESSED);
+  return MatrixBytes(A, valueBytes, HPGMP_MATRIX_FORMAT_CSR);
+}
+
+/*!
+  Returns the modeled bytes moved by ComputeSPMV with A, without its halo exchange: the matrix, x
+  (copied into the padded vector, which is read once, with the DIA format) and y.
+
+  @see ModelMatrixBytes
+ */
+template<class SparseMatrix_type>
+double ModelSpMVBytes(const SparseMatrix_type & A, size_t valueBytes) {
+  const double nrow = A.localNumberOfRows;
+  const double bytes = ModelMatrixBytes(A, valueBytes);
+  if (A.stencilData!=0) return bytes + (3.0*nrow + PaddedLength(*A.stencilData))*valueBytes;
+  return bytes + ((double) A.localNumberOfColumns + nrow)*valueBytes;
+}
+
+/*!
+  Returns the modeled bytes moved by one forward Gauss-Seidel sweep with A (see ComputeGS_Forward),
+  without its halo exchange: one read of the matrix by the optimized kernel, r, and x updated in
+  place (x is copied in and out of the padded vector with the DIA format).
+  @see ModelMatrixBytes
+ */
+template<class SparseMatrix_type>
+double ModelGaussSeidelBytes(const SparseMatrix_type & A, size_t valueBytes) {
+  const double nrow = A.localNumberOfRows;
+  const double bytes = ModelMatrixBytes(A, valueBytes);
+  if (A.stencilData!=0) return bytes + (6.0*nrow + PaddedLength(*A.stencilData))*valueBytes;
+  return bytes + ((double) A.localNumberOfColumns + 2.0*nrow)*valueBytes;
+}
+
+/*!
+  Returns the modeled bytes moved by numberOfSteps smoothing steps on the level of A, without
+  their halo exchanges (see ComputeSmoother):
+  - Gauss-Seidel: one forward sweep per step (see ModelGaussSeidelBytes)
+  - the other smoothers read the matrix in CSR, x, r, the inverse diagonal and their work vector,
+    once per degree of the polynomial for Chebyshev
+
+  Temporally blocked sweeps are counted as separate sweeps, so that their reuse of the matrix in
+  cache shows as a bandwidth above that of the model.
+
+  @see ModelMatrixBytes
+ */
+template<class SparseMatrix_type>
+double ModelSmootherBytes(const SparseMatrix_type & A, int numberOfSteps, size_t valueBytes) {
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const double nrow = A.localNumberOfRows, ncol = A.localNumberOfColumns;
+  const SmootherData<scalar_type> * smoother = GetSmootherData(A);
+  const int type = smoother!=0 ? smoother->type : HPGMP_SMOOTHER_GAUSS_SEIDEL;
+  double step = 0.0;
+  if (type==HPGMP_SMOOTHER_GAUSS_SEIDEL) {
+    step = ModelGaussSeidelBytes(A, valueBytes);
+  } else {
+    // x over the columns, and six passes over the rows: r, the inverse diagonal (the work vector for
+    // Chebyshev), the work vector written, then x updated with it (for hybrid Gauss-Seidel, x saved into
+    // the work vector before the sweep, which reads it); Jacobi-Chebyshev also reads the inverse diagonal
+    const double vectors = type==HPGMP_SMOOTHER_JACOBI_CHEBYSHEV ? 7.0 : 6.0;
+    step = MatrixBytes(A, valueBytes, HPGMP_MATRIX_FORMAT_CSR) + (ncol + vectors*nrow)*valueBytes;
+    if (type==HPGMP_SMOOTHER_CHEBYSHEV || type==HPGMP_SMOOTHER_JACOBI_CHEBYSHEV) step *= smoother->degree;
+  }
+  return numberOfSteps*step;
+}
+
+/*!
+  Returns the modeled bytes moved by ComputeResidualRestriction on the level of A, without its halo
+  exchange: the rows of the injected points (in CSR or with compressed indices), x, whose entries
+  they reference all together, the fine residual and the coarse residual at these points, and the
+  injection.  Levels coarsened by aggregation compute the full product and sum it over the aggregates.
+ */
+template<class SparseMatrix_type>
+double ModelRestrictionBytes(const SparseMatrix_type & A, size_t valueBytes) {
+  if (A.mgData==0) return 0.0;
+  const double nrow = A.localNumberOfRows, nc = A.mgData->rc->localLength;
+  if (A.mgData->f2cOperator==0)
+    return ModelSpMVBytes(A, valueBytes) + nrow*(2.0*valueBytes + sizeof(local_int_t)) + nc*valueBytes;
+  const int format = A.compressedIndices!=0 ? HPGMP_MATRIX_FORMAT_COMPRESSED : HPGMP_MATRIX_FORMAT_CSR;
+  const double rows = nrow>0.0 ? MatrixBytes(A, valueBytes, format)*nc/nrow : 0.0;
+  return rows + ((double) A.localNumberOfColumns)*valueBytes + nc*(2.0*valueBytes + sizeof(local_int_t));
+}
+
+/*!
+  Returns the modeled bytes moved by ComputeProlongation_ref on the level of A: the coarse
+  correction, the injection, and the entries of x it updates (all of them with aggregation).
+ */
+template<class SparseMatrix_type>
+double ModelProlongationBytes(const SparseMatrix_type & A, size_t valueBytes) {
+  if (A.mgData==0) return 0.0;
+  const double nrow = A.localNumberOfRows, nc = A.mgData->rc->localLength;
+  if (A.mgData->aggregates!=0) return nrow*(2.0*valueBytes + sizeof(local_int_t)) + nc*valueBytes;
+  return nc*(3.0*valueBytes + sizeof(local_int_t));
+}
+
+/*!
+  Returns the modeled bytes moved in memory by ExchangeHalo with A: the entries sent, gathered
+  through elementsToSend into the send buffer, and the external entries received.
+ */
+template<class SparseMatrix_type>
+double ModelHaloBytes(const SparseMatrix_type & A, size_t valueBytes) {
+#ifndef HPGMP_NO_MPI
+  return ((double) A.totalToBeSent)*(2.0*valueBytes + sizeof(local_int_t)) + ((double) A.numberOfExternalValues)*valueBytes;
+#else
+  (void) A;
+  (void) valueBytes;
+  return 0.0;
+#endif
+}
+
+/*!
+  Returns the modeled bytes moved by one multigrid cycle of the given type on the levels of the
+  hierarchy of A held by this process, without the halo exchanges, like MGCycleFlops in SetupMatrix:
+  the smoothing steps, restriction and prolongation of each visit of a level, the sweep of the
+  coarsest level (nothing for a direct solve), and the coarse products and vector operations of the
+  W-, F- and K-cycles.  The injections of the additive cycle are counted as prolongations.
+
+  @param[in] A          the finest level matrix
+  @param[in] cycleType  the cycle (HPGMP_MG_V_CYCLE, ...)
+  @param[in] valueBytes the bytes of a value of the matrices and of the vectors
+
+  @return the modeled number of bytes
+ */
+template<class SparseMatrix_type>
+double ModelMGCycleBytes(const SparseMatrix_type & A, int cycleType, size_t valueBytes) {
+  const SparseMatrix_type & Af = *ActiveLevelMatrix(&A);
+  if (Af.mgData==0) return Af.coarseSolver!=0 ? 0.0 : ModelSmootherBytes(Af, 1, valueBytes);
+  double bytes = ModelSmootherBytes(Af, Af.mgData->numberOfPresmootherSteps, valueBytes);
+  if (cycleType==HPGMP_MG_ADDITIVE_CYCLE)
+    bytes += 2.0*ModelProlongationBytes(Af, valueBytes);
+  else
+    bytes += ModelRestrictionBytes(Af, valueBytes) + ModelProlongationBytes(Af, valueBytes)
+           + ModelSmootherBytes(Af, Af.mgData->numberOfPostsmootherSteps, valueBytes);
+  const SparseMatrix_type & Ac = *Af.Ac;
+  const double spmv = ModelSpMVBytes(Ac, valueBytes), vector = ((double) Ac.localNumberOfRows)*valueBytes;
+  if (cycleType==HPGMP_MG_W_CYCLE)
+    bytes += 2.0*ModelMGCycleBytes(Ac, cycleType, valueBytes) + spmv + 6.0*vector;
+  else if (cycleType==HPGMP_MG_F_CYCLE)
+    bytes += ModelMGCycleBytes(Ac, cycleType, valueBytes) + ModelMGCycleBytes(Ac, HPGMP_MG_V_CYCLE, valueBytes) + spmv + 6.0*vector;
+  else if (cycleType==HPGMP_MG_K_CYCLE)
+    bytes += 2.0*ModelMGCycleBytes(Ac, cycleType, valueBytes) + 2.0*spmv + 19.0*vector;
+  else
+    bytes += ModelMGCycleBytes(Ac, cycleType, valueBytes);
+  return bytes;
+}
+
+/*!
+  Measures the memory bandwidth with the triad of the STREAM benchmark, a = b + s*c, on arrays of
+  the given size on every process, placed on the NUMA nodes of the threads like the arrays of the
+  kernels (see FirstTouchArray).  All processes run each triad at once, so that they share the
+  memory of their node as in the benchmark, and the fastest of HPGMP_STREAM_TRIALS triads, timed on
+  the slowest process, gives the bandwidth of all processes together, the roofline of the kernels
+  in the report (see ReportRoofline).  It only runs once: later calls return its result.  Collective
+  on comm.
+
+  @param[in] megabytes the size in MB of each array (--stream), 0 for HPGMP_STREAM_ARRAY_MB, negative to skip the measurement
+  @param[in] comm      the communicator of all processes
+
+  @return returns 0 if the bandwidth was measured, and nonzero otherwise
+*/
+int SetupStreamTriad(int megabytes, comm_type comm) {
+  if (streamMeasured || megabytes<0) return streamBandwidth>0.0 ? 0 : 1;
+  streamMeasured = true;
+  if (megabytes==0) megabytes = HPGMP_STREAM_ARRAY_MB;
+  const long long n = ((long long) megabytes)*1000000/sizeof(double);
+  const double scalar = 3.0;
+  double * a = AllocateArray<double>(n);
+  double * b = AllocateArray<double>(n);
+  double * c = AllocateArray<double>(n);
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (long long i=0; i<n; ++i) {
+    a[i] = 0.0;
+    b[i] = 1.0;
+    c[i] = 2.0;
+  }
+
+  std::vector<double> times(HPGMP_STREAM_TRIALS);
+  for (int trial=0; trial<HPGMP_STREAM_TRIALS; ++trial) {
+#ifndef HPGMP_NO_MPI
+    MPI_Barrier(comm);
+#endif
+    double t0 = mytimer();
+#ifndef HPGMP_NO_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (long long i=0; i<n; ++i) a[i] = b[i] + scalar*c[i];
+    times[trial] = mytimer() - t0;
+  }
+
+  // Every entry of a must hold the triad, or the compiler took a shortcut
+  int valid = 1, size = 1;
+  for (long long i=0; i<n; ++i)
+    if (a[i]!=1.0 + scalar*2.0) valid = 0;
+  FreeArray(a);
+  FreeArray(b);
+  FreeArray(c);
+#ifndef HPGMP_NO_MPI
+  MPI_Comm_size(comm, &size);
+  MPI_Allreduce(MPI_IN_PLACE, times.data(), HPGMP_STREAM_TRIALS, MPI_DOUBLE, MPI_MAX, comm);
+  MPI_Allreduce(MPI_IN_PLACE, &valid, 1, MPI_INT, MPI_MIN, comm);
+#else
+  (void) comm;
+#endif
+  double best = times[0];
+  for (int trial=1; trial<HPGMP_STREAM_TRIALS; ++trial)
+    if (times[trial]<best) best = times[trial];
+  if (!valid || best<=0.0) return 1;
+  streamBandwidth = 3.0*sizeof(double)*((double) n)*size/best/1.0e9;
+  streamArraySize = megabytes;
+  return 0;
+}
+
+/*!
+  Returns the bandwidth of the STREAM triad of all processes in GB/s, 0 if it was not measured.
+ */
+double StreamTriadBandwidth() {
+  return streamBandwidth;
+}
+
+/*!
+  Returns the size in MB of each array of the STREAM triad, 0 if it was not measured.
+ */
+double StreamTriadArraySize() {
+  return streamArraySize;
+}
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+template
+double ModelMatrixBytes< SparseMatrix<double> >(SparseMatrix<double> const&, size_t);
+
+template
+double ModelMatrixBytes< SparseMatrix<float> >(SparseMatrix<float> const&, size_t);
+
+template
+double ModelSpMVBytes< SparseMatrix<double> >(SparseMatrix<double> const&, size_t);
+
+template
+double ModelSpMVBytes< SparseMatrix<float> >(SparseMatrix<float> const&, size_t);
+
+template
+double ModelGaussSeidelBytes< SparseMatrix<double> >(SparseMatrix<double> const&, size_t);
+
+template
+double ModelGaussSeidelBytes< SparseMatrix<float> >(SparseMatrix<float> const&, size_t);
+
+template
+double ModelSmootherBytes< SparseMatrix<double> >(SparseMatrix<double> const&, int, size_t);
+
+template
+double ModelSmootherBytes< SparseMatrix<float> >(SparseMatrix<float> const&, int, size_t);
+
+template
+double ModelRestrictionBytes< SparseMatrix<double> >(SparseMatrix<double> const&, size_t);
+
+template
+double ModelRestrictionBytes< SparseMatrix<float> >(SparseMatrix<float> const&, size_t);
+
+template
+double ModelProlongationBytes< SparseMatrix<double> >(SparseMatrix<double> const&, size_t);
+
+template
+double ModelProlongationBytes< SparseMatrix<float> >(SparseMatrix<float> const&, size_t);
+
+template
+double ModelHaloBytes< SparseMatrix<double> >(SparseMatrix<double> const&, size_t);
+
+template
+double ModelHaloBytes< SparseMatrix<float> >(SparseMatrix<float> const&, size_t);
+
+template
+double ModelMGCycleBytes< SparseMatrix<double> >(SparseMatrix<double> const&, int, size_t);
+
+template
+double ModelMGCycleBytes< SparseMatrix<float> >(SparseMatrix<float> const&, int, size_t);
@@ -0,0 +1,53 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file TrafficModel.hpp
+
+ HPGMP routines of the memory traffic model of the kernels
+ */
+
+#ifndef TRAFFICMODEL_HPP
+#define TRAFFICMODEL_HPP
+
+#include <cstddef>
+#include "hpgmp.hpp"
+
+const int HPGMP_STREAM_ARRAY_MB = 32; //!< default size in MB of each array of the STREAM triad, well beyond the last level caches
+const int HPGMP_STREAM_TRIALS = 10;   //!< number of timed triads, the fastest one is kept
+
+template<class SparseMatrix_type>
+double ModelMatrixBytes(const SparseMatrix_type & A, size_t valueBytes = sizeof(typename SparseMatrix_type::scalar_type));
+template<class SparseMatrix_type>
+double ModelSpMVBytes(const SparseMatrix_type & A, size_t valueBytes = sizeof(typename SparseMatrix_type::scalar_type));
+template<class SparseMatrix_type>
+double ModelGaussSeidelBytes(const SparseMatrix_type & A, size_t valueBytes = sizeof(typename SparseMatrix_type::scalar_type));
+template<class SparseMatrix_type>
+double ModelSmootherBytes(const SparseMatrix_type & A, int numberOfSteps, size_t valueBytes = sizeof(typename SparseMatrix_type::scalar_type));
+template<class SparseMatrix_type>
+double ModelRestrictionBytes(const SparseMatrix_type & A, size_t valueBytes = sizeof(typename SparseMatrix_type::scalar_type));
+template<class SparseMatrix_type>
+double ModelProlongationBytes(const SparseMatrix_type & A, size_t valueBytes = sizeof(typename SparseMatrix_type::scalar_type));
+template<class SparseMatrix_type>
+double ModelHaloBytes(const SparseMatrix_type & A, size_t valueBytes = sizeof(typename SparseMatrix_type::scalar_type));
+template<class SparseMatrix_type>
+double ModelMGCycleBytes(const SparseMatrix_type & A, int cycleType, size_t valueBytes = sizeof(typename SparseMatrix_type::scalar_type));
+
+int SetupStreamTriad(int megabytes, comm_type comm);
+double StreamTriadBandwidth();
+double StreamTriadArraySize();
+
+#endif // TRAFFICMODEL_HPP
@@ -33,10 +33,78 @@ using std::endl;
 #include "SetupProblem.hpp"
 #include "GMRES.hpp"
 #include "GMRES_IR.hpp"
+#include "MGData.hpp"
 
 #include "ValidGMRES.hpp"
 #include "mytimer.hpp"
 
+/*!
+  Preconditioner settings of a hierarchy that the reference iterations override (see SetReferencePreconditioner).
+ */
+struct PreconditionerSettings {
+  int cycleType;
+  std::vector<int> numberOfPresmootherSteps;
+  std::vector<int> numberOfPostsmootherSteps;
+  std::vector<void *> smoothers;
+  CoarseSolverData * coarseSolver;
+};
+
+/*!
+  Switches the multigrid preconditioner of A to the fixed configuration of the reference iterations: a
+  V-cycle with one Gauss-Seidel sweep before and after each coarse grid correction and one on the
+  coarsest level.  The rating is penalized by the ratio of the optimized to the reference iterations,
+  so the reference must not depend on the cycle, smoother, smoothing steps and coarsest-level solver
+  selected for the optimized preconditioner.  The depth of the hierarchy and the ordering of the rows
+  are shared with the optimized iterations.
+
+  @param[in]  A     The known system matrix, with its multigrid hierarchy
+  @param[out] saved The settings selected at setup, for RestorePreconditioner
+ */
+template<class SparseMatrix_type>
+static void SetReferencePreconditioner(const SparseMatrix_type & A, PreconditionerSettings & saved) {
+
+  saved.cycleType = A.mgData!=0 ? A.mgData->cycleType : HPGMP_MG_V_CYCLE;
+  if (A.mgData!=0) A.mgData->cycleType = HPGMP_MG_V_CYCLE;
+  for (const SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; curLevelMatrix = curLevelMatrix->Ac) {
+    curLevelMatrix = ActiveLevelMatrix(curLevelMatrix);
+    saved.smoothers.push_back(curLevelMatrix->optimizationData);
+    curLevelMatrix->optimizationData = 0;
+    if (curLevelMatrix->mgData!=0) {
+      saved.numberOfPresmootherSteps.push_back(curLevelMatrix->mgData->numberOfPresmootherSteps);
+      saved.numberOfPostsmootherSteps.push_back(curLevelMatrix->mgData->numberOfPostsmootherSteps);
+      curLevelMatrix->mgData->numberOfPresmootherSteps = 1;
+      curLevelMatrix->mgData->numberOfPostsmootherSteps = 1;
+    }
+  }
+  const SparseMatrix_type * coarsest = CoarsestLevelMatrix(&A);
+  saved.coarseSolver = coarsest->coarseSolver;
+  coarsest->coarseSolver = 0;
+  return;
+}
+
+/*!
+  Restores the multigrid preconditioner of A saved by SetReferencePreconditioner.
+
+  @param[in] A     The known system matrix, with its multigrid hierarchy
+  @param[in] saved The settings selected at setup
+ */
+template<class SparseMatrix_type>
+static void RestorePreconditioner(const SparseMatrix_type & A, const PreconditionerSettings & saved) {
+
+  if (A.mgData!=0) A.mgData->cycleType = saved.cycleType;
+  size_t level = 0, mgLevel = 0;
+  for (const SparseMatrix_type * curLevelMatrix = &A; curLevelMatrix!=0; curLevelMatrix = curLevelMatrix->Ac) {
+    curLevelMatrix = ActiveLevelMatrix(curLevelMatrix);
+    curLevelMatrix->optimizationData = saved.smoothers[level++];
+    if (curLevelMatrix->mgData!=0) {
+      curLevelMatrix->mgData->numberOfPresmootherSteps = saved.numberOfPresmootherSteps[mgLevel];
+      curLevelMatrix->mgData->numberOfPostsmootherSteps = saved.numberOfPostsmootherSteps[mgLevel++];
+    }
+  }
+  CoarsestLevelMatrix(&A)->coarseSolver = saved.coarseSolver;
+  return;
+}
+
 /*!
   Test the correctness of the optimized GMRES implementation
 
@@ -96,11 +164,14 @@ int ValidGMRES(int argc, char **argv, comm_type comm, int numberOfMgLevels, bool
   scalar_type refResNorm0 = 0.0;
   {
     ZeroVector(x);
+    PreconditionerSettings settings;
+    SetReferencePreconditioner(A, settings);
 
     double time_tic = mytimer();
     int ierr = GMRES(A, data, b, x, restart_length, MaxIters, tolerance, refNumIters, refResNorm, refResNorm0, true, verbose, test_data);
     refSolveTime = (mytimer() - time_tic);
     if (ierr != 0) fail = 1;
+    RestorePreconditioner(A, settings);
 
     test_data.refNumIters = refNumIters;
     test_data.refResNorm0 = refResNorm0;
@@ -145,6 +216,38 @@ int ValidGMRES(int argc, char **argv, comm_type comm, int numberOfMgLevels, bool
   }
 
 
+  //////////////////////////////////////////////////////////
+  // With a direct coarsest-level solver, count the iterations it saves over a single smoother sweep
+  const SparseMatrix_type * coarsest = CoarsestLevelMatrix(&A);
+  const SparseMatrix_type2 * coarsest_lo = CoarsestLevelMatrix(&A_lo);
+  int hasCoarseSolver = coarsest->coarseSolver!=0; // processes left out by agglomeration do not hold it
+#ifndef HPGMP_NO_MPI
+  MPI_Allreduce(MPI_IN_PLACE, &hasCoarseSolver, 1, MPI_INT, MPI_MAX, A.comm);
+#endif
+  if (hasCoarseSolver) {
+    CoarseSolverData * coarseSolver = coarsest->coarseSolver;
+    CoarseSolverData * coarseSolver_lo = coarsest_lo->coarseSolver;
+    coarsest->coarseSolver = 0;
+    coarsest_lo->coarseSolver = 0;
+    int numOfSPCalls = test_data.numOfSPCalls, numOfMGCalls = test_data.numOfMGCalls;
+
+    int sweepNumIters = 0;
+    scalar_type sweepResNorm = 0.0;
+    scalar_type sweepResNorm0 = 0.0;
+    ZeroVector(x);
+    GMRES_IR(A, A_lo, data, data_lo, b, x, restart_length, MaxIters, tolerance, sweepNumIters, sweepResNorm, sweepResNorm0, true, verbose, test_data);
+    test_data.optNumItersCoarseSweep = sweepNumIters;
+
+    test_data.numOfSPCalls = numOfSPCalls;
+    test_data.numOfMGCalls = numOfMGCalls;
+    coarsest->coarseSolver = coarseSolver;
+    coarsest_lo->coarseSolver = coarseSolver_lo;
+    if (verbose && A.geom->rank==0) {
+      HPGMP_fout << "  Iteration count with a coarsest-level sweep " << sweepNumIters << endl;
+    }
+  }
+
+
   // cleanup
   DeleteMatrix(A);
   DeleteMatrix(A_lo);
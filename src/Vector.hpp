@@ -37,6 +37,9 @@
 #include "DataTypes.hpp"
 #include "hpgmp.hpp"
 #include "Geometry.hpp"
+#include "SimdBackend.hpp"
+#include "MemoryAllocation.hpp"
+#include "MemoryArena.hpp"
 
 template<class SC = double>
 class Vector {
@@ -60,6 +63,7 @@ public:
    used inside optimized ComputeSPMV().
    */
   void * optimizationData;
+  MemoryArena * arena; //!< if not 0, the arena of the multigrid level holding the values, which are released with it
   double time1, time2, time3, time4;
 };
 
@@ -96,9 +100,37 @@ inline void InitializeVector(Vector_type & v, local_int_t localLength, comm_type
     printf( " InitializeVector :: Failed to allocate d_values\n" );
   }
   #else
-  v.values = new scalar_type[localLength];
+  v.values = AllocateArray<scalar_type>(localLength);
+  FirstTouchArray(v.values, localLength);
   #endif
   v.optimizationData = 0;
+  v.arena = 0;
+  return;
+}
+
+/*!
+  Initializes input vector, with its values allocated from the arena of a multigrid level (CPU
+  builds), or like InitializeVector(v, localLength, comm) if arena is 0.
+
+  @param[in] v
+  @param[in] localLength Length of local portion of input vector
+  @param[in] arena The arena holding the values
+ */
+template<class Vector_type>
+inline void InitializeVector(Vector_type & v, local_int_t localLength, comm_type comm, MemoryArena * arena) {
+#if !defined(HPGMP_WITH_CUDA) & !defined(HPGMP_WITH_HIP)
+  if (arena!=0) {
+    typedef typename Vector_type::scalar_type scalar_type;
+    v.localLength = localLength;
+    v.comm = comm;
+    v.values = ArenaAllocate<scalar_type>(*arena, localLength);
+    FirstTouchArray(v.values, localLength);
+    v.optimizationData = 0;
+    v.arena = arena;
+    return;
+  }
+#endif
+  InitializeVector(v, localLength, comm);
   return;
 }
 
@@ -134,6 +166,9 @@ inline void ZeroVector(Vector_type & v) {
 #endif
   #else
   scalar_type * vv = v.values;
+  #ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+  #endif
   for (int i=0; i<localLength; ++i) vv[i] = zero;
   #endif
   return;
@@ -244,7 +279,7 @@ inline void CopyVector(const Vector_src & v, Vector_dst & w) {
     }
   } else
   #endif
-  {
+  if (!SimdConvertVector(vv, wv, localLength)) {
     for (int i=0; i<localLength; ++i) wv[i] = vv[i];
   }
 #endif
@@ -314,7 +349,7 @@ inline void DeleteVector(Vector_type & v) {
   hipHostFree(v.values);
   rocblas_destroy_handle(v.handle);
   #else
-  delete [] v.values;
+  if (v.arena==0) FreeArray(v.values);
   #endif
   v.localLength = 0;
   return;
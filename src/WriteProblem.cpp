@@ -20,77 +20,256 @@
  HPGMP routine
  */
 
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+
+#ifndef HPGMP_NO_OPENMP
+#include <omp.h>
+#endif
+
 #include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
 #include "WriteProblem.hpp"
+#include "ExchangeHalo.hpp"
+#include "ParallelFile.hpp"
 
+/*!
+  Computes the file numbering of the local columns: process p numbers its rows contiguously
+  starting at rowOffset, and the numbers of external columns are received from their owners.
+ */
+template<class SparseMatrix_type>
+static void ComputeFileColumnIds(const SparseMatrix_type & A, long long rowOffset, std::vector<long long> & columnIds) {
+
+  columnIds.resize(A.localNumberOfRows);
+  for (local_int_t i=0; i<A.localNumberOfRows; ++i) columnIds[i] = rowOffset + i;
+  ExchangeHaloIds(A, columnIds);
+  return;
+}
 
 /*!
-  Routine to dump:
-   - matrix in row, col, val format for analysis with MATLAB
-   - x, xexact, b as simple arrays of numbers.
+  Appends a value to a text buffer with enough digits to round-trip the given precision.
+ */
+static inline void AppendValue(std::string & text, double value, bool singlePrecision) {
+  char buf[64];
+  sprintf(buf, singlePrecision ? "%.9g" : "%.17g", value);
+  text += buf;
+}
 
-   Writes to A.dat, x.dat, xexact.dat and b.dat, respectivly.
+/*!
+  Writes a vector in Matrix Market array format, each process writing its block of rows.
+ */
+template<class Vector_type>
+static int WriteMatrixMarketVector(const char * fname, const Vector_type & v, long long numberOfRows, comm_type comm) {
+
+  typedef typename Vector_type::scalar_type scalar_type;
+  bool singlePrecision = sizeof(scalar_type)<sizeof(double);
+
+  char header[256];
+  sprintf(header, "%%%%MatrixMarket matrix array real general\n%lld 1\n", numberOfRows);
+  long long headerLength = strlen(header);
+
+  std::string text;
+  text.reserve(((size_t) v.localLength)*26);
+  for (local_int_t i=0; i<v.localLength; ++i) {
+    AppendValue(text, v.values[i], singlePrecision);
+    text += '\n';
+  }
 
-   NOTE:  THIS CODE ONLY WORKS ON SINGLE PROCESSOR RUNS
+  long long length = text.size(), offset = 0;
+#ifndef HPGMP_NO_MPI
+  MPI_Exscan(&length, &offset, 1, MPI_LONG_LONG, MPI_SUM, comm);
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank==0) offset = 0;
+#else
+  int rank = 0;
+#endif
 
-   Read into MATLAB using:
+  ParallelFile_type fh;
+  if (ParallelFileOpen(fname, true, comm, fh)) return -1;
+  int ierr = ParallelFileWriteAt(fh, 0, header, rank==0 ? headerLength : 0, comm);
+  ierr |= ParallelFileWriteAt(fh, headerLength + offset, text.data(), length, comm);
+  ierr |= ParallelFileClose(fh);
+  return ierr;
+}
+
+/*!
+  Routine to dump the distributed linear system for use by other solvers.
 
-       load A.dat
-       A=spconvert(A);
-       load x.dat
-       load xexact.dat
-       load b.dat
+  All processes write their block of rows collectively into shared files with MPI-IO, at offsets
+  computed with prefix sums, so the cost is that of a parallel write.  Rows are numbered in
+  the files by process: process p owns the contiguous block starting at the sum of the row counts
+  of processes 0 to p-1, and column indices use the same numbering.
 
-  @param[in] geom   The description of the problem's geometry.
-  @param[in] A      The known system matrix
-  @param[in] b      The known right hand side vector
-  @param[in] x      The solution vector computed by CG iteration
-  @param[in] xexact Generated exact solution
+  With format HPGMP_PROBLEM_BINARY, a single file basename.bin is written with the layout
+   - ProblemFileHeader (64 bytes)
+   - row pointers, numberOfRows+1 64-bit integers
+   - column indices, numberOfNonzeros 64-bit integers (sorted within each row)
+   - values, numberOfNonzeros entries of valueSize bytes
+   - for each file row, the global row id of the generated problem (64-bit integers)
+   - b, x and xexact, each numberOfRows entries of vectorValueSize bytes
 
-  @return Returns with -1 if used with more than one MPI process. Returns with 0 otherwise.
+  With format HPGMP_PROBLEM_MATRIX_MARKET, the matrix is written as a Matrix Market coordinate
+  file basename.mtx, and the vectors as Matrix Market array files basename_b.mtx,
+  basename_x.mtx and basename_xexact.mtx.
 
-  @see GenerateProblem
+  @param[in] basename The file name without extension
+  @param[in] format   HPGMP_PROBLEM_BINARY or HPGMP_PROBLEM_MATRIX_MARKET
+  @param[in] A        The known system matrix
+  @param[in] b        The known right hand side vector
+  @param[in] x        The solution vector
+  @param[in] xexact   Generated exact solution
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see ReadProblem
 */
 template<class SparseMatrix_type, class Vector_type>
-int WriteProblem(const Geometry & geom, const SparseMatrix_type & A,
-                 const Vector_type b, const Vector_type x, const Vector_type xexact) {
+int WriteProblem(const char * basename, int format, const SparseMatrix_type & A,
+                 const Vector_type & b, const Vector_type & x, const Vector_type & xexact) {
 
   typedef typename SparseMatrix_type::scalar_type scalar_type;
-  if (geom.size!=1) return -1; //TODO Only works on one processor.  Need better error handler
-  const global_int_t nrow = A.totalNumberOfRows;
-
-  FILE * fA = 0, * fx = 0, * fxexact = 0, * fb = 0;
-  fA = fopen("A.dat", "w");
-  fx = fopen("x.dat", "w");
-  fxexact = fopen("xexact.dat", "w");
-  fb = fopen("b.dat", "w");
-
-  if (! fA || ! fx || ! fxexact || ! fb) {
-    if (fb) fclose(fb);
-    if (fxexact) fclose(fxexact);
-    if (fx) fclose(fx);
-    if (fA) fclose(fA);
-    return -1;
+  typedef typename Vector_type::scalar_type vector_scalar_type;
+
+  if (format!=HPGMP_PROBLEM_BINARY && format!=HPGMP_PROBLEM_MATRIX_MARKET) return -1;
+
+  local_int_t nrow = A.localNumberOfRows;
+  long long localNonzeros = A.localNumberOfNonzeros;
+  long long rowOffset = 0, nonzeroOffset = 0;
+  long long numberOfRows = A.totalNumberOfRows, numberOfNonzeros = A.totalNumberOfNonzeros;
+  int rank = 0, size = 1;
+#ifndef HPGMP_NO_MPI
+  MPI_Comm_rank(A.comm, &rank);
+  MPI_Comm_size(A.comm, &size);
+  long long localRows = nrow;
+  MPI_Exscan(&localRows, &rowOffset, 1, MPI_LONG_LONG, MPI_SUM, A.comm);
+  MPI_Exscan(&localNonzeros, &nonzeroOffset, 1, MPI_LONG_LONG, MPI_SUM, A.comm);
+  if (rank==0) { rowOffset = 0; nonzeroOffset = 0; }
+#endif
+
+  std::vector<long long> columnIds;
+  ComputeFileColumnIds(A, rowOffset, columnIds);
+
+  // Local CSR block in file numbering, columns sorted within each row
+  std::vector<long long> rowPointers(nrow+1), columns(localNonzeros);
+  std::vector<scalar_type> values(localNonzeros);
+  rowPointers[0] = nonzeroOffset;
+  for (local_int_t i=0; i<nrow; ++i) rowPointers[i+1] = rowPointers[i] + A.nonzerosInRow[i];
+#ifndef HPGMP_NO_OPENMP
+  #pragma omp parallel for
+#endif
+  for (local_int_t i=0; i<nrow; ++i) {
+    long long start = rowPointers[i] - nonzeroOffset;
+    int nnz = A.nonzerosInRow[i];
+    for (int j=0; j<nnz; ++j) {
+      long long col = columnIds[A.mtxIndL[i][j]];
+      scalar_type val = A.matrixValues[i][j];
+      int k = j;
+      for (; k>0 && columns[start+k-1]>col; --k) {
+        columns[start+k] = columns[start+k-1];
+        values[start+k] = values[start+k-1];
+      }
+      columns[start+k] = col;
+      values[start+k] = val;
+    }
   }
 
-  for (global_int_t i=0; i< nrow; i++) {
-    const scalar_type * const currentRowValues = A.matrixValues[i];
-    const global_int_t * const currentRowIndices = A.mtxIndG[i];
-    const int currentNumberOfNonzeros = A.nonzerosInRow[i];
-    for (int j=0; j< currentNumberOfNonzeros; j++)
-#ifdef HPGMP_NO_LONG_LONG
-      fprintf(fA, " %d %d %22.16e\n",i+1,(global_int_t)(currentRowIndices[j]+1),currentRowValues[j]);
-#else
-      fprintf(fA, " %lld %lld %22.16e\n",i+1,(global_int_t)(currentRowIndices[j]+1),currentRowValues[j]);
+  char fname[1024];
+  int ierr = 0;
+  if (format==HPGMP_PROBLEM_BINARY) {
+    ProblemFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "HPGMPCSR", 8);
+    header.version = 1;
+    header.numberOfRows = numberOfRows;
+    header.numberOfNonzeros = numberOfNonzeros;
+    header.valueSize = sizeof(scalar_type);
+    header.vectorValueSize = sizeof(vector_scalar_type);
+    header.numberOfVectors = 3;
+
+    long long rowPointerBase = sizeof(ProblemFileHeader);
+    long long columnBase = rowPointerBase + (numberOfRows+1)*sizeof(long long);
+    long long valueBase = columnBase + numberOfNonzeros*sizeof(long long);
+    long long rowIdBase = valueBase + numberOfNonzeros*sizeof(scalar_type);
+    long long vectorBase = rowIdBase + numberOfRows*sizeof(long long);
+
+    std::vector<long long> rowIds(A.localToGlobalMap.begin(), A.localToGlobalMap.end());
+    const Vector_type * vectors[3] = {&b, &x, &xexact};
+
+    sprintf(fname, "%s.bin", basename);
+    ParallelFile_type fh;
+    if (ParallelFileOpen(fname, true, A.comm, fh)) return -1;
+    ierr |= ParallelFileWriteAt(fh, 0, &header, rank==0 ? sizeof(header) : 0, A.comm);
+    // The last process also writes the closing row pointer
+    ierr |= ParallelFileWriteAt(fh, rowPointerBase + rowOffset*sizeof(long long), rowPointers.data(),
+                                (nrow + (rank==size-1 ? 1 : 0))*sizeof(long long), A.comm);
+    ierr |= ParallelFileWriteAt(fh, columnBase + nonzeroOffset*sizeof(long long), columns.data(),
+                                localNonzeros*sizeof(long long), A.comm);
+    ierr |= ParallelFileWriteAt(fh, valueBase + nonzeroOffset*sizeof(scalar_type), values.data(),
+                                localNonzeros*sizeof(scalar_type), A.comm);
+    ierr |= ParallelFileWriteAt(fh, rowIdBase + rowOffset*sizeof(long long), rowIds.data(),
+                                nrow*sizeof(long long), A.comm);
+    for (int k=0; k<3; ++k)
+      ierr |= ParallelFileWriteAt(fh, vectorBase + (k*numberOfRows + rowOffset)*sizeof(vector_scalar_type),
+                                  vectors[k]->values, nrow*sizeof(vector_scalar_type), A.comm);
+    ierr |= ParallelFileClose(fh);
+  } else {
+    bool singlePrecision = sizeof(scalar_type)<sizeof(double);
+    char header[256];
+    sprintf(header, "%%%%MatrixMarket matrix coordinate real general\n%lld %lld %lld\n",
+            numberOfRows, numberOfRows, numberOfNonzeros);
+    long long headerLength = strlen(header);
+
+    std::string text;
+    text.reserve(((size_t) localNonzeros)*40);
+    char buf[64];
+    for (local_int_t i=0; i<nrow; ++i) {
+      for (long long k=rowPointers[i]-nonzeroOffset; k<rowPointers[i+1]-nonzeroOffset; ++k) {
+        sprintf(buf, "%lld %lld ", rowOffset+i+1, columns[k]+1); // Matrix Market indices are one-based
+        text += buf;
+        AppendValue(text, values[k], singlePrecision);
+        text += '\n';
+      }
+    }
+    long long length = text.size(), offset = 0;
+#ifndef HPGMP_NO_MPI
+    MPI_Exscan(&length, &offset, 1, MPI_LONG_LONG, MPI_SUM, A.comm);
+    if (rank==0) offset = 0;
 #endif
-    fprintf(fx, "%22.16e\n",x.values[i]);
-    fprintf(fxexact, "%22.16e\n",xexact.values[i]);
-    fprintf(fb, "%22.16e\n",b.values[i]);
+
+    sprintf(fname, "%s.mtx", basename);
+    ParallelFile_type fh;
+    if (ParallelFileOpen(fname, true, A.comm, fh)) return -1;
+    ierr |= ParallelFileWriteAt(fh, 0, header, rank==0 ? headerLength : 0, A.comm);
+    ierr |= ParallelFileWriteAt(fh, headerLength + offset, text.data(), length, A.comm);
+    ierr |= ParallelFileClose(fh);
+
+    sprintf(fname, "%s_b.mtx", basename);
+    ierr |= WriteMatrixMarketVector(fname, b, numberOfRows, A.comm);
+    sprintf(fname, "%s_x.mtx", basename);
+    ierr |= WriteMatrixMarketVector(fname, x, numberOfRows, A.comm);
+    sprintf(fname, "%s_xexact.mtx", basename);
+    ierr |= WriteMatrixMarketVector(fname, xexact, numberOfRows, A.comm);
   }
 
-  fclose(fA);
-  fclose(fx);
-  fclose(fxexact);
-  fclose(fb);
-  return 0;
+  return ierr;
 }
+
+
+/* --------------- *
+ * specializations *
+ * --------------- */
+
+// uniform
+template
+int WriteProblem< SparseMatrix<double>, Vector<double> >(const char*, int, SparseMatrix<double> const&, Vector<double> const&, Vector<double> const&, Vector<double> const&);
+
+template
+int WriteProblem< SparseMatrix<float>, Vector<float> >(const char*, int, SparseMatrix<float> const&, Vector<float> const&, Vector<float> const&, Vector<float> const&);
+
+// mixed
+template
+int WriteProblem< SparseMatrix<float>, Vector<double> >(const char*, int, SparseMatrix<float> const&, Vector<double> const&, Vector<double> const&, Vector<double> const&);
@@ -19,7 +19,26 @@
 #include "Geometry.hpp"
 #include "SparseMatrix.hpp"
 
+const int HPGMP_PROBLEM_BINARY = 1; //!< Binary CSR file (see WriteProblem for the layout)
+const int HPGMP_PROBLEM_MATRIX_MARKET = 2; //!< Matrix Market coordinate file, vectors in Matrix Market array files
+
+/*!
+  Header at the start of a binary CSR problem file (64 bytes).
+ */
+struct ProblemFileHeader_STRUCT {
+  char magic[8]; //!< "HPGMPCSR"
+  long long version; //!< format version, currently 1
+  long long numberOfRows; //!< global number of rows (and columns)
+  long long numberOfNonzeros; //!< global number of nonzeros
+  long long valueSize; //!< size in bytes of a matrix value (4 or 8)
+  long long vectorValueSize; //!< size in bytes of a vector value (4 or 8)
+  long long numberOfVectors; //!< number of vectors stored after the matrix
+  long long reserved;
+};
+typedef struct ProblemFileHeader_STRUCT ProblemFileHeader;
+
 template<class SparseMatrix_type, class Vector_type>
-int WriteProblem(const Geometry & geom, const SparseMatrix_type & A, const Vector_type b, const Vector_type x, const Vector_type xexact);
+int WriteProblem(const char * basename, int format, const SparseMatrix_type & A,
+                 const Vector_type & b, const Vector_type & x, const Vector_type & xexact);
 
 #endif // WRITEPROBLEM_HPP
@@ -43,6 +43,21 @@ struct HPGMP_Params_STRUCT {
   int pz; //!< Partition in the z processor dimension, default is npz
   local_int_t zl; //!< nz for processors in the z dimension with value less than pz
   local_int_t zu; //!< nz for processors in the z dimension with value greater than pz
+  int snapshot; //!< If nonzero, reuse (or create) a per-rank binary snapshot of the problem
+  int writeProblem; //!< If nonzero, write the generated problem in this format (see WriteProblem.hpp)
+  int numberOfMgLevels; //!< If nonzero, number of multigrid levels including the finest
+  int numberOfPresmootherSteps; //!< If nonzero, number of smoother sweeps before coarsening
+  int numberOfPostsmootherSteps; //!< If nonzero, number of smoother sweeps after coarsening
+  int agglomerationThreshold; //!< If nonzero, coarse levels with fewer local rows are moved onto a subset of the processes
+  int coarseSolver; //!< If nonzero, solve the coarsest level directly instead of with one smoother sweep
+  int mgCycle; //!< Multigrid cycle: 0 for V (default), 1 for W, 2 for F, 3 for K, 4 for additive (see MGData.hpp)
+  int smoother; //!< Multigrid smoother: 0 for Gauss-Seidel (default), 1 for Chebyshev, 2 for Jacobi-preconditioned Chebyshev, 3 for l1-Jacobi, 4 for hybrid Gauss-Seidel (see SmootherData.hpp)
+  int rowOrdering; //!< Ordering of the local rows of the generated levels: 0 for lexicographic (default), 1 for tiles, 2 for Morton (see ReorderProblem.hpp)
+  int matrixFormat; //!< Format of the matrix in the optimized SpMV and Gauss-Seidel kernels: 0 for CSR (default), 1 for DIA (see StencilData.hpp), 2 for CSR with compressed column indices (see CompressedIndexData.hpp)
+  int simdLevel; //!< Explicitly vectorized CPU kernels in use: 0 for none, 1 for AVX2, 2 for AVX-512 (see SimdBackend.hpp)
+  int perfCounters; //!< If nonzero, the profiled regions also record the hardware counters of the threads (see PerfCounters.hpp)
+  int streamTriad; //!< If nonzero, the bandwidth of the STREAM triad was measured at startup, for the roofline of the kernels (see TrafficModel.hpp)
+  char matrixFile[256]; //!< If not empty, read the matrix from this file (see ReadProblem) instead of generating it
 };
 /*!
   HPGMP_Params is a shorthand for HPGMP_Params_STRUCT
@@ -41,6 +41,9 @@ const char* NULLDEVICE="/dev/null";
 #include "Utils_MPI.hpp"
 
 #include "ReadHpgmpDat.hpp"
+#include "SimdBackend.hpp"
+#include "PerfCounters.hpp"
+#include "TrafficModel.hpp"
 
 
 std::ofstream HPGMP_fout; //!< output file stream for logging activities during HPGMP run
@@ -83,7 +86,7 @@ HPGMP_Init_Params(const char *title, int * argc_p, char ** *argv_p, HPGMP_Params
   char ** argv = *argv_p;
   char fname[80];
   int i, j, *iparams;
-  char cparams[][7] = {"--nx=", "--ny=", "--nz=", "--rt=", "--pz=", "--zl=", "--zu=", "--npx=", "--npy=", "--npz="};
+  char cparams[][10] = {"--nx=", "--ny=", "--nz=", "--rt=", "--pz=", "--zl=", "--zu=", "--npx=", "--npy=", "--npz=", "--snap=", "--wp=", "--nl=", "--npre=", "--npost=", "--aggl=", "--cs=", "--cyc=", "--smo=", "--reo=", "--fmt=", "--simd=", "--hwc=", "--stream="};
   time_t rawtime;
   tm * ptm;
   const int nparams = (sizeof cparams) / (sizeof cparams[0]);
@@ -147,6 +150,33 @@ HPGMP_Init_Params(const char *title, int * argc_p, char ** *argv_p, HPGMP_Params
   params.npy = iparams[8];
   params.npz = iparams[9];
 
+  params.snapshot = iparams[10];
+  params.writeProblem = iparams[11];
+
+  params.numberOfMgLevels = iparams[12];
+  params.numberOfPresmootherSteps = iparams[13];
+  params.numberOfPostsmootherSteps = iparams[14];
+  params.agglomerationThreshold = iparams[15];
+  params.coarseSolver = iparams[16];
+  params.mgCycle = iparams[17];
+  params.smoother = iparams[18];
+  params.rowOrdering = iparams[19];
+  params.matrixFormat = iparams[20];
+  // Widest SIMD kernels supported by this CPU, unless limited by --simd (1 for none, 2 for AVX2, 3 for AVX-512)
+  params.simdLevel = SetupSimdBackend(iparams[21]-1);
+  // Hardware counters of the profiled regions, if requested with --hwc=1 and allowed by the system
+  params.perfCounters = SetupPerfCounters(iparams[22]!=0)==0;
+  // Bandwidth of the STREAM triad, the roofline of the kernels, on arrays of --stream MB (negative to skip it)
+  params.streamTriad = SetupStreamTriad(iparams[23], comm)==0;
+
+  // The matrix file is the only string parameter
+  params.matrixFile[0] = '\0';
+  for (i = 1; i <= argc && argv[i]; ++i)
+    if (startswith(argv[i], "--matrix=")) {
+      strncpy(params.matrixFile, argv[i]+strlen("--matrix="), sizeof(params.matrixFile)-1);
+      params.matrixFile[sizeof(params.matrixFile)-1] = '\0';
+    }
+
 #ifndef HPGMP_NO_MPI
   MPI_Comm_rank( comm, &params.comm_rank );
   MPI_Comm_size( comm, &params.comm_size );
@@ -110,7 +110,7 @@ int main(int argc, char * argv[]) {
 
   // Check if QuickPath option is enabled.
   // If the running time is set to zero, we minimize all paths through the program
-  int numberOfMgLevels = 4; // Number of levels including first
+  int numberOfMgLevels = 4; // Number of levels including first (default for --nl)
 
 
   // Use this array for collecting timing information
@@ -119,6 +119,7 @@ int main(int argc, char * argv[]) {
   test_data.times = NULL;
   test_data.flops = NULL;
   test_data.validation_nprocs = sizeValidComm;
+  test_data.optNumItersCoarseSweep = -1;
 
 
   //////////////////////
@@ -166,6 +167,10 @@ int main(int argc, char * argv[]) {
     SetupProblem("report_", argc, argv, benchmark_comm, numberOfMgLevels, verbose, geom, A, data, A2, data2, b, x, test_data);
 
 
+    // Levels actually built (--nl and the local grid size may change the default)
+    numberOfMgLevels = 1;
+    for (const SparseMatrix_type * Af = ActiveLevelMatrix(&A); Af->Ac!=0; Af = ActiveLevelMatrix(Af->Ac)) ++numberOfMgLevels;
+
     // Report results to YAML file
     ReportResults(A, numberOfMgLevels, test_data, global_failure);
 
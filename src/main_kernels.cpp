@@ -0,0 +1,439 @@
+
+//@HEADER
+// ***************************************************
+//
+// HPGMP: High Performance Generalized minimal residual
+//        - Mixed-Precision
+//
+// Contact:
+// Ichitaro Yamazaki         (iyamaza@sandia.gov)
+// Sivasankaran Rajamanickam (srajama@sandia.gov)
+// Piotr Luszczek            (luszczek@eecs.utk.edu)
+// Jack Dongarra             (dongarra@eecs.utk.edu)
+//
+// ***************************************************
+//@HEADER
+
+/*!
+ @file main_kernels.cpp
+
+ HPGMP routine
+ */
+
+// Main routine of a program that sets up the HPGMP problem once and benchmarks its kernels in
+// isolation, on each level of the multigrid hierarchy and in both precisions, to tune a node
+// without running the full validation and benchmark of xhpgmp.
+
+#ifndef HPGMP_NO_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using std::endl;
+
+#include "hpgmp.hpp"
+
+#include "SetupProblem.hpp"
+#include "Geometry.hpp"
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+#include "MultiVector.hpp"
+#include "SerialDenseMatrix.hpp"
+#include "GMRESData.hpp"
+#include "MGData.hpp"
+#include "ComputeSPMV.hpp"
+#include "ComputeGS_Forward.hpp"
+#include "ComputeMG.hpp"
+#include "ComputeGEMV.hpp"
+#include "ComputeGEMVT.hpp"
+#include "ComputeDotProduct.hpp"
+#include "ComputeWAXPBY.hpp"
+#include "ExchangeHalo.hpp"
+#include "TrafficModel.hpp"
+#include "mytimer.hpp"
+
+using scalar_type =  double;
+using scalar_type2 = float;
+using project_type = float;
+
+typedef TestGMRESData<scalar_type> TestGMRESData_type;
+typedef Vector<scalar_type> Vector_type;
+typedef SparseMatrix<scalar_type> SparseMatrix_type;
+typedef GMRESData<scalar_type> GMRESData_type;
+
+typedef SparseMatrix<scalar_type2> SparseMatrix_type2;
+typedef GMRESData<scalar_type2, project_type> GMRESData_type2;
+
+// Kernels benchmarked on each level
+const int KERNEL_SPMV = 0;
+const int KERNEL_GS_FORWARD = 1;
+const int KERNEL_MG = 2;
+const int KERNEL_GEMVT = 3;
+const int KERNEL_GEMV = 4;
+const int KERNEL_DOT_PRODUCT = 5;
+const int KERNEL_WAXPBY = 6;
+const int KERNEL_HALO = 7;
+static const char * kernelNames[] = {"ComputeSPMV", "ComputeGS_Forward", "ComputeMG", "ComputeGEMVT", "ComputeGEMV",
+                                     "ComputeDotProduct", "ComputeWAXPBY", "ExchangeHalo"};
+
+const double HPGMP_KERNEL_SAMPLE_TIME = 1.0e-4; //!< shortest time in seconds of a timed sample, well above the resolution of mytimer
+
+/*!
+  Options of the kernel benchmark, read from the command line next to those of HPGMP_Init_Params.
+ */
+struct KernelBenchmarkParams {
+  int warmups;          //!< untimed calls of each kernel before the timed ones (--warmup=, 5 by default)
+  int repetitions;      //!< timed calls of each kernel (--reps=, 50 by default)
+  int restartLength;    //!< GEMV and GEMVT are timed with 1 to restartLength columns (--restart=, 40 by default as in xhpgmp)
+  std::string jsonFile; //!< file of the results (--json=, HPGMP-Kernels_<date>.json by default)
+};
+
+/*!
+  Vectors the kernels of a level are called with: x and r hold pseudo-random values over the
+  columns of the level, y receives the results, and Q holds the restartLength+1 columns of the
+  GEMV and GEMVT kernels, with their coefficients in h.
+ */
+template<class SC>
+struct KernelVectors {
+  Vector<SC> x, r, y;
+  MultiVector<SC> Q;
+  SerialDenseMatrix<SC> h;
+};
+
+/*!
+  Reads the options of the kernel benchmark, and ignores the others.
+
+  @param[in]  argc, argv the arguments of main
+  @param[out] params     the options, with their default values if they are not given
+ */
+static void ReadKernelBenchmarkParams(int argc, char * argv[], KernelBenchmarkParams & params) {
+  params.warmups = 5;
+  params.repetitions = 50;
+  params.restartLength = 40;
+  params.jsonFile.clear();
+  for (int i=1; i<argc; ++i) {
+    if (strncmp(argv[i], "--warmup=", 9)==0) params.warmups = atoi(argv[i]+9);
+    else if (strncmp(argv[i], "--reps=", 7)==0) params.repetitions = atoi(argv[i]+7);
+    else if (strncmp(argv[i], "--restart=", 10)==0) params.restartLength = atoi(argv[i]+10);
+    else if (strncmp(argv[i], "--json=", 7)==0) params.jsonFile = argv[i]+7;
+  }
+  if (params.warmups<0) params.warmups = 0;
+  if (params.repetitions<1) params.repetitions = 1;
+  if (params.restartLength<1) params.restartLength = 1;
+  if (params.jsonFile.empty()) {
+    time_t rawtime;
+    time(&rawtime);
+    tm * ptm = localtime(&rawtime);
+    char sdate[80]; // Room for six full ints, so that the date is never truncated
+    snprintf(sdate, sizeof(sdate), "%04d-%02d-%02d_%02d-%02d-%02d", ptm->tm_year + 1900, ptm->tm_mon+1,
+             ptm->tm_mday, ptm->tm_hour, ptm->tm_min, ptm->tm_sec);
+    params.jsonFile = std::string("HPGMP-Kernels_") + sdate + ".json";
+  }
+  return;
+}
+
+/*!
+  Calls a kernel once on the level of A.
+
+  @param[in]    kernel the kernel (KERNEL_SPMV, ...)
+  @param[in]    k      the number of columns of GEMV and GEMVT
+  @param[in]    A      the matrix of the level
+  @param[inout] v      the vectors of the level
+
+  @return returns the error code of the kernel
+ */
+template<class SparseMatrix_type>
+static int CallKernel(int kernel, int k, const SparseMatrix_type & A, KernelVectors<typename SparseMatrix_type::scalar_type> & v) {
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  const local_int_t nrow = A.localNumberOfRows;
+  bool isOptimized = true;
+  double time_allreduce = 0.0;
+  scalar_type result = 0.0;
+  MultiVector<scalar_type> P;
+  switch (kernel) {
+  case KERNEL_SPMV:
+    return ComputeSPMV(A, v.x, v.y);
+  case KERNEL_GS_FORWARD:
+    return ComputeGS_Forward(A, v.r, v.y);
+  case KERNEL_MG:
+    return ComputeMG(A, v.r, v.y);
+  case KERNEL_GEMVT:
+    GetMultiVector(v.Q, 0, k-1, P);
+    return ComputeGEMVT(nrow, k, (scalar_type) 1.0, P, v.r, (scalar_type) 0.0, v.h, isOptimized);
+  case KERNEL_GEMV:
+    GetMultiVector(v.Q, 0, k-1, P);
+    return ComputeGEMV(nrow, k, (scalar_type) -1.0, P, v.h, (scalar_type) 1.0, v.y, isOptimized);
+  case KERNEL_DOT_PRODUCT:
+    return ComputeDotProduct(nrow, v.x, v.r, result, time_allreduce, isOptimized);
+  case KERNEL_WAXPBY:
+    return ComputeWAXPBY(nrow, (scalar_type) 1.0, v.x, (scalar_type) -0.5, v.r, v.y, isOptimized);
+#ifndef HPGMP_NO_MPI
+  case KERNEL_HALO:
+    ExchangeHalo(A, v.x);
+    return 0;
+#endif
+  }
+  return 1;
+}
+
+/*!
+  Times a kernel on the level of A: after the warm-up calls, each timed sample starts together on
+  all processes of the level and lasts as long as on the slowest one.  A sample is a single call,
+  or as many calls as take HPGMP_KERNEL_SAMPLE_TIME for the kernels of the coarse levels, whose
+  average time it gives.  Reports the median and the
+  95th percentile of the times, and the bandwidth and flop rate at the median, to the log file and,
+  on the first process, as one record of the array of kernels of the JSON file.
+
+  @param[in]    kernel the kernel (KERNEL_SPMV, ...)
+  @param[in]    k      the number of columns of GEMV and GEMVT, 0 for the other kernels
+  @param[in]    A      the matrix of the level
+  @param[inout] v      the vectors of the level
+  @param[in]    level  the level of A in the hierarchy
+  @param[in]    bytes  the bytes moved by the kernel on this process (see TrafficModel.hpp)
+  @param[in]    flops  the floating point operations of the kernel across all processes
+  @param[in]    params the options of the benchmark
+  @param[inout] json   the JSON file, 0 on the processes that do not write it
+  @param[inout] first  whether no record was written yet
+
+  @return returns the error code of the kernel
+ */
+template<class SparseMatrix_type>
+static int BenchmarkKernel(int kernel, int k, const SparseMatrix_type & A, KernelVectors<typename SparseMatrix_type::scalar_type> & v,
+                           int level, double bytes, double flops, const KernelBenchmarkParams & params, std::ofstream * json, bool & first) {
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  int ierr = 0;
+  for (int i=0; i<params.warmups; ++i) ierr += CallKernel(kernel, k, A, v);
+
+  // Calls of the kernels shorter than HPGMP_KERNEL_SAMPLE_TIME are timed in batches, doubled until they last as long
+  double t0 = 0.0;
+  int calls = 1;
+  for (;;) {
+    double batchTime = 0.0;
+    TICK();
+    for (int j=0; j<calls; ++j) ierr += CallKernel(kernel, k, A, v);
+    TIME(batchTime);
+#ifndef HPGMP_NO_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &batchTime, 1, MPI_DOUBLE, MPI_MAX, A.comm);
+#endif
+    if (batchTime>=HPGMP_KERNEL_SAMPLE_TIME) break;
+    calls *= 2;
+  }
+  const int n = params.repetitions;
+  std::vector<double> times(n, 0.0);
+  for (int i=0; i<n; ++i) {
+#ifndef HPGMP_NO_MPI
+    MPI_Barrier(A.comm);
+#endif
+    TICK();
+    for (int j=0; j<calls; ++j) ierr += CallKernel(kernel, k, A, v);
+    TIME(times[i]);
+    times[i] /= calls;
+  }
+#ifndef HPGMP_NO_MPI
+  MPI_Allreduce(MPI_IN_PLACE, times.data(), n, MPI_DOUBLE, MPI_MAX, A.comm);
+  MPI_Allreduce(MPI_IN_PLACE, &bytes, 1, MPI_DOUBLE, MPI_SUM, A.comm);
+#endif
+  if (A.geom->rank!=0) return ierr;
+
+  std::sort(times.begin(), times.end());
+  const double median = n%2==1 ? times[n/2] : 0.5*(times[n/2-1] + times[n/2]);
+  const double p95 = times[std::min(n-1, std::max(0, (int) std::ceil(0.95*n) - 1))];
+  const double gbytes = median>0.0 ? bytes/median/1.0e9 : 0.0;
+  const double gflops = median>0.0 ? flops/median/1.0e9 : 0.0;
+  const char * precision = sizeof(scalar_type)==sizeof(double) ? "double" : "float";
+
+  HPGMP_fout << " " << kernelNames[kernel];
+  if (k>0) HPGMP_fout << " k=" << k;
+  HPGMP_fout << " (" << precision << ", level " << level << "): median " << median << " s, p95 " << p95
+             << " s, " << gbytes << " GB/s, " << gflops << " Gflop/s" << endl;
+
+  if (json!=0) {
+    *json << (first ? "\n" : ",\n") << "    {\"kernel\": \"" << kernelNames[kernel] << "\", \"precision\": \"" << precision
+          << "\", \"level\": " << level << ", \"rows\": " << A.totalNumberOfRows;
+    if (k>0) *json << ", \"columns\": " << k;
+    *json << ", \"calls per sample\": " << calls << ", \"bytes\": " << bytes << ", \"flops\": " << flops << ", \"min_time\": " << times[0]
+          << ", \"median_time\": " << median << ", \"p95_time\": " << p95
+          << ", \"GB/s\": " << gbytes << ", \"Gflop/s\": " << gflops << "}";
+    first = false;
+  }
+  return ierr;
+}
+
+/*!
+  Benchmarks the kernels on the levels of the hierarchy of A held by this process: SpMV, forward
+  Gauss-Seidel, the multigrid cycle started from the level, GEMVT and GEMV with 1 to restartLength
+  columns, the dot product, WAXPBY and the halo exchange.  The kernels of a level are collective on
+  the processes holding it; agglomerated levels are benchmarked on their active processes, among
+  which is the first process, so that it reports all levels.
+
+  @param[in]    A      the finest level matrix, set up by OptimizeProblem
+  @param[in]    params the options of the benchmark
+  @param[inout] json   the JSON file, 0 on the processes that do not write it
+  @param[inout] first  whether no record was written yet
+
+  @return returns the sum of the error codes of the kernels
+ */
+template<class SparseMatrix_type>
+static int BenchmarkKernels(const SparseMatrix_type & A, const KernelBenchmarkParams & params, std::ofstream * json, bool & first) {
+  typedef typename SparseMatrix_type::scalar_type scalar_type;
+  int ierr = 0;
+  int level = 0;
+  for (const SparseMatrix_type * Af = ActiveLevelMatrix(&A); Af!=0; ++level) {
+    // Processes left out by agglomeration stop at the last level they take part in
+    if (Af->agglomeration!=0) break;
+    const local_int_t nrow = Af->localNumberOfRows, ncol = Af->localNumberOfColumns;
+    const double rows = Af->totalNumberOfRows, nnz = Af->totalNumberOfNonzeros;
+    const double vectorBytes = ((double) nrow)*sizeof(scalar_type);
+    const int restartLength = params.restartLength;
+
+    KernelVectors<scalar_type> v;
+    InitializeVector(v.x, ncol, Af->comm);
+    InitializeVector(v.r, ncol, Af->comm);
+    InitializeVector(v.y, ncol, Af->comm);
+    InitializeMultiVector(v.Q, nrow, restartLength+1, Af->comm);
+    InitializeMatrix(v.h, restartLength+1, 1);
+    FillRandomVector(v.x);
+    FillRandomVector(v.r);
+    ZeroVector(v.y);
+    for (int j=0; j<=restartLength; ++j) {
+      Vector<scalar_type> Qj;
+      GetVector(v.Q, j, Qj);
+      FillRandomVector(Qj);
+    }
+
+    ierr += BenchmarkKernel(KERNEL_SPMV, 0, *Af, v, level, ModelSpMVBytes(*Af), 2.0*nnz, params, json, first);
+    ierr += BenchmarkKernel(KERNEL_GS_FORWARD, 0, *Af, v, level, ModelGaussSeidelBytes(*Af), 2.0*nnz, params, json, first);
+    // The additive cycle is only set up from the finest level
+    if (Af->mgData!=0 && (level==0 || Af->mgData->cycleType!=HPGMP_MG_ADDITIVE_CYCLE)) {
+      ZeroVector(v.y);
+      ierr += BenchmarkKernel(KERNEL_MG, 0, *Af, v, level, ModelMGCycleBytes(*Af, Af->mgData->cycleType),
+                              Af->totalNumberOfMGFlops, params, json, first);
+    }
+    for (int k=1; k<=restartLength; ++k) {
+      ierr += BenchmarkKernel(KERNEL_GEMVT, k, *Af, v, level, (k+1)*vectorBytes, 2.0*k*rows, params, json, first);
+      // Small coefficients, so that the repeated updates of y by GEMV stay of the order of its entries
+      for (int i=0; i<k; ++i) v.h.values[i] = 1.0/k;
+      ierr += BenchmarkKernel(KERNEL_GEMV, k, *Af, v, level, (k+2)*vectorBytes, 2.0*k*rows, params, json, first);
+    }
+    ierr += BenchmarkKernel(KERNEL_DOT_PRODUCT, 0, *Af, v, level, 2.0*vectorBytes, 2.0*rows, params, json, first);
+    ierr += BenchmarkKernel(KERNEL_WAXPBY, 0, *Af, v, level, 3.0*vectorBytes, 2.0*rows, params, json, first);
+#ifndef HPGMP_NO_MPI
+    ierr += BenchmarkKernel(KERNEL_HALO, 0, *Af, v, level, ModelHaloBytes(*Af), 0.0, params, json, first);
+#endif
+
+    DeleteVector(v.x);
+    DeleteVector(v.r);
+    DeleteVector(v.y);
+    DeleteMultiVector(v.Q);
+    DeleteDenseMatrix(v.h);
+    Af = Af->Ac!=0 ? ActiveLevelMatrix(Af->Ac) : 0;
+  }
+  return ierr;
+}
+
+/*!
+  Kernel benchmark driver: sets up the problem and its hierarchies in both precisions once, as
+  xhpgmp does, then benchmarks each kernel in isolation on every level (see BenchmarkKernels).
+  Takes the arguments of xhpgmp, and:
+  - --warmup=n  : untimed calls of each kernel before the timed ones (5)
+  - --reps=n    : timed calls of each kernel (50)
+  - --restart=n : largest number of columns of GEMV and GEMVT (40)
+  - --json=file : file of the results (HPGMP-Kernels_<date>.json)
+
+  @param[in]  argc Standard argument count.
+  @param[in]  argv Standard argument array.
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+*/
+int main(int argc, char * argv[]) {
+
+#ifndef HPGMP_NO_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  HPGMP_Init(&argc, &argv);
+#ifndef HPGMP_NO_MPI
+  MPI_Comm comm = MPI_COMM_WORLD;
+#else
+  comm_type comm = 0;
+#endif
+
+  KernelBenchmarkParams params;
+  ReadKernelBenchmarkParams(argc, argv, params);
+
+  /////////////////////////
+  // Problem setup Phase //
+  /////////////////////////
+  int numberOfMgLevels = 4; // Number of levels including first (default for --nl)
+  bool verbose = true;
+  TestGMRESData_type test_data;
+  test_data.times = NULL;
+  test_data.flops = NULL;
+
+  Geometry * geom = new Geometry;
+
+  SparseMatrix_type A;
+  GMRESData_type data;
+
+  SparseMatrix_type2 A2;
+  GMRESData_type2 data2;
+
+  Vector_type b, x;
+  SetupProblem("kernels_", argc, argv, comm, numberOfMgLevels, verbose, geom, A, data, A2, data2, b, x, test_data);
+
+  /////////////////////
+  // Benchmark phase //
+  /////////////////////
+  std::ofstream jsonFile;
+  std::ofstream * json = 0;
+  if (geom->rank==0) {
+    jsonFile.open(params.jsonFile.c_str());
+    json = &jsonFile;
+    jsonFile << "{\n  \"benchmark\": \"HPGMP-Kernels\",\n  \"version\": \"0.1\",\n"
+             << "  \"processes\": " << geom->size << ",\n  \"threads\": " << geom->numThreads << ",\n"
+             << "  \"local grid\": [" << geom->nx << ", " << geom->ny << ", " << geom->nz << "],\n"
+             << "  \"process grid\": [" << geom->npx << ", " << geom->npy << ", " << geom->npz << "],\n"
+             << "  \"warmups\": " << params.warmups << ",\n  \"repetitions\": " << params.repetitions << ",\n"
+             << "  \"restart length\": " << params.restartLength << ",\n"
+             << "  \"STREAM Triad GB/s\": " << StreamTriadBandwidth() << ",\n  \"kernels\": [";
+    HPGMP_fout << endl << "Kernel benchmark: " << params.warmups << " warm-up and " << params.repetitions
+               << " timed calls of each kernel" << endl;
+  }
+
+  bool first = true;
+  int ierr = BenchmarkKernels(A, params, json, first);
+  ierr += BenchmarkKernels(A2, params, json, first);
+
+  if (geom->rank==0) {
+    jsonFile << "\n  ]\n}\n";
+    jsonFile.close();
+    if (ierr) HPGMP_fout << "Error in the kernels: " << ierr << endl;
+    HPGMP_fout << "Results written to " << params.jsonFile << endl;
+  }
+
+  // Clean up
+  DeleteMatrix(A);
+  DeleteMatrix(A2);
+  DeleteGeometry(*geom);
+  delete geom;
+
+  DeleteGMRESData(data);
+  DeleteGMRESData(data2);
+  DeleteVector(x);
+  DeleteVector(b);
+
+  HPGMP_Finalize();
+#ifndef HPGMP_NO_MPI
+  MPI_Finalize();
+#endif
+  return ierr!=0;
+}
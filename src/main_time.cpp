@@ -44,6 +44,7 @@ using std::endl;
 #include "GenerateGeometry.hpp"
 #include "CheckProblem.hpp"
 #include "OptimizeProblem.hpp"
+#include "ReorderProblem.hpp"
 #include "WriteProblem.hpp"
 #include "mytimer.hpp"
 #include "ComputeSPMV_ref.hpp"
@@ -156,14 +157,16 @@ int main(int argc, char * argv[]) {
   Vector_type b, x, xexact;
 
   int numberOfMgLevels = 4; // Number of levels including first
-  SetupMatrix(numberOfMgLevels, A, geom, data, &b, &x, &xexact, init_vect, bench_comm);
+  SetupMatrix(numberOfMgLevels, A, geom, data, &b, &x, &xexact, init_vect, bench_comm, params);
 
   setup_time = mytimer() - setup_time; // Capture total time of setup
   times[9] = setup_time; // Save it for reporting
 
   // Call user-tunable set up function.
   double t7 = mytimer();
+  std::vector<global_int_t> generatedRows(A.localToGlobalMap.begin(), A.localToGlobalMap.begin() + A.localNumberOfRows);
   OptimizeProblem(A, data, b, x, xexact);
+  PermuteProblemVectors(A, generatedRows, b, x, xexact); // A2 below is reordered alike
   t7 = mytimer() - t7;
   times[7] = t7;
 
@@ -172,6 +175,17 @@ int main(int argc, char * argv[]) {
     HPGMP_fout << " Optimize Time     " << t7 << " seconds." << endl;
   }
 
+  // Dump the linear system for other solvers if requested
+  if (params.writeProblem) {
+    double write_time = mytimer();
+    ierr = WriteProblem("hpgmp_problem", params.writeProblem, A, b, x, xexact);
+    write_time = mytimer() - write_time;
+    if (A.geom->rank==0) {
+      if (ierr) HPGMP_fout << "Error in call to WriteProblem: " << ierr << ".\n" << endl;
+      else HPGMP_fout << " Write    Time     " << write_time << " seconds." << endl;
+    }
+  }
+
   ////////////////////////////////////
   // Reference SpMV+MG Timing Phase //
   ////////////////////////////////////
@@ -211,7 +225,7 @@ int main(int argc, char * argv[]) {
   init_vect = false;
   SparseMatrix_type2 A2;
   GMRESData_type2 data2;
-  SetupMatrix(numberOfMgLevels, A2, geom, data2, &b, &x, &xexact, init_vect, bench_comm);
+  SetupMatrix(numberOfMgLevels, A2, geom, data2, &b, &x, &xexact, init_vect, bench_comm, params);
   setup_time = mytimer() - setup_time; // Capture total time of setup
 
   t7 = mytimer();
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "hpgmp.hpp"
+#include "Geometry.hpp"
+#include "GenerateGeometry.hpp"
+#include "GenerateNonsymProblem.hpp"
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+#include "CoarseSolverData.hpp"
+#include "SetupCoarseSolver.hpp"
+#include "ComputeCoarseSolve.hpp"
+
+typedef SparseMatrix<double> SparseMatrix_type;
+typedef Vector<double> Vector_type;
+
+// Solves A x = r by Gaussian elimination with partial pivoting on the dense matrix, in global row order
+static void
+DirectSolve(const SparseMatrix_type & A, const Vector_type & r, std::vector<double> & x) {
+  const global_int_t n = A.totalNumberOfRows;
+  std::vector<double> a(n*n, 0.0);
+  x.assign(n, 0.0);
+  for (local_int_t i=0; i<A.localNumberOfRows; ++i) {
+    const global_int_t row = A.localToGlobalMap[i];
+    for (int j=0; j<A.nonzerosInRow[i]; ++j) a[row*n + A.mtxIndG[i][j]] += A.matrixValues[i][j];
+    x[row] = r.values[i];
+  }
+
+  for (global_int_t j=0; j<n; ++j) {
+    global_int_t p = j;
+    for (global_int_t i=j+1; i<n; ++i)
+      if (std::fabs(a[i*n + j])>std::fabs(a[p*n + j])) p = i;
+    if (p!=j) {
+      for (global_int_t c=0; c<n; ++c) std::swap(a[j*n + c], a[p*n + c]);
+      std::swap(x[j], x[p]);
+    }
+    for (global_int_t i=j+1; i<n; ++i) {
+      const double l = a[i*n + j]/a[j*n + j];
+      for (global_int_t c=j; c<n; ++c) a[i*n + c] -= l*a[j*n + c];
+      x[i] -= l*x[j];
+    }
+  }
+  for (global_int_t j=n-1; j>=0; --j) {
+    for (global_int_t c=j+1; c<n; ++c) x[j] -= a[j*n + c]*x[c];
+    x[j] /= a[j*n + j];
+  }
+}
+
+// Generates the problem on an nx x ny x nz grid of one process, factors it with SetupCoarseSolver, and
+// compares the solution of ComputeCoarseSolve for a random right-hand side with the direct dense solve
+static int
+CompareWithDirectSolve(bool isDense, local_int_t nx, local_int_t ny, local_int_t nz) {
+  Geometry * geom = new Geometry;
+  GenerateGeometry(1, 0, 1, 0, 0, 0, nx, ny, nz, 1, 1, 1, geom);
+
+  SparseMatrix_type A;
+  InitializeSparseMatrix(A, geom, 0);
+  GenerateNonsymProblem(A, (Vector_type *) 0, (Vector_type *) 0, (Vector_type *) 0, false);
+
+  Vector_type r, x;
+  InitializeVector(r, A.localNumberOfRows, 0);
+  InitializeVector(x, A.localNumberOfRows, 0);
+  FillRandomVector(r);
+  std::vector<double> xdirect;
+  DirectSolve(A, r, xdirect);
+
+  int retVal = 0, idx = 0;
+  int ierr = SetupCoarseSolver(A);
+  if (ierr || A.coarseSolver->isDense!=isDense) {
+    printf( "%d x %d x %d: setup returned %d\n", (int) nx, (int) ny, (int) nz, ierr ); fflush(stdout);
+    retVal |= 1 << idx;
+  } else {
+    ComputeCoarseSolve(A, r, x);
+    double maxDifference = 0.0, maxValue = 0.0;
+    for (local_int_t i=0; i<A.localNumberOfRows; ++i) {
+      const double xi = xdirect[A.localToGlobalMap[i]];
+      maxDifference = std::max(maxDifference, std::fabs(x.values[i] - xi));
+      maxValue = std::max(maxValue, std::fabs(xi));
+    }
+    printf( "%s %d x %d x %d: max difference %g of %g\n", isDense ? "dense" : "banded",
+            (int) nx, (int) ny, (int) nz, maxDifference, maxValue ); fflush(stdout);
+    ++idx;
+    if (maxDifference > 1.0e-10*maxValue) retVal |= 1 << idx;
+  }
+
+  DeleteVector(r);
+  DeleteVector(x);
+  DeleteMatrix(A);
+  delete geom;
+
+  return retVal;
+}
+
+// Dense factorization: the band of a 3 x 3 x 3 grid is as wide as the matrix
+int
+TestCase1(void) {
+  return CompareWithDirectSolve(true, 3, 3, 3);
+}
+
+// Banded factorization on a cube
+int
+TestCase2(void) {
+  return CompareWithDirectSolve(false, 6, 6, 6);
+}
+
+// Banded factorization on a box with different dimensions
+int
+TestCase3(void) {
+  return CompareWithDirectSolve(false, 5, 7, 9);
+}
+
+int main(void) {
+  int mainReturnValue = 0;
+
+  int (*testCases[])(void) = {
+    TestCase1,
+    TestCase2,
+    TestCase3,
+    0
+  };
+
+  for (int i=0; testCases[i]; ++i) {
+    int retVal = testCases[i]();
+    if (retVal) {
+      fprintf(stderr, "Test case %d returned %d\n", i+1, retVal);
+      mainReturnValue = 129;
+    } else
+      fprintf(stderr, "Test case %d succeeded\n", i+1);
+    fflush(stderr);
+  }
+
+  return mainReturnValue;
+}
@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <vector>
+
+#include "hpgmp.hpp"
+#include "Geometry.hpp"
+#include "GenerateGeometry.hpp"
+#include "GenerateNonsymProblem.hpp"
+#include "SetupHalo.hpp"
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+#include "ReorderProblem.hpp"
+
+typedef SparseMatrix<double> SparseMatrix_type;
+typedef Vector<double> Vector_type;
+
+// Generates the problem on an nx x ny x nz grid of one process, reorders its rows, and permutes the
+// problem vectors to the new order and back: b holds the global ID of each row, so that it has to
+// follow localToGlobalMap, and x and xexact have to return to their generated values
+static int
+PermuteAndRestore(int rowOrdering, local_int_t nx, local_int_t ny, local_int_t nz) {
+  Geometry * geom = new Geometry;
+  GenerateGeometry(1, 0, 1, 0, 0, 0, nx, ny, nz, 1, 1, 1, geom);
+
+  SparseMatrix_type A;
+  Vector_type b, x, xexact;
+  InitializeSparseMatrix(A, geom, 0);
+  GenerateNonsymProblem(A, &b, &x, &xexact, true);
+  SetupHalo(A);
+  const local_int_t nrow = A.localNumberOfRows;
+  std::vector<global_int_t> generatedRows(A.localToGlobalMap.begin(), A.localToGlobalMap.begin() + nrow);
+  FillRandomVector(x);
+  for (local_int_t i=0; i<nrow; ++i) b.values[i] = generatedRows[i];
+  std::vector<double> xGenerated(x.values, x.values + nrow), xexactGenerated(xexact.values, xexact.values + nrow);
+
+  A.rowOrdering = rowOrdering;
+  ReorderProblem(A);
+  PermuteProblemVectors(A, generatedRows, b, x, xexact);
+
+  int retVal = 0, idx = 0;
+  if (A.rowOrdering!=rowOrdering) retVal |= 1 << idx;
+  ++idx;
+  for (local_int_t i=0; i<nrow; ++i)
+    if (b.values[i]!=A.localToGlobalMap[i]) {
+      retVal |= 1 << idx;
+      break;
+    }
+  ++idx;
+  // Inverse permutation: generated row i is now local row globalToLocalMap[generatedRows[i]]
+  local_int_t numberOfDifferences = 0;
+  for (local_int_t i=0; i<nrow; ++i) {
+    const local_int_t row = A.globalToLocalMap[generatedRows[i]];
+    if (x.values[row]!=xGenerated[i] || xexact.values[row]!=xexactGenerated[i]) ++numberOfDifferences;
+  }
+  if (numberOfDifferences) retVal |= 1 << idx;
+  printf( "ordering %d: %d x %d x %d, %d entries differ after the round trip\n", rowOrdering,
+          (int) nx, (int) ny, (int) nz, (int) numberOfDifferences ); fflush(stdout);
+
+  DeleteVector(b);
+  DeleteVector(x);
+  DeleteVector(xexact);
+  DeleteMatrix(A);
+  delete geom;
+
+  return retVal;
+}
+
+// Lexicographic rows are left in place
+int
+TestCase1(void) {
+  return PermuteAndRestore(HPGMP_ROW_ORDER_LEXICOGRAPHIC, 16, 16, 16);
+}
+
+// Tiles, with partial tiles at the ends of the box
+int
+TestCase2(void) {
+  return PermuteAndRestore(HPGMP_ROW_ORDER_TILED, 12, 16, 20);
+}
+
+// Morton curve on a cube
+int
+TestCase3(void) {
+  return PermuteAndRestore(HPGMP_ROW_ORDER_MORTON, 16, 16, 16);
+}
+
+// Morton curve on a box whose dimensions are not powers of two
+int
+TestCase4(void) {
+  return PermuteAndRestore(HPGMP_ROW_ORDER_MORTON, 12, 10, 6);
+}
+
+int main(void) {
+  int mainReturnValue = 0;
+
+  int (*testCases[])(void) = {
+    TestCase1,
+    TestCase2,
+    TestCase3,
+    TestCase4,
+    0
+  };
+
+  for (int i=0; testCases[i]; ++i) {
+    int retVal = testCases[i]();
+    if (retVal) {
+      fprintf(stderr, "Test case %d returned %d\n", i+1, retVal);
+      mainReturnValue = 129;
+    } else
+      fprintf(stderr, "Test case %d succeeded\n", i+1);
+    fflush(stderr);
+  }
+
+  return mainReturnValue;
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "hpgmp.hpp"
+#include "Geometry.hpp"
+#include "GenerateGeometry.hpp"
+#include "GenerateNonsymProblem.hpp"
+#include "SetupHalo.hpp"
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+#include "StencilData.hpp"
+#include "SetupStencilMatrix.hpp"
+#include "SetupCompressedIndices.hpp"
+#include "ReorderProblem.hpp"
+#include "ComputeSPMV.hpp"
+#include "ComputeSPMV_ref.hpp"
+
+typedef SparseMatrix<double> SparseMatrix_type;
+typedef Vector<double> Vector_type;
+
+// Generates the problem on an nx x ny x nz grid of one process, sets up the matrix format, and
+// compares the product of ComputeSPMV with the CSR product of ComputeSPMV_ref on a random vector
+static int
+CompareWithCSR(int matrixFormat, int rowOrdering, local_int_t nx, local_int_t ny, local_int_t nz) {
+  Geometry * geom = new Geometry;
+  GenerateGeometry(1, 0, 1, 0, 0, 0, nx, ny, nz, 1, 1, 1, geom);
+
+  SparseMatrix_type A;
+  InitializeSparseMatrix(A, geom, 0);
+  GenerateNonsymProblem(A, (Vector_type *) 0, (Vector_type *) 0, (Vector_type *) 0, false);
+  SetupHalo(A);
+  A.rowOrdering = rowOrdering;
+  ReorderProblem(A);
+
+  Vector_type x, yref, y;
+  InitializeVector(x, A.localNumberOfColumns, 0);
+  InitializeVector(yref, A.localNumberOfRows, 0);
+  InitializeVector(y, A.localNumberOfRows, 0);
+  FillRandomVector(x);
+  ComputeSPMV_ref(A, x, yref);
+
+  SetupStencilMatrix(A, matrixFormat);
+  SetupCompressedIndices(A, matrixFormat);
+  ComputeSPMV(A, x, y);
+
+  double maxDifference = 0.0, maxValue = 0.0;
+  for (local_int_t i=0; i<A.localNumberOfRows; ++i) {
+    maxDifference = std::max(maxDifference, std::fabs(y.values[i] - yref.values[i]));
+    maxValue = std::max(maxValue, std::fabs(yref.values[i]));
+  }
+  printf( "format %d ordering %d: %d x %d x %d, max difference %g of %g\n", matrixFormat, rowOrdering,
+          (int) nx, (int) ny, (int) nz, maxDifference, maxValue ); fflush(stdout);
+
+  int retVal = 0, idx = 0;
+  bool isSetUp = matrixFormat==HPGMP_MATRIX_FORMAT_DIA ? A.stencilData!=0 : A.compressedIndices!=0;
+  if (! isSetUp) retVal |= 1 << idx;
+  ++idx;
+  if (maxDifference > 1.0e-12*maxValue) retVal |= 1 << idx;
+
+  DeleteVector(x);
+  DeleteVector(yref);
+  DeleteVector(y);
+  DeleteMatrix(A);
+  delete geom;
+
+  return retVal;
+}
+
+// DIA format on a cube
+int
+TestCase1(void) {
+  return CompareWithCSR(HPGMP_MATRIX_FORMAT_DIA, HPGMP_ROW_ORDER_LEXICOGRAPHIC, 16, 16, 16);
+}
+
+// DIA format on a box with different dimensions
+int
+TestCase2(void) {
+  return CompareWithCSR(HPGMP_MATRIX_FORMAT_DIA, HPGMP_ROW_ORDER_LEXICOGRAPHIC, 8, 12, 20);
+}
+
+// Compressed indices with the 8-bit stencil codes of lexicographic rows
+int
+TestCase3(void) {
+  return CompareWithCSR(HPGMP_MATRIX_FORMAT_COMPRESSED, HPGMP_ROW_ORDER_LEXICOGRAPHIC, 16, 16, 16);
+}
+
+// Compressed indices of rows in Morton order, which are no longer stencil offsets
+int
+TestCase4(void) {
+  return CompareWithCSR(HPGMP_MATRIX_FORMAT_COMPRESSED, HPGMP_ROW_ORDER_MORTON, 16, 16, 16);
+}
+
+int main(void) {
+  int mainReturnValue = 0;
+
+  int (*testCases[])(void) = {
+    TestCase1,
+    TestCase2,
+    TestCase3,
+    TestCase4,
+    0
+  };
+
+  for (int i=0; testCases[i]; ++i) {
+    int retVal = testCases[i]();
+    if (retVal) {
+      fprintf(stderr, "Test case %d returned %d\n", i+1, retVal);
+      mainReturnValue = 129;
+    } else
+      fprintf(stderr, "Test case %d succeeded\n", i+1);
+    fflush(stderr);
+  }
+
+  return mainReturnValue;
+}